@@ -14,12 +14,106 @@ import datetime
 import traceback
 import time
 from threading import Thread
+
+# Channel bits of the fresh mask: T, p, Az low, Az high, Ax low, Ax high, Vbat
+ADV_CH_BITS = [0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40]
+
+def adv_decode_legacy(data, last):
+    # Unversioned frame of older firmware: ble_sensorData_tst
+    raw = [int.from_bytes(data[i:i+2], 'little', signed=True) for i in range(0, 14, 2)]
+    # Channels measured in this frame, the other ones are carried forward
+    fresh = data[16] if len(data) > 16 else 0xFF
+    # Bit 0/1: accelerometer low/high range measured in this frame, bit 2: deflation alarm
+    flags = data[17] if len(data) > 17 else 0x03
+    return raw + [data[14], data[15], fresh, flags]
+
+def adv_compact_fields(data, last):
+    # Compact frame, see adv.c: format, counter, flags, p (12 bits) and T (8 bits), then optional
+    # Az and Ax of the range in the flags, Vbat (bit 6) and error (bit 7). Returns the values and the end of the frame
+    raw = list(last[0:7]) if last else [0] * 7
+    counter = data[1]
+    cflags  = data[2]
+    pt      = int.from_bytes(data[3:6], 'little')
+    raw[0]  = pt & 0xFFF
+    raw[1]  = ((pt >> 12) & 0xFF) - (256 if pt & 0x80000 else 0)
+    fresh   = ADV_CH_BITS[0] | ADV_CH_BITS[1]
+    pos     = 6
+    if cflags & 0x03:
+        # High range if bit 1 is set, else low range
+        hi = 1 if cflags & 0x02 else 0
+        raw[2 + hi] = int.from_bytes(data[pos:pos+2], 'little', signed=True)
+        raw[4 + hi] = int.from_bytes(data[pos+2:pos+4], 'little', signed=True)
+        fresh |= ADV_CH_BITS[2 + hi] | ADV_CH_BITS[4 + hi]
+        pos += 4
+    if cflags & 0x40:
+        raw[6] = data[pos] << 1
+        fresh |= ADV_CH_BITS[6]
+        pos += 1
+    error = 0
+    if cflags & 0x80:
+        error = data[pos]
+        pos += 1
+    return raw + [error, counter, fresh, cflags & 0x07], pos
+
+def adv_decode_compact(data, last):
+    return adv_compact_fields(data, last)[0]
+
+# Format byte of the batch frame: a compact frame followed by samples of the last advertised frames
+ADV_FMT_BATCH = 0x02
+# Length of a batch sample: counter, p (12 bits) and T (8 bits)
+ADV_BATCH_SAMPLE_LEN = 4
+
+def adv_is_batch(data):
+    # A batch frame has the batch format byte and whole samples after its compact frame. Its length may be
+    # the one of a legacy frame, whose first byte is the low byte of the pressure
+    if len(data) < 6 or data[0] != ADV_FMT_BATCH:
+        return False
+    pos = adv_compact_fields(data, None)[1]
+    return pos < len(data) and (len(data) - pos) % ADV_BATCH_SAMPLE_LEN == 0
+
+def adv_decode_batch_samples(data):
+    # Samples following the compact frame of a batch frame, newest first: (counter, p, T)
+    pos = adv_compact_fields(data, None)[1]
+    samples = []
+    while pos + ADV_BATCH_SAMPLE_LEN <= len(data):
+        pt = int.from_bytes(data[pos+1:pos+4], 'little')
+        samples.append((data[pos], pt & 0xFFF, ((pt >> 12) & 0xFF) - (256 if pt & 0x80000 else 0)))
+        pos += ADV_BATCH_SAMPLE_LEN
+    return samples
+
+# Format byte of the device information of the scan response
+ADV_FMT_DEVINFO = 0x10
+# Length of the device information: format, FW major, minor, patch, HW version, profile, Vbat
+ADV_DEVINFO_LEN = 7
+
+# Sampling profiles of the device information, see motion_profile_ten
+DEVINFO_PROFILES = ['parked', 'driving', 'transition']
+
+def adv_decode_devinfo(data):
+    # Device information, see adv.c: format, FW major, minor, patch, HW version, profile, Vbat (2 LSB, 0 unknown)
+    fw = '{}.{}.{}'.format(data[1], data[2], data[3])
+    profile = DEVINFO_PROFILES[data[5]] if data[5] < len(DEVINFO_PROFILES) else str(data[5])
+    vbat = 0.005 * (data[6] << 1) + 1.9 if data[6] else None
+    return {'fw': fw, 'hw': data[4], 'profile': profile, 'vbat': vbat}
+
+# Frame decoders, indexed by the format byte
+ADV_FRAME_DECODERS = {
+    0x01: adv_decode_compact,
+}
+# Number of frame counters remembered per device to recognize the batch samples already received
+ADV_BATCH_SEEN_LEN = 8
 # Main class for Bosch demo application
 class BleMeasDataCollector(BleDataCollector):
     pressure_char_version = 2 # Can either be 1 for lower clipping at 100 kPa or 2 for lower clipping at 90 kPa.
     def __init__(self, serial_port, logger, data_logger, log_severity_level='error'):
         self.known_devices = {}
         self.connectable_devices = {}
+        # Last raw values received, per device, for the channels not sent in every frame
+        self.last_raw = {}
+        # Device information from the scan responses, per device
+        self.device_info = {}
+        # Frame counters received last, per device
+        self.seen_counters = {}
         self.logger = logger
         self.data_logger = data_logger
         super(BleMeasDataCollector, self).__init__(serial_port, log_severity_level)
@@ -35,7 +129,11 @@ class BleMeasDataCollector(BleDataCollector):
         if nrf_ble_driver.BLEAdvData.Types.manufacturer_specific_data in adv_data.records:
             man_spec_data = adv_data.records[nrf_ble_driver.BLEAdvData.Types.manufacturer_specific_data]
             if bytes(man_spec_data)[:2][::-1] == b'\x02\xA6':
-                if len(man_spec_data) in range(18,33):
+                # Exact length: a legacy frame may start with the format byte of the device information
+                if len(man_spec_data) == 2 + ADV_DEVINFO_LEN and man_spec_data[2] == ADV_FMT_DEVINFO:
+                    # Scan response: inventory of the device without connecting
+                    self.on_device_info(address_string, adv_decode_devinfo(bytes(man_spec_data[2:])))
+                elif len(man_spec_data) >= 8:
                     self.myAddr = peer_addr
                     # print('Value received:\t',bytes(man_spec_data).hex(':'))
                     # Store device address as known Bosch Demo Application
@@ -45,16 +143,21 @@ class BleMeasDataCollector(BleDataCollector):
                         self.connectable_devices[address_string] = peer_addr
                         
                     
-                    # Collect meas data from device
-                    pressure_raw     = int.from_bytes(man_spec_data[ 2: 4], 'little', signed=True)
-                    temperature_raw  = int.from_bytes(man_spec_data[ 4: 6], 'little', signed=True)
-                    z_acc_low_raw    = int.from_bytes(man_spec_data[ 6: 8], 'little', signed=True)
-                    z_acc_high_raw   = int.from_bytes(man_spec_data[ 8:10], 'little', signed=True)
-                    x_acc_low_raw    = int.from_bytes(man_spec_data[10:12], 'little', signed=True)
-                    x_acc_high_raw   = int.from_bytes(man_spec_data[12:14], 'little', signed=True)
-                    batt_voltage_raw = int.from_bytes(man_spec_data[14:16], 'little', signed=True)
-                    meas_raw = int.from_bytes(man_spec_data[16:18], 'little', signed=True)
-                    counter = int.from_bytes(man_spec_data[20:22], 'little', signed=False)
+                    # Collect meas data from device: dispatch on the frame format
+                    frame = bytes(man_spec_data[2:])
+                    if adv_is_batch(frame):
+                        decoder = adv_decode_compact
+                    elif len(frame) in range(16, 21):
+                        decoder = adv_decode_legacy
+                    elif frame[0] in ADV_FRAME_DECODERS:
+                        decoder = ADV_FRAME_DECODERS[frame[0]]
+                    else:
+                        self.logger.debug('Unknown frame format 0x{:02X} from {}'.format(frame[0], address_string))
+                        return
+                    raw = decoder(frame, self.last_raw.get(address_string))
+                    self.last_raw[address_string] = raw
+                    (pressure_raw, temperature_raw, z_acc_low_raw, z_acc_high_raw, x_acc_low_raw, x_acc_high_raw,
+                     batt_voltage_raw, error_code, counter, fresh, flags) = raw
                     if self.pressure_char_version == 1:
                         pressure = 0.40059 * pressure_raw + 100.
                     elif self.pressure_char_version == 2:
@@ -72,21 +175,52 @@ class BleMeasDataCollector(BleDataCollector):
                             adv_type_name, address_string, rssi
                         )
                     log_string += ', data: {:6.2f} kPa {:3.0f} °C z {:3.1f}/{:3.1f} g x {:3.1f}/{:3.1f} g {:1.1f} V {}\r\n'.format(
-                            pressure, temperature, z_acc_low, z_acc_high, x_acc_low, x_acc_high, batt_voltage, meas_raw
+                            pressure, temperature, z_acc_low, z_acc_high, x_acc_low, x_acc_high, batt_voltage, '0x{:02X}'.format(fresh)
                         )
-                    if len(man_spec_data) > 18:
-                        log_string += ', error: 0x{:02X}, identifier: {:d}, counter: {:d}\r\n'.format(man_spec_data[18], man_spec_data[19], counter)
+                    log_string += ', error: 0x{:02X}, counter: {:d}, flags: 0x{:02X}\r\n'.format(error_code, counter, flags)
 
+                    if flags & 0x04:
+                        self.logger.warning('Deflation alarm from {}: {:6.2f} kPa'.format(address_string, pressure))
                     self.logger.debug(log_string)
 
                     data_string = '"{}",{},{:.2f},{:.0f},{:.1f},{:.1f},{:.1f},{:.1f},{:.1f},{}'.format(
                         address_string, rssi,
-                        pressure, temperature, z_acc_low, z_acc_high, x_acc_low, x_acc_high, batt_voltage, meas_raw
+                        pressure, temperature, z_acc_low, z_acc_high, x_acc_low, x_acc_high, batt_voltage, '{:02X}'.format(fresh)
                     )
+                    data_string += ',{:02X},{:d}'.format(error_code, counter)
+                    self.data_logger.info(data_string)
 
-                    if len(man_spec_data) > 18:
-                        data_string += ',{:02X},{:d},{:d}'.format(man_spec_data[18], man_spec_data[19], counter)
+                    # Batch frame: the samples of the advertised frames this receiver missed
+                    if decoder == adv_decode_compact and frame[0] == ADV_FMT_BATCH:
+                        self.on_adv_batch(address_string, counter, adv_decode_batch_samples(frame))
                     else:
-                        data_string += ','
-                    self.data_logger.info(data_string)
+                        self.note_counter(address_string, counter)
+
+    def note_counter(self, address_string, counter):
+        seen = self.seen_counters.setdefault(address_string, [])
+        if counter not in seen:
+            seen.append(counter)
+            del seen[:-ADV_BATCH_SEEN_LEN]
+
+    def on_adv_batch(self, address_string, counter, samples):
+        # Oldest first, so the counters are noted in order
+        seen = self.seen_counters.get(address_string, [])
+        for sample_counter, p, t in reversed(samples):
+            if sample_counter not in seen:
+                self.logger.debug('Batch {} counter {:d}: {:6.2f} kPa {} °C'.format(
+                        address_string, sample_counter, 0.40547 * p + 90., t
+                    ))
+                self.data_logger.info('"{}",,{:.2f},{:.0f},,,,,,,,{:d}'.format(
+                        address_string, 0.40547 * p + 90., 1. * t, sample_counter
+                    ))
+            self.note_counter(address_string, sample_counter)
+        self.note_counter(address_string, counter)
+
+    def on_device_info(self, address_string, info):
+        if self.device_info.get(address_string) != info:
+            self.logger.info('Device {}: FW {} HW {} profile {} battery {}'.format(
+                    address_string, info['fw'], info['hw'], info['profile'],
+                    '{:1.2f} V'.format(info['vbat']) if info['vbat'] else 'unknown'
+                ))
+            self.device_info[address_string] = info
                 
\ No newline at end of file
@@ -1,4 +1,5 @@
 from .util import *
+import struct
 import time
 
 #-----------------------------------------------------------------------------------------------------------------------------------------
@@ -16,7 +17,7 @@ class ConnectedStateMachine:
         print("In idle state.")
 
         # Get user input to determine the next state
-        user_input = input("Enter (read, write, chars or exit): ")
+        user_input = input("Enter (read, write, chars, bench or exit): ")
         user_input = user_input.lower()
 
         if user_input=='pin':
@@ -24,7 +25,7 @@ class ConnectedStateMachine:
             print(status)
             print(data)        
 
-        elif user_input in ['read', 'write', 'exit', 'chars']:
+        elif user_input in ['read', 'write', 'exit', 'chars', 'bench']:
             self.state = user_input
         else:
             print("Invalid state. Staying in initial state.")
@@ -90,9 +91,13 @@ class ConnectedStateMachine:
                 return
             print(f"Now set new value for {user_choice_char} Characteristic")
 
-        if 'GPIO' in user_choice_char or 'TSD' in user_choice_char or 'TX power' in user_choice_char:
+        if 'GPIO' in user_choice_char or 'TSD' in user_choice_char or 'TX power' in user_choice_char or 'Adv. policy' in user_choice_char or 'Adv. mode' in user_choice_char or 'Link' in user_choice_char:
             user_input_data = input("New value: ")
-            data_in = [int(data) for data in user_input_data.split(",")]
+            # Negative values, e.g. a TX power or an RSSI, are sent as int8
+            data_in = [int(data) & 0xFF for data in user_input_data.split(",")]
+        elif user_choice_char == 'History':
+            # Acknowledge the records read: sequence number of the first record of the next read
+            data_in = struct.pack('<I', int(input("Next sequence number: ")))
         else:
             data_in = 0
         
@@ -142,6 +147,48 @@ class ConnectedStateMachine:
         decode_value(user_choice_char, data)
         self.state = 'idle'
     
+    def bench(self):
+        print("In bench state.")
+
+        # Measures the throughput of the Stream characteristic over the current connection, i.e. a real link with
+        # the connection parameters of the dongle, no simulated one: the device sends a burst of values, paced by
+        # the confirmations for indications and by a timer for notifications, and counts the values sent
+        if "Stream" not in self.smp290_cust_svc_uuid_dict or DELIVERY_CHAR not in self.smp290_cust_svc_uuid_dict:
+            print("Delivery benchmark not supported. Returning to idle state.")
+            self.state = 'idle'
+            return
+
+        stream_char, stream_svc = self.smp290_cust_svc_uuid_dict["Stream"]
+        dlvr_char, dlvr_svc = self.smp290_cust_svc_uuid_dict[DELIVERY_CHAR]
+
+        mode = input("Delivery (notify or indicate): ").lower()
+        count = int(input("Number of values: ")) & 0xFFFF
+
+        if mode == 'indicate':
+            self.collector.enable_indication(self.client, stream_char, stream_svc)
+        else:
+            self.collector.enable_notification(self.client, stream_char, stream_svc)
+
+        start = time.time()
+        self.collector.write_char(self.client, dlvr_char, bytes([count & 0xFF, count >> 8]), dlvr_svc)
+
+        # Poll the counts until the burst is delivered or stalled: notifications are not confirmed, they are
+        # delivered once sent. The values refused by the stack are sent again by the device
+        notified = indicated = confirmed = failed = delivered = 0
+        while delivered < count and time.time() - start < BENCH_TIMEOUT_S:
+            time.sleep(BENCH_POLL_S)
+            status, data = self.collector.read_char(self.client, dlvr_char, dlvr_svc)
+            notified, indicated, confirmed, failed = delivery_decode(data)
+            delivered = confirmed if mode == 'indicate' else notified
+        elapsed = time.time() - start
+
+        self.collector.disable_indication_notification(self.client, stream_char, stream_svc)
+
+        self.logger.info(f"Bench {mode}: {delivered} of {count} values in {elapsed:.2f} s, {failed} refused")
+        print(f"\n{mode}: {delivered} of {count} values in {elapsed:.2f} s: {delivered / elapsed:.1f} values/s, "
+              f"{delivered * STREAM_LEN / elapsed:.0f} B/s, {failed} refused\n")
+        self.state = 'idle'
+
     def exit(self):
         print("Exiting...") # Does not get printed
 
@@ -186,6 +233,17 @@ def base_to_uuid(uuid_base):
     data_uuid = uuid_base_from_16bytes(uuid_number, uuid_base.type)
     return data_uuid
 
+# Delivery counts of the measurement service
+DELIVERY_CHAR = "Delivery: notifications, indications, confirmations, failures"
+# Length of the Stream value, the packed sensor frame
+STREAM_LEN = 25
+# Polling period and timeout of the delivery benchmark
+BENCH_POLL_S = 0.5
+BENCH_TIMEOUT_S = 60
+
+# States of the advertising policy, in the order of the characteristics
+ADV_POLICY_STATES = ["Parked", "Driving", "Transition", "Alarm", "Maintenance"]
+
 def decode_value(char, data):
     print("Decoding value")
 
@@ -247,6 +305,56 @@ def decode_value(char, data):
         case "VBAT":
             print(f"\nBattery is: {vbat_calculation(data)} V\n")
 
+        case "History":
+            total, records = history_decode(data)
+            print(f"\n{len(records)} of {total} history records:\n")
+            for seq, time_ms, p, t, flags, error in records:
+                print(f"#{seq} {time_ms / 1000.:.3f} s: {0.40547 * p + 90:.2f} kPa {t} °C flags 0x{flags:02X} error 0x{error:02X}\n")
+            if records:
+                print(f"Write {records[-1][0] + 1} to History to read the following records\n")
+
+        case "Stream" | "All":
+            p, t, az_lo, az_hi, ax_lo, ax_hi, vbat, error, frame_counter, fresh, flags, *age = sensor_frame_decode(data)
+            print(f"\nFrame #{frame_counter}: {0.40547 * p + 90:.2f} kPa {t} °C Az {az_lo}/{az_hi} Ax {ax_lo}/{ax_hi} Vbat {vbat}\n")
+            print(f"Fresh channels 0x{fresh:02X} flags 0x{flags:02X} error 0x{error:02X}\n")
+            ages = ", ".join(f"{ch} {'never' if a == AGE_NEVER else a}" for ch, a in zip(SENSOR_CHANNELS, age))
+            print(f"Age [cycles]: {ages}\n")
+
+        case "Delivery: notifications, indications, confirmations, failures":
+            notified, indicated, confirmed, failed = delivery_decode(data)
+            print(f"\nNotified: {notified}, indicated: {indicated}, confirmed: {confirmed}, refused: {failed}\n")
+
+        case "Alarm latency: last, max":
+            latency, max_latency = struct.unpack('<2I', bytes(data))
+            print(f"\nDeflation alarm latency: last {latency} ms, max {max_latency} ms\n")
+
+        case "Adv. policy: maintenance, interval and duration per state":
+            print(f"\nMaintenance is: {'on' if data[0] else 'off'}\n")
+            for i, state in enumerate(ADV_POLICY_STATES):
+                interval = data[1 + 4 * i] | (data[2 + 4 * i] << 8)
+                duration = data[3 + 4 * i] | (data[4 + 4 * i] << 8)
+                print(f"{state}: interval {interval * 0.625:.1f} ms, duration {duration} ms\n")
+
+        case "Adv. radio-on time per state, last hour [us]":
+            print(f"\nRadio-on time in the last hour:\n")
+            for i, state in enumerate(ADV_POLICY_STATES):
+                print(f"{state}: {int.from_bytes(bytes(data[4 * i:4 * i + 4]), 'little')} us\n")
+
+        case "Adv. mode: broadcast, window period [s]":
+            if data[0] == 1:
+                print(f"\nAdv. mode is: broadcast, connectable window every {data[1] | (data[2] << 8)} s\n")
+            else:
+                print(f"\nAdv. mode is: connectable\n")
+
+        case "Link: margin [dB], RSSI [dBm], TX power [dBm]":
+            rssi = int.from_bytes(bytes(data[1:2]), 'little', signed=True)
+            print(f"\nLink margin is: {data[0]} dB\n")
+            print(f"Last RSSI is: {'not available' if rssi == 127 else f'{rssi} dBm'}\n")
+            print(f"TX power is: {int.from_bytes(bytes(data[2:3]), 'little', signed=True)} dBm\n")
+
+        case "NVM: erases, writes since reset":
+            print(f"\nNVM erases: {int.from_bytes(bytes(data[0:4]), 'little')}, writes: {int.from_bytes(bytes(data[4:8]), 'little')}\n")
+
         case "GPIO pin":
             print(f"\nGPIO pin chosen is: {data}\n")
 
@@ -331,3 +439,22 @@ def ax_calculation(data):
     ax_dec = int(hex_string, 16)
     ax = 660./2048. * ax_dec
     return ax
+
+# Channels of the age of a sensor frame, see seq_channel_ten, and the age of a channel never measured
+SENSOR_CHANNELS = ["T", "p", "Az low", "Az high", "Ax low", "Ax high", "Vbat"]
+AGE_NEVER = 0xFF
+
+def sensor_frame_decode(data):
+    # Decodes a packed sensor frame: p, T, Az low/high, Ax low/high, Vbat, error, frame counter, fresh, flags,
+    # then the age of every channel
+    return struct.unpack('<7h4B7B', bytes(data))
+
+def delivery_decode(data):
+    # Decodes the value of the Delivery characteristic: four little endian uint32 counts
+    return struct.unpack('<4I', bytes(data))
+
+def history_decode(data):
+    # Decodes the value of the History characteristic: the total number of records, then blocks
+    data = bytes(data)
+    total = int.from_bytes(data[0:4], 'little')
+    return total, history_decode_blocks(data[4:])
@@ -287,10 +287,10 @@ class BleDataCollector(nrf_ble_driver.BLEDriverObserver, nrf_ble_driver.BLEAdapt
         return None
 
     def enable_notification(self, conn_handle, char_uuid, service_uuid=None):
-        return self.write_client_characteristic_configuration(conn_handle, char_uuid, [0x00, 0x01], service_uuid=service_uuid)
+        return self.write_client_characteristic_configuration(conn_handle, char_uuid, [0x01, 0x00], service_uuid=service_uuid)
     
     def enable_indication(self, conn_handle, char_uuid, service_uuid=None):
-        return self.write_client_characteristic_configuration(conn_handle, char_uuid, [0x00, 0x02], service_uuid=service_uuid)
+        return self.write_client_characteristic_configuration(conn_handle, char_uuid, [0x02, 0x00], service_uuid=service_uuid)
     
     def disable_indication_notification(self, conn_handle, char_uuid, service_uuid=None):
         return self.write_client_characteristic_configuration(conn_handle, char_uuid, [0x00, 0x00], service_uuid=service_uuid)
@@ -325,4 +325,53 @@ class BleDataConnection:
         return self.conn_handle
     
     def __exit__(self, exc_type, exc_val, exc_tb):
-        self.collector.disconnect(self.conn_handle)
\ No newline at end of file
+        self.collector.disconnect(self.conn_handle)
+
+# History block header: seq (uint32), first record (time_ms uint32, p int16, T int16, flags, error), count, len
+HISTORY_BLOCK_HDR_LEN = 16
+
+def history_varint(data, pos):
+    # Zigzag varint, 7 bits per byte, least significant first
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if byte < 0x80:
+            break
+    return (value >> 1) ^ -(value & 1), pos
+
+def history_decode_blocks(data):
+    # Decodes history blocks, see history.c for the encoding. Returns the records (seq, time_ms, p, T, flags, error)
+    data = bytes(data)
+    records = []
+    pos = 0
+    while pos + HISTORY_BLOCK_HDR_LEN <= len(data):
+        seq     = int.from_bytes(data[pos:pos+4], 'little')
+        time_ms = int.from_bytes(data[pos+4:pos+8], 'little')
+        p       = int.from_bytes(data[pos+8:pos+10], 'little', signed=True)
+        t       = int.from_bytes(data[pos+10:pos+12], 'little', signed=True)
+        flags   = data[pos+12]
+        error   = data[pos+13]
+        count   = data[pos+14]
+        end     = pos + HISTORY_BLOCK_HDR_LEN + data[pos+15]
+        pos    += HISTORY_BLOCK_HDR_LEN
+        records.append((seq, time_ms, p, t, flags, error))
+        dt_ms = 0
+        for i in range(1, count):
+            dod, pos = history_varint(data, pos)
+            dp, pos  = history_varint(data, pos)
+            dt, pos  = history_varint(data, pos)
+            dt_ms   += dod
+            time_ms  = (time_ms + dt_ms) & 0xFFFFFFFF
+            p       += dp
+            t       += dt >> 1
+            if dt & 1:
+                flags = data[pos]
+                error = data[pos+1]
+                pos  += 2
+            records.append((seq + i, time_ms, p, t, flags, error))
+        pos = end
+    return records
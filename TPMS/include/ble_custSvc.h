@@ -5,7 +5,7 @@
  * @brief        \glos{API} of the BLE custom service.
  * @details
  * This file contains the API and definitions for the BLE custom service of measure_advertise_conn. 
- * The custom service provides characteristics for current TX power, counter value, and TSD.
+ * The custom service provides characteristics for current TX power, counter value, TSD and the advertising triggers.
  * It also includes functions for adding and removing the custom service from the attribute database,
  * processing read and write requests, handling CCC (Client Characteristic Configuration) events,
  * and configuring the TX power and GPIO.
@@ -24,7 +24,6 @@
 #define _BLE_CUSTSVC_H
 
 #include "rbk_smp290_gpio.h"
-#include "rbk_smp290_nvm.h"
 #include "ble_gattSvc.h"
 #include "main.h"
 
@@ -44,6 +43,12 @@
 #define BLE_CUST_SVC_TXPWR_CHAR_UUID_PART UINT16_C(0x1A01)  //!< Current TX power characteristics UUID
 #define BLE_CUST_SVC_CNTR_CHAR_UUID_PART  UINT16_C(0x1A02)  //!<Counter value characteristics UUID
 #define BLE_CUST_SVC_TSD_CHAR_UUID_PART   UINT16_C(0x1A03)  //!<Thermal Shut Down characteristics UUID
+#define BLE_CUST_SVC_ADV_TRIG_CHAR_UUID_PART UINT16_C(0x1A04)  //!< Advertising trigger characteristics UUID
+#define BLE_CUST_SVC_ADV_POL_CHAR_UUID_PART  UINT16_C(0x1A05)  //!< Advertising policy characteristics UUID
+#define BLE_CUST_SVC_ADV_RADIO_CHAR_UUID_PART UINT16_C(0x1A06)  //!< Advertising radio-on time characteristics UUID
+#define BLE_CUST_SVC_ADV_MODE_CHAR_UUID_PART UINT16_C(0x1A07)  //!< Advertising mode characteristics UUID
+#define BLE_CUST_SVC_LINK_CHAR_UUID_PART     UINT16_C(0x1A08)  //!< Link budget characteristics UUID
+#define BLE_CUST_SVC_NVM_CHAR_UUID_PART      UINT16_C(0x1A09)  //!< NVM wear characteristics UUID
 
 /// Custom service 02a63290-xxxx-b83e-af18-025703723367
 /// Custom base UUID part 1
@@ -66,6 +71,24 @@
 /// Macro for Building the Custom Characteristics 3  UUID
 #define BLE_CUST_SVC_TSD_CHAR_UUID BLE_CUST_SVC_BUILD(BLE_CUST_SVC_TSD_CHAR_UUID_PART)
 
+/// Macro for Building the Custom Characteristics 4  UUID
+#define BLE_CUST_SVC_ADV_TRIG_CHAR_UUID BLE_CUST_SVC_BUILD(BLE_CUST_SVC_ADV_TRIG_CHAR_UUID_PART)
+
+/// Macro for Building the Custom Characteristics 5  UUID
+#define BLE_CUST_SVC_ADV_POL_CHAR_UUID BLE_CUST_SVC_BUILD(BLE_CUST_SVC_ADV_POL_CHAR_UUID_PART)
+
+/// Macro for Building the Custom Characteristics 6  UUID
+#define BLE_CUST_SVC_ADV_RADIO_CHAR_UUID BLE_CUST_SVC_BUILD(BLE_CUST_SVC_ADV_RADIO_CHAR_UUID_PART)
+
+/// Macro for Building the Custom Characteristics 7  UUID
+#define BLE_CUST_SVC_ADV_MODE_CHAR_UUID BLE_CUST_SVC_BUILD(BLE_CUST_SVC_ADV_MODE_CHAR_UUID_PART)
+
+/// Macro for Building the Custom Characteristics 8  UUID
+#define BLE_CUST_SVC_LINK_CHAR_UUID BLE_CUST_SVC_BUILD(BLE_CUST_SVC_LINK_CHAR_UUID_PART)
+
+/// Macro for Building the Custom Characteristics 9  UUID
+#define BLE_CUST_SVC_NVM_CHAR_UUID BLE_CUST_SVC_BUILD(BLE_CUST_SVC_NVM_CHAR_UUID_PART)
+
 #define BLE_CUST_SVC_CCC_BUFF_SIZE    UINT8_C(2)      //!< Ble Indication buffer size
 #define BLE_CUST_SVC_BLE_TMR_INTERVAL UINT32_C(1000)  //!< Ble Indication timer interval in ms    1 sec
 
@@ -75,8 +98,51 @@
 /// TSD default value
 #define TSD_DEFAULT_STATUS 0x01u
 
-/// Memory address of the TX power level in \glos{NVM}
-#define TXPWR_NVM_ADR 0x404800u
+/// Length of the advertising trigger characteristic: p delta, T delta, heartbeat (uint16 each, little endian)
+#define BLE_CUST_SVC_ADV_TRIG_LEN 6u
+
+/// Length of the settings of one state in the advertising policy characteristic:
+/// interval [0.625 ms], duration [ms] (uint16 each, little endian)
+#define BLE_CUST_SVC_ADV_POL_STATE_LEN 4u
+
+/// Length of the advertising policy characteristic: maintenance flag, then the settings of every
+/// state in the order of \ref adv_state_ten
+#define BLE_CUST_SVC_ADV_POL_LEN (1u + ((uint16_t)ADV_STATE_MAX * BLE_CUST_SVC_ADV_POL_STATE_LEN))
+
+/// Length of a write of the maintenance flag to the advertising policy characteristic
+#define BLE_CUST_SVC_ADV_POL_MAINT_WR_LEN 1u
+
+/// Length of a write of the settings of a state to the advertising policy characteristic:
+/// state, interval, duration
+#define BLE_CUST_SVC_ADV_POL_STATE_WR_LEN (1u + BLE_CUST_SVC_ADV_POL_STATE_LEN)
+
+/// Length of the advertising radio-on time characteristic: time of every state in the
+/// last complete hour [us] (uint32 each, little endian)
+#define BLE_CUST_SVC_ADV_RADIO_LEN ((uint16_t)ADV_STATE_MAX * 4u)
+
+/// Length of the advertising mode characteristic: mode (\ref adv_mode_ten), period of the
+/// connectable windows [s] (uint16, little endian)
+#define BLE_CUST_SVC_ADV_MODE_LEN 3u
+
+/// Length of the link budget characteristic: margin [dB], last RSSI [dBm], TX power level [dBm]
+#define BLE_CUST_SVC_LINK_LEN 3u
+
+/// Length of a write of the margin to the link budget characteristic
+#define BLE_CUST_SVC_LINK_MARGIN_WR_LEN 1u
+
+/// Length of a write of the margin and the link hint to the link budget characteristic:
+/// margin [dB], RSSI of the advertisements measured by the gateway [dBm], TX power level
+/// of these advertisements [dBm]
+#define BLE_CUST_SVC_LINK_HINT_WR_LEN 3u
+
+/// Length of the \glos{NVM} wear characteristic: page erases, word writes since reset (uint32 each, little endian)
+#define BLE_CUST_SVC_NVM_LEN 8u
+
+/// \glos{ATT} error: Invalid Attribute Value Length
+#define BLE_CUST_SVC_ATT_ERR_INVALID_LEN ((rbk_smp290_ble_atts_err_ten)0x0Du)
+
+/// \glos{ATT} error: Value Not Allowed
+#define BLE_CUST_SVC_ATT_ERR_VALUE_NOT_ALLOWED ((rbk_smp290_ble_atts_err_ten)0x13u)
 
 /******************************************************************************\
  * Types
@@ -97,19 +163,27 @@ typedef enum
     BLE_CUST_SVC_TSD_CHAR_HNDL,                      //!< Custom Characteristic 3 Handle
 	BLE_CUST_SVC_TSD_CHAR_DATA_HNDL,                 //!< Custom Characteristic 3 Data Handle
 	BLE_CUST_SVC_TSD_CHAR_CUD_HNDL,                  //!< Custom Characteristic 3 Characteristic User Description
+    BLE_CUST_SVC_ADV_TRIG_CHAR_HNDL,                 //!< Custom Characteristic 4 Handle
+    BLE_CUST_SVC_ADV_TRIG_CHAR_DATA_HNDL,            //!< Custom Characteristic 4 Data Handle
+    BLE_CUST_SVC_ADV_TRIG_CHAR_CUD_HNDL,             //!< Custom Characteristic 4 Characteristic User Description
+    BLE_CUST_SVC_ADV_POL_CHAR_HNDL,                  //!< Custom Characteristic 5 Handle
+    BLE_CUST_SVC_ADV_POL_CHAR_DATA_HNDL,             //!< Custom Characteristic 5 Data Handle
+    BLE_CUST_SVC_ADV_POL_CHAR_CUD_HNDL,              //!< Custom Characteristic 5 Characteristic User Description
+    BLE_CUST_SVC_ADV_RADIO_CHAR_HNDL,                //!< Custom Characteristic 6 Handle
+    BLE_CUST_SVC_ADV_RADIO_CHAR_DATA_HNDL,           //!< Custom Characteristic 6 Data Handle
+    BLE_CUST_SVC_ADV_RADIO_CHAR_CUD_HNDL,            //!< Custom Characteristic 6 Characteristic User Description
+    BLE_CUST_SVC_ADV_MODE_CHAR_HNDL,                 //!< Custom Characteristic 7 Handle
+    BLE_CUST_SVC_ADV_MODE_CHAR_DATA_HNDL,            //!< Custom Characteristic 7 Data Handle
+    BLE_CUST_SVC_ADV_MODE_CHAR_CUD_HNDL,             //!< Custom Characteristic 7 Characteristic User Description
+    BLE_CUST_SVC_LINK_CHAR_HNDL,                     //!< Custom Characteristic 8 Handle
+    BLE_CUST_SVC_LINK_CHAR_DATA_HNDL,                //!< Custom Characteristic 8 Data Handle
+    BLE_CUST_SVC_LINK_CHAR_CUD_HNDL,                 //!< Custom Characteristic 8 Characteristic User Description
+    BLE_CUST_SVC_NVM_CHAR_HNDL,                      //!< Custom Characteristic 9 Handle
+    BLE_CUST_SVC_NVM_CHAR_DATA_HNDL,                 //!< Custom Characteristic 9 Data Handle
+    BLE_CUST_SVC_NVM_CHAR_CUD_HNDL,                  //!< Custom Characteristic 9 Characteristic User Description
 	BLE_CUST_SVC_MAX_HNDL
 } custSvc_ten;
 
-/// Structure with size NVM word to store the Tx Power in \glos{NVM}
-typedef struct
-{
-    uint8_t TxPwrNvmStrd;                  //!< Is TX Power stored in \glos{NVM} (only a value of 1 means it is stored)
-    int8_t TxPwrNvm;                       //!< TX Power value in \glos{NVM}
-    uint8_t reserved[NVM_WORD_SIZE - 2u];  //!< Reserved
-} ble_TxPwrNvm_tst;
-
-_Static_assert(NVM_WORD_SIZE == sizeof(ble_TxPwrNvm_tst), "The size of ble_TxPwrNvm_tst is not equal to NVM_WORD_SIZE.");
-
 // Restore default pack
 #pragma pack()
 
@@ -204,23 +278,47 @@ void custSvcRegAppCbk(custSvcAppCbk cbk);
 void config_txPwr(int8_t txPwr);
 
 /**
- * @brief Writes the TX power level to \glos{NVM}.
+ * @brief  Configures the advertising triggers, which are received from write callback event.
+ *         The configuration is applied and marked dirty for \glos{NVM}.
+ *
+ * @param  value  p delta, T delta and heartbeat period, uint16 each, little endian
+ * return void
+ */
+void config_advTrig(const uint8_t *value);
+
+/**
+ * @brief  Configures the advertising policy, which is received from write callback event.
+ *         A 1 byte write sets (non zero) or clears the maintenance flag, a 5 bytes write
+ *         sets the interval and duration of a state.
  *
- * @param  txPwr  The TX power level to be written.
+ * @param  value  maintenance flag, or state, interval and duration, uint16 little endian
+ * @param  len    length of the value, \ref BLE_CUST_SVC_ADV_POL_MAINT_WR_LEN or
+ *                \ref BLE_CUST_SVC_ADV_POL_STATE_WR_LEN
+ * @return true if the value is applied, false if the state, the interval or the duration is out of range,
+ *         see \ref adv_setCadence
+ */
+bool config_advPolicy(const uint8_t *value, uint16_t len);
+
+/**
+ * @brief  Configures the advertising mode, which is received from write callback event.
  *
- * @return @ref RBK_SMP290_NVM_SUCCESS if operation is successful.
- * @return Else, the NVM driver error that took place
+ * @param  value  mode, period of the connectable windows [s], uint16 little endian
+ * @return true if the value is applied, false if the mode is out of range or broadcast with a period of 0
  */
-rbk_smp290_nvm_err_ten writeTxPwrToNvm(int8_t txPwr);
+bool config_advMode(const uint8_t *value);
 
 /**
- * @brief Reads the current TX power level from \glos{NVM}. If the value is
- *        not found, the default \ref RBK_SMP290_BLE_TX_PWR_6_DBM is returned.
+ * @brief  Configures the link budget, which is received from write callback event.
+ *         A 1 byte write sets the margin, a 3 bytes write also passes a link hint.
  *
- * @return The stored TX power level in \glos{NVM} if it is found.
- * @return \ref RBK_SMP290_BLE_TX_PWR_0_DBM if TX power level in \glos{NVM} is not found.
+ * @param  value  margin [dB], then the RSSI of the advertisements measured by the gateway [dBm]
+ *                and the TX power level they were sent at [dBm], as read from this characteristic
+ * @param  len    length of the value, \ref BLE_CUST_SVC_LINK_MARGIN_WR_LEN or
+ *                \ref BLE_CUST_SVC_LINK_HINT_WR_LEN
+ * @return true if the value is applied, false if the margin is out of range or the hint is not a valid RSSI.
+ *         Nothing is applied then.
  */
-int8_t readTxPwrFromNvm(void);
+bool config_link(const uint8_t *value, uint16_t len);
 
 /**
  * @brief  Configures Thermal Shut Down
@@ -45,6 +45,11 @@
 #define BLE_CUST_SVC_MEAS_TPAZ_CHAR_UUID_PART UINT16_C(0x1D32)  //!< TPAZ characteristics UUID
 #define BLE_CUST_SVC_MEAS_TAZAX_CHAR_UUID_PART UINT16_C(0x1D33) //!< TAZAX characteristics UUID
 #define BLE_CUST_SVC_MEAS_VBAT_CHAR_UUID_PART UINT16_C(0x1D34)  //!< VBAT characteristics UUID
+#define BLE_CUST_SVC_MEAS_HIST_CHAR_UUID_PART UINT16_C(0x1D35)  //!< History characteristics UUID
+#define BLE_CUST_SVC_MEAS_STREAM_CHAR_UUID_PART UINT16_C(0x1D36) //!< Stream characteristics UUID
+#define BLE_CUST_SVC_MEAS_DLVR_CHAR_UUID_PART UINT16_C(0x1D37)   //!< Delivery characteristics UUID
+#define BLE_CUST_SVC_MEAS_ALL_CHAR_UUID_PART UINT16_C(0x1D38)    //!< All channels characteristics UUID
+#define BLE_CUST_SVC_MEAS_ALARM_CHAR_UUID_PART UINT16_C(0x1D39)  //!< Alarm latency characteristics UUID
 
 /// Custom service 3bsac86d-xxxx-4876-8b9d-f5799cfa02ba
 /// Custom base UUID part 1
@@ -70,6 +75,21 @@
 /// Macro for Building the Custom Characteristics 34  UUID
 #define BLE_CUST_SVC_MEAS_VBAT_CHAR_UUID BLE_CUST_SVC_MEAS_BUILD(BLE_CUST_SVC_MEAS_VBAT_CHAR_UUID_PART)
 
+/// Macro for Building the Custom Characteristics 35  UUID
+#define BLE_CUST_SVC_MEAS_HIST_CHAR_UUID BLE_CUST_SVC_MEAS_BUILD(BLE_CUST_SVC_MEAS_HIST_CHAR_UUID_PART)
+
+/// Macro for Building the Custom Characteristics 36  UUID
+#define BLE_CUST_SVC_MEAS_STREAM_CHAR_UUID BLE_CUST_SVC_MEAS_BUILD(BLE_CUST_SVC_MEAS_STREAM_CHAR_UUID_PART)
+
+/// Macro for Building the Custom Characteristics 37  UUID
+#define BLE_CUST_SVC_MEAS_DLVR_CHAR_UUID BLE_CUST_SVC_MEAS_BUILD(BLE_CUST_SVC_MEAS_DLVR_CHAR_UUID_PART)
+
+/// Macro for Building the Custom Characteristics 38  UUID
+#define BLE_CUST_SVC_MEAS_ALL_CHAR_UUID BLE_CUST_SVC_MEAS_BUILD(BLE_CUST_SVC_MEAS_ALL_CHAR_UUID_PART)
+
+/// Macro for Building the Custom Characteristics 39  UUID
+#define BLE_CUST_SVC_MEAS_ALARM_CHAR_UUID BLE_CUST_SVC_MEAS_BUILD(BLE_CUST_SVC_MEAS_ALARM_CHAR_UUID_PART)
+
 
 #define BLE_CUST_SVC_MEAS_CCC_BUFF_SIZE    UINT8_C(3)      //!< Ble Indication buffer size
 #define BLE_CUST_SVC_MEAS_CCC_BUFF_SIZE_DOUBLE    UINT8_C(7)      //!< Ble Indication buffer size
@@ -78,6 +98,33 @@
 #define BLE_CUST_SVC_READ_REQ  0x01u  //!< Custom service read request
 #define BLE_CUST_SVC_WRITE_REQ 0x02u  //!< Custom service write request
 
+/// History characteristic: number of records stored since boot (uint32)
+#define BLE_CUST_SVC_MEAS_HIST_HDR_LEN 4u
+/// History characteristic: maximum number of blocks per read, fits the 512 bytes of an attribute
+#define BLE_CUST_SVC_MEAS_HIST_MAX_BLOCKS 3u
+/// History characteristic: length of the value
+#define BLE_CUST_SVC_MEAS_HIST_LEN (BLE_CUST_SVC_MEAS_HIST_HDR_LEN + (BLE_CUST_SVC_MEAS_HIST_MAX_BLOCKS * HISTORY_BLOCK_SIZE))
+/// History characteristic: length of the cursor written by the client (uint32)
+#define BLE_CUST_SVC_MEAS_HIST_CURSOR_LEN 4u
+/// Stream characteristic: length of the value, the frame of the cycle as it is (\ref ble_sensorData_tst, little endian)
+#define BLE_CUST_SVC_MEAS_STREAM_LEN ((uint16_t)sizeof(ble_sensorData_tst))
+/// Delivery characteristic: notifications, indications, confirmations and failures (uint32 each)
+#define BLE_CUST_SVC_MEAS_DLVR_LEN 16u
+/// Delivery characteristic: length of the burst length written by the client (uint16)
+#define BLE_CUST_SVC_MEAS_DLVR_BURST_LEN 2u
+/// Delivery characteristic: pace of the notified burst values and of the retries, about one connection event [ms]
+#define BLE_CUST_SVC_MEAS_DLVR_TMR_INTERVAL UINT32_C(8)
+/// All channels characteristic: length of the value, a frame with all the channels (\ref ble_sensorData_tst, little endian)
+#define BLE_CUST_SVC_MEAS_ALL_LEN ((uint16_t)sizeof(ble_sensorData_tst))
+/// All channels characteristic: number of conversions of the capture (TpAz, TAzAx low, TAzAx high, Vbat)
+#define BLE_CUST_SVC_MEAS_ALL_STEPS 4u
+/// Alarm latency characteristic: latency of the last deflation alarm and maximum latency since boot [ms] (uint32 each)
+#define BLE_CUST_SVC_MEAS_ALARM_LEN 8u
+/// Measurement requests queued behind the ongoing one
+#define BLE_CUST_SVC_MEAS_QUEUE_LEN 4u
+/// Application error returned to a measurement request when the queue is full or the sensor is busy
+#define BLE_CUST_SVC_MEAS_ERR_BUSY ((rbk_smp290_ble_atts_err_ten)0x80u)
+
 /// TSD default value
 
 
@@ -107,6 +154,23 @@ typedef enum
     BLE_CUST_SVC_MEAS_VBAT_CHAR_DATA_HNDL,               //!< Custom Characteristic 4 Data Handle  0x2901
     BLE_CUST_SVC_MEAS_VBAT_CHAR_CUD_HNDL,                //!< Custom Characteristic 4 Characteristic User Description 0x2901
     BLE_CUST_SVC_MEAS_VBAT_CHAR_CCC_HNDL,                 //!< Custom Characteristic 4 Client Characteristics Configuration 0x2902
+    BLE_CUST_SVC_MEAS_HIST_CHAR_HNDL,                    //!< Custom Characteristic 5 Handle
+    BLE_CUST_SVC_MEAS_HIST_CHAR_DATA_HNDL,               //!< Custom Characteristic 5 Data Handle
+    BLE_CUST_SVC_MEAS_HIST_CHAR_CUD_HNDL,                //!< Custom Characteristic 5 Characteristic User Description 0x2901
+    BLE_CUST_SVC_MEAS_STREAM_CHAR_HNDL,                  //!< Custom Characteristic 6 Handle
+    BLE_CUST_SVC_MEAS_STREAM_CHAR_DATA_HNDL,             //!< Custom Characteristic 6 Data Handle
+    BLE_CUST_SVC_MEAS_STREAM_CHAR_CUD_HNDL,              //!< Custom Characteristic 6 Characteristic User Description 0x2901
+    BLE_CUST_SVC_MEAS_STREAM_CHAR_CCC_HNDL,              //!< Custom Characteristic 6 Client Characteristics Configuration 0x2902
+    BLE_CUST_SVC_MEAS_DLVR_CHAR_HNDL,                    //!< Custom Characteristic 7 Handle
+    BLE_CUST_SVC_MEAS_DLVR_CHAR_DATA_HNDL,               //!< Custom Characteristic 7 Data Handle
+    BLE_CUST_SVC_MEAS_DLVR_CHAR_CUD_HNDL,                //!< Custom Characteristic 7 Characteristic User Description 0x2901
+    BLE_CUST_SVC_MEAS_ALL_CHAR_HNDL,                     //!< Custom Characteristic 8 Handle
+    BLE_CUST_SVC_MEAS_ALL_CHAR_DATA_HNDL,                //!< Custom Characteristic 8 Data Handle
+    BLE_CUST_SVC_MEAS_ALL_CHAR_CUD_HNDL,                 //!< Custom Characteristic 8 Characteristic User Description 0x2901
+    BLE_CUST_SVC_MEAS_ALL_CHAR_CCC_HNDL,                 //!< Custom Characteristic 8 Client Characteristics Configuration 0x2902
+    BLE_CUST_SVC_MEAS_ALARM_CHAR_HNDL,                   //!< Custom Characteristic 9 Handle
+    BLE_CUST_SVC_MEAS_ALARM_CHAR_DATA_HNDL,              //!< Custom Characteristic 9 Data Handle
+    BLE_CUST_SVC_MEAS_ALARM_CHAR_CUD_HNDL,               //!< Custom Characteristic 9 Characteristic User Description 0x2901
 	BLE_CUST_SVC_MEAS_MAX_HNDL
 } measSvc_ten;
 
@@ -186,6 +250,17 @@ void custmeasSvc_procCccEvt(rbk_smp290_ble_atts_CccVal_ten cccVal, rbk_smp290_bl
  */
 void custmeasSvc_indication_confiramtion(void);
 
+/**
+ * @brief This \glos{API} processes the end of a handle value notification or indication.
+ * @details The stack reports a notification once sent and an indication once confirmed by the client.
+ *          The next value of a delivery burst is sent from here.
+ *
+ * @param  hndl  The attribute handle of the value.
+ *
+ * return void
+ */
+void custmeasSvc_procValueCnf(rbk_smp290_ble_attsHndl hndl);
+
 /**
  * @brief This \glos{API} to registers the application-specific callback.
  *
@@ -196,8 +271,39 @@ void custmeasSvc_indication_confiramtion(void);
 void custmeasSvcRegAppCbk(measSvcAppCbk cbk);
 
 
+/**
+ * @brief This \glos{API} resets the client state of the service at the end of a connection.
+ * @details The pending measurement requests are dropped and the sensor is released to the sequence.
+ *
+ * return void
+ */
+void custmeasSvc_reset(void);
+
+/**
+ * @brief This \glos{API} starts the oldest measurement request queued by the client.
+ * @details Called on every sensor completion. A request rejected as the sensor is busy stays queued and is retried
+ *          on the next completion. A request rejected for another reason is dequeued, its error is sent in the value
+ *          of its characteristic.
+ *
+ * return void
+ */
+void custmeasSvc_procMeasQueue(void);
+
+/**
+ * @brief This \glos{API} streams the frame of a completed cycle to the client.
+ * @details The frame is sent as one packed value if the client subscribed to the Stream
+ *          characteristic, it is also the value read from it.
+ *
+ * @param  frame_p  The frame of the cycle.
+ *
+ * return void
+ */
+void custmeasSvc_streamFrame(ble_sensorData_tst const *frame_p);
+
 /**
  * @brief Meas done callback
+ * @details Called by the task on \b SIG_MEASMT_DONE when the client owns the conversion, outside of the
+ *          sensor driver callback.
  * @param status self return success or error values
  */
 void entry_ConnSnsrClbk( rbk_smp290_snsr_err_ten status);
@@ -23,10 +23,35 @@
 #include "rbk_smp290_timer.h"
 #include "rbk_smp290_gpio.h"
 #include "rbk_smp290_slftst.h"
+#include "rbk_smp290_nvm.h"
 
 /******************************************************************************\
  * Types
  \******************************************************************************/
+/// @addtogroup measure_advertise_conn_seq_cfg Sequence configuration definitions
+/// @{
+
+/// Measured channels. Channels which are not due in a cycle keep their last value.
+typedef enum
+{
+    SEQ_CH_T,      //!< Temperature
+    SEQ_CH_P,      //!< Pressure
+    SEQ_CH_AZ_LO,  //!< Az low range
+    SEQ_CH_AZ_HI,  //!< Az high range
+    SEQ_CH_AX_LO,  //!< Ax low range
+    SEQ_CH_AX_HI,  //!< Ax high range
+    SEQ_CH_VBAT,   //!< Battery voltage
+    SEQ_CH_MAX     //!< Number of channels
+} seq_channel_ten;
+
+/// Bit of a channel in a channel mask
+#define SEQ_CH_BIT(ch) ((uint8_t)(1u << (uint8_t)(ch)))
+
+/// Age of a channel never measured, or measured more cycles ago
+#define SEQ_AGE_NEVER UINT8_MAX
+
+/// @}
+
 /// @addtogroup measure_advertise_conn_adv_cfg BLE Adv. configuration definitions
 /// @{
 
@@ -35,19 +60,80 @@
 #pragma pack(1)
 typedef struct
 {
-    int16_t p_out;          //!< Pressure
-    int16_t T_out;          //!< Temperature
-    int16_t Az_lo_out;      //!< Az low
-    int16_t Az_hi_out;      //!< Az hi
-    int16_t Ax_lo_out;      //!< Ax low
-    int16_t Ax_hi_out;      //!< Ax hi
-    int16_t Vbat_out;       //!< Vbat
-    uint8_t error;          //!< error status
-    uint8_t frame_counter;  //!< frame counter
+    int16_t p_out;            //!< Pressure
+    int16_t T_out;            //!< Temperature
+    int16_t Az_lo_out;        //!< Az low
+    int16_t Az_hi_out;        //!< Az hi
+    int16_t Ax_lo_out;        //!< Ax low
+    int16_t Ax_hi_out;        //!< Ax hi
+    int16_t Vbat_out;         //!< Vbat
+    uint8_t error;            //!< error status
+    uint8_t frame_counter;    //!< frame counter
+    uint8_t fresh;            //!< Channels measured in this cycle, bit mask of \ref seq_channel_ten
+    uint8_t flags;            //!< Frame flags, see \ref SEQ_FLAG_ACC_RANGE_LO
+    uint8_t age[SEQ_CH_MAX];  //!< Cycles since each channel was last measured, 0 if fresh, see \ref SEQ_AGE_NEVER
 } ble_sensorData_tst;
 
 // Restore default pack
 #pragma pack()
+
+/// Frame flag: the low range accelerometer values were measured in this cycle
+#define SEQ_FLAG_ACC_RANGE_LO ((uint8_t)0x01u)
+/// Frame flag: the high range accelerometer values were measured in this cycle
+#define SEQ_FLAG_ACC_RANGE_HI ((uint8_t)0x02u)
+/// Frame flag: rapid deflation alarm
+#define SEQ_FLAG_ALARM ((uint8_t)0x04u)
+
+/// Advertising trigger configuration
+typedef struct
+{
+    uint16_t p_delta;      //!< Pressure change that triggers an Adv. [LSB]
+    uint16_t T_delta;      //!< Temperature change that triggers an Adv. [LSB]
+    uint16_t heartbeat_s;  //!< Maximum time between two Adv. [s]
+} adv_trigCfg_tst;
+
+/// Operating states of the advertising policy
+typedef enum
+{
+    ADV_STATE_PARKED,      //!< Parked profile: sparse bursts
+    ADV_STATE_DRIVING,     //!< Driving profile
+    ADV_STATE_TRANSITION,  //!< Transition profile: short bursts within the 250 ms cycle
+    ADV_STATE_ALARM,       //!< Deflation alarm frames: short dense bursts
+    ADV_STATE_MAINT,       //!< Maintenance: long connectable discovery window
+    ADV_STATE_MAX          //!< Number of states
+} adv_state_ten;
+
+/// Advertising modes
+typedef enum
+{
+    ADV_MODE_CONNECTABLE,  //!< Every burst is connectable
+    ADV_MODE_BROADCAST,    //!< Sensor frames are broadcast non-connectable, with periodic connectable windows
+    ADV_MODE_MAX           //!< Number of modes
+} adv_mode_ten;
+
+/// Advertising settings of a state
+typedef struct
+{
+    uint16_t interval;  //!< Adv. interval [0.625 ms], 0x0020 to 0x4000
+    uint16_t duration;  //!< Adv. duration [ms], 0 is infinity
+} adv_cadence_tst;
+
+/// The firmware and hardware versions are set by the build, see the project Makefile
+#if !defined(DEVINFO_FW_VERSION_MAJOR) || !defined(DEVINFO_FW_VERSION_MINOR) || !defined(DEVINFO_FW_VERSION_PATCH) || \
+    !defined(DEVINFO_HW_VERSION)
+#error "The firmware and hardware versions are not defined by the build"
+#endif
+
+/// Device information of the scan response, cached in \glos{NVM}
+typedef struct
+{
+    uint8_t fwMajor;    //!< Firmware version: major
+    uint8_t fwMinor;    //!< Firmware version: minor
+    uint8_t fwPatch;    //!< Firmware version: patch
+    uint8_t hwVersion;  //!< Hardware version
+    uint8_t profile;    //!< Active sampling profile, see \ref motion_profile_ten
+    uint8_t vbat;       //!< Last battery voltage [2 LSB, 10 mV], 0 if never measured
+} adv_devInfo_tst;
 /// @}
 
 /// @addtogroup measure_advertise_conn_qpc_sigs Task signals
@@ -59,9 +145,131 @@ typedef enum
     SIG_ENTRY = QPC_FIRST_USER_SIGNAL,  //!<  First signal that can be used for user signals
     SIG_TIMER_TICK,                     //!<  Signal triggered when the sequence timer is elapsed
     SIG_MEASMT_DONE,                    //!<  Signal triggered by the measurement callback
-    SIG_ADV                             //!<  Signal to trigger Adv. and publish measurement results
+    SIG_ADV,                            //!<  Signal to trigger Adv. and publish measurement results
+    SIG_NVM_FLUSH                       //!<  Signal to write the dirty configuration to \glos{NVM}
 } proj_qpcTaskSig_ten;
 
+/// Owner of the sensor conversion in flight, the sensor completion is routed to it
+typedef enum
+{
+    SNSR_OWNER_NONE,      //!< No conversion in flight
+    SNSR_OWNER_SEQUENCE,  //!< Conversion started by the sequence
+    SNSR_OWNER_CLIENT     //!< Conversion requested by the client over \glos{GATT}
+} snsr_owner_ten;
+
+/// @}
+
+/// @addtogroup measure_advertise_conn_seq_cfg Sequence configuration definitions
+/// @{
+
+/// Measurement plans that can be selected at runtime
+typedef enum
+{
+    SEQ_PLAN_FULL,      //!< T, TpAz, TazAx low and high, Vbat and Adv. every cycle
+    SEQ_PLAN_PRESSURE,  //!< TpAz and Adv. every cycle
+    SEQ_PLAN_MAX        //!< Number of plans
+} seq_planId_ten;
+
+/// @}
+
+/// @addtogroup measure_advertise_conn_motion_cfg Motion detection configuration definitions
+/// @{
+
+/// Sampling profiles selected by the motion detection
+typedef enum
+{
+    MOTION_PROFILE_PARKED,      //!< Wheel standing still, low sampling rate
+    MOTION_PROFILE_DRIVING,     //!< Wheel rotating, normal sampling rate
+    MOTION_PROFILE_TRANSITION,  //!< Wheel starting or stopping, high sampling rate
+    MOTION_PROFILE_MAX          //!< Number of profiles
+} motion_profile_ten;
+
+/// @}
+
+/// @addtogroup measure_advertise_conn_txpwr_cfg TX power control configuration definitions
+/// @{
+
+/// RSSI not available [dBm]
+#define TXPWR_RSSI_NONE ((int8_t)127)
+
+/// @}
+
+/// @addtogroup measure_advertise_conn_nvm_cfg Configuration store definitions
+/// @{
+
+/// \glos{NVM} layout: address of the first page reserved to the application
+#define NVM_APP_BASE_ADR 0x404800u
+
+/// \glos{NVM} layout: size of a page [bytes], the unit of the erase
+#define NVM_APP_PAGE_SIZE 0x800u
+
+/// \glos{NVM} layout: number of pages reserved to the application, all of them held by the configuration store
+#define NVM_APP_NUM_PAGES 3u
+
+/// \glos{NVM} layout: address of a page reserved to the application
+#define NVM_APP_PAGE_ADR(page) (NVM_APP_BASE_ADR + ((uint32_t)(page) * NVM_APP_PAGE_SIZE))
+
+/// Configuration items stored in \glos{NVM}, the value is the key of the records: only append
+typedef enum
+{
+    NVM_ITEM_TXPWR,    //!< Maximum TX power level
+    NVM_ITEM_ADVTRIG,  //!< Advertising trigger configuration
+    NVM_ITEM_DEVINFO,  //!< Device information of the scan response
+    NVM_ITEM_TSD,      //!< TSD state
+    NVM_ITEM_ADVPOL,   //!< Advertising policy: settings of every state
+    NVM_ITEM_ADVMODE,  //!< Advertising mode and period of the connectable windows
+    NVM_ITEM_LINK,     //!< Margin of the TX power control
+    NVM_ITEM_MAX       //!< Number of items
+} nvm_item_ten;
+
+/// @}
+
+/// @addtogroup measure_advertise_conn_hist_cfg Sample history configuration definitions
+/// @{
+
+/// Size of the history in the retained RAM [bytes]
+#define HISTORY_POOL_SIZE 1280u
+
+/// Size of a history block [bytes], a block is the unit of random access
+#define HISTORY_BLOCK_SIZE 128u
+
+/// Number of blocks of the history
+#define HISTORY_NUM_BLOCKS (HISTORY_POOL_SIZE / HISTORY_BLOCK_SIZE)
+
+/// Maximum length of an encoded record: time 5, p 3, T 3, flags and error 2 [bytes]
+#define HISTORY_ENC_MAX_LEN 13u
+
+/// Record of the sample history
+// Pack the following struct
+#pragma pack(1)
+typedef struct
+{
+    uint32_t time_ms;  //!< Sequence time of the sample [ms]
+    int16_t p_out;     //!< Pressure
+    int16_t T_out;     //!< Temperature
+    uint8_t flags;     //!< Frame flags, see \ref SEQ_FLAG_ACC_RANGE_LO
+    uint8_t error;     //!< error status
+} hist_record_tst;
+
+/// Header of a history block, followed by the encoded records
+typedef struct
+{
+    uint32_t seq;           //!< Sequence number of the first record
+    hist_record_tst first;  //!< First record of the block, not encoded
+    uint8_t count;          //!< Number of records in the block, including the first one
+    uint8_t len;            //!< Number of bytes of encoded records after the header
+} hist_blockHdr_tst;
+
+/// Block of the sample history
+typedef struct
+{
+    hist_blockHdr_tst hdr;                                         //!< Block header
+    uint8_t data[HISTORY_BLOCK_SIZE - sizeof(hist_blockHdr_tst)];  //!< Encoded records
+} hist_block_tst;
+
+// Restore default pack
+#pragma pack()
+
 /// @}
 
 /******************************************************************************\
@@ -104,11 +312,29 @@ void task_postEventFromIsr(enum_t signal, void *pParams);
 
 /**
  * @brief   Sensor driver callback
+ * @details Posts the completion to Task1, the measurement is collected at task level by the
+ *          owner of the conversion, see \ref task_setSnsrOwner.
  * @param   status
  * return   void
  */
 void entry_snsrClbk(rbk_smp290_snsr_err_ten status);
 
+/**
+ * @brief   Records the owner of the sensor conversion in flight
+ * @details Set by the sequence and by the measurement service once the sensor driver accepted a
+ *          conversion, the completion is then routed to the owner. The sensor is released when the
+ *          completion is processed, a new conversion is not started before.
+ * @param   owner The owner of the conversion.
+ * return   void
+ */
+void task_setSnsrOwner(snsr_owner_ten owner);
+
+/**
+ * @brief   Returns the owner of the sensor conversion in flight
+ * @return  The owner, \ref SNSR_OWNER_NONE if the sensor is free
+ */
+snsr_owner_ten task_getSnsrOwner(void);
+
 /**
  * @name entry_slftstClbk measure_advertise
  * @brief Sensor driver callback
@@ -118,26 +344,30 @@ void entry_slftstClbk(rbk_smp290_slftst_err_ten status);
 
 /**
  * @brief    Initializes the sequence.
- * @details  This function initializes the sequence by creating and enabling
- *           the sequence timer.
+ * @details  This function initializes the sequence by creating the sequence timer.
+ *           The timer is used as a one-shot that is re-armed for the next step
+ *           which has work to do, idle slots are slept through. It also runs the
+ *           plan optimizer which drops redundant sensor conversions.
  * return    void
  */
 void sequence_init(void);
 
 /**
  * @brief    Runs the sequence.
- * @details  This function runs the sequence by performing the measurements
- *           based on the current sequence iterator. It also handles failed
- *           measurements and updates the sequence iterator.
+ * @details  This function runs the step of the active measurement plan that
+ *           the sequence iterator points to. It also handles failed
+ *           measurements and updates the sequence iterator. The advertising step
+ *           selects the accelerometer range before the timer is armed, so the
+ *           next due step is found with the new range.
  * return    void
  */
 void sequence_run(void);
 
 /**
  * @brief    Retrieve the output values after an iteration of the sequence.
- * @details  This function retrieves the output values from the sequence based
- *           on the current sequence iterator and updates the adv_sensorData
- *           structure.
+ * @details  This function calls the collect function of the current step of
+ *           the active plan, which updates the sensor data window of the
+ *           advertising payload in place.
  * @param    status: status of the last measurement sequence iteration.
  * return    void
  */
@@ -157,6 +387,195 @@ void sequence_resume(void);
  */
 void sequence_stop(void);
 
+/**
+ * @brief    Returns the number of sequence timer wakeups of the last completed cycle.
+ * @details  Idle slots do not wake the SMP290 up, so this equals the number of
+ *           steps due in the cycle.
+ * @return   The number of wakeups per cycle.
+ */
+uint8_t sequence_getWakeupsPerCycle(void);
+
+/**
+ * @brief    Returns the number of sensor conversions per cycle of a plan.
+ * @details  The plan optimizer run by \ref sequence_init drops the conversions
+ *           whose channels are already yielded by another measurement of the
+ *           plan. Steps with a divider count as a fraction of a conversion.
+ * @param    planId plan
+ * @return   The number of conversions per cycle, in hundredths.
+ */
+uint16_t sequence_getConversionsPerCycle(seq_planId_ten planId);
+
+/**
+ * @brief    Returns the sequence time.
+ * @details  The sequence time is the slot time of the current step, it only
+ *           advances while the sequence runs.
+ * @return   The sequence time [ms].
+ */
+uint32_t sequence_getTime(void);
+
+/**
+ * @brief    Selects the measurement plan run by the sequence.
+ * @details  The plan becomes active at the start of the next cycle, so the
+ *           ongoing cycle is completed with the previous plan.
+ * @param    planId plan to select
+ * return    void
+ */
+void sequence_selectPlan(seq_planId_ten planId);
+
+/**
+ * @brief    Sets the cycle length of the sequence.
+ * @details  The cycle length is applied at the end of the ongoing cycle. It is
+ *           ignored if it is too short for the steps of the active plan.
+ * @param    cycle_ms cycle length [ms], 0 for the default of the plan
+ * return    void
+ */
+void sequence_setCycle(uint32_t cycle_ms);
+
+/**
+ * @brief    Initializes the motion detection.
+ * @details  The driving profile is active until enough samples are collected.
+ * return    void
+ */
+void motion_init(void);
+
+/**
+ * @brief    Updates the motion detection with a new acceleration sample.
+ * @details  This function is called once per cycle by the sequence. When the
+ *           classification changes, the plan and cycle length of the new
+ *           profile are requested from the sequence.
+ * @param    Az_hi centripetal acceleration, high range
+ * return    void
+ */
+void motion_update(int16_t Az_hi);
+
+/**
+ * @brief    Returns the active sampling profile.
+ * @return   The active profile.
+ */
+motion_profile_ten motion_getProfile(void);
+
+/**
+ * @brief    Returns the cycle length of a sampling profile.
+ * @param    profile sampling profile
+ * @return   The cycle length [ms].
+ */
+uint32_t motion_getCycle(motion_profile_ten profile);
+
+/**
+ * @brief    Holds or releases the high rate sampling profile.
+ * @details  While held, the transition profile is active whatever the motion.
+ * @param    hold true to hold, false to release
+ * return    void
+ */
+void motion_hold(bool hold);
+
+/**
+ * @brief    Updates the deflation alarm with a new pressure sample.
+ * @details  This function is called by the sequence on every pressure sample.
+ *           A deflating sample holds the high rate profile until the deflation
+ *           is confirmed or discarded.
+ * @param    p      pressure [LSB]
+ * @param    now_ms sequence time of the sample [ms]
+ * @return   true when the alarm is raised by this sample
+ */
+bool alarm_update(int16_t p, uint32_t now_ms);
+
+/**
+ * @brief    Tells if the deflation alarm is active.
+ * @return   true if the alarm is active
+ */
+bool alarm_isActive(void);
+
+/**
+ * @brief    Returns the latency of the last deflation alarm.
+ * @details  The latency is the time from the last sample without deflation
+ *           to the sample raising the alarm, which is advertised immediately.
+ *           The first deflating sample re-arms the sequence at the cycle of the
+ *           transition profile, so the latency is bounded by one cycle of the
+ *           active profile plus one cycle of the transition profile.
+ * @return   The latency [ms].
+ */
+uint32_t alarm_getLatency(void);
+
+/**
+ * @brief    Returns the maximum latency of all deflation alarms since boot.
+ * @return   The maximum latency [ms].
+ */
+uint32_t alarm_getMaxLatency(void);
+
+/**
+ * @brief    Stores a frame in the sample history.
+ * @details  This function is called by the sequence once per cycle with fresh
+ *           pressure. The record is delta encoded into the newest block. The
+ *           oldest block is overwritten when the history is full.
+ * @param    frame_p frame of the cycle
+ * @param    now_ms  sequence time of the frame [ms]
+ * return    void
+ */
+void history_add(ble_sensorData_tst const *frame_p, uint32_t now_ms);
+
+/**
+ * @brief    Reads encoded blocks from the sample history.
+ * @details  The blocks holding records from a sequence number on are copied as
+ *           they are stored: the header followed by its encoded records. The
+ *           block being filled is included, so it is read again once it grows.
+ *           If the requested records are already overwritten, the read starts
+ *           at the oldest block.
+ * @param    from   sequence number of the first record to read
+ * @param    dst_p  destination of the blocks
+ * @param    maxLen size of the destination [bytes]
+ * @param    next_p sequence number following the last record read
+ * @return   The number of bytes read.
+ */
+uint16_t history_readBlocks(uint32_t from, uint8_t *dst_p, uint16_t maxLen, uint32_t *next_p);
+
+/**
+ * @brief    Returns the number of records stored in the history since boot.
+ * @return   The sequence number of the next record.
+ */
+uint32_t history_getTotal(void);
+
+/**
+ * @brief    Clears the sensor frames of the handoff between the sequence and the advertiser.
+ * @details  The handoff functions are called from Task1 only, they are not interrupt safe.
+ * return    void
+ */
+void snapshot_init(void);
+
+/**
+ * @brief    Returns the sensor frame written by the sequence.
+ * @details  The sensor frames are triple buffered. The sequence writes its measurements
+ *           in place into the frame of its slot. The slot taken by the advertiser is
+ *           never written, the advertising payload is encoded from it per burst.
+ * @return   The sensor frame of the slot written by the sequence.
+ */
+ble_sensorData_tst *snapshot_getWindow(void);
+
+/**
+ * @brief    Publishes the sensor frame written by the sequence.
+ * @details  The slot of the sequence gets a new sequence number and becomes the
+ *           ready slot, taken by \ref snapshot_take. The sequence continues in the
+ *           previous ready slot, initialized with the published frame, so the
+ *           channels which are not measured are carried forward.
+ * @return   The sensor frame of the new slot of the sequence.
+ */
+ble_sensorData_tst *snapshot_publish(void);
+
+/**
+ * @brief    Takes the last published sensor frame for the advertiser.
+ * @details  The ready slot is exchanged with the slot of the advertiser if its frame is
+ *           newer. The frame is not written until the next call.
+ * @return   The sensor frame of the advertiser.
+ */
+ble_sensorData_tst const *snapshot_take(void);
+
+/**
+ * @brief    Returns the last published sensor frame.
+ * @details  The frame is either ready or taken by the advertiser, it is not written.
+ * @return   The last published sensor frame.
+ */
+ble_sensorData_tst const *snapshot_getLast(void);
+
 /**
  * @brief   Initializes the advertising parameters and configurations.
  * @details This function is responsible for initializing the BLE advertising parameters and configurations.
@@ -170,31 +589,251 @@ void sequence_stop(void);
  */
 void adv_init(void);
 
-/**
- * @brief   Prepares the advertising data payload.
- * @details This function is responsible for preparing the advertising data payload.
- *          It constructs the advertising data payload using specific structures defined in this file.
- *          The payload includes flags, sensor data, and appearance.
- *          The advertising data payload is then stored in a global variable for reuse.
- * @note    This function should be called before starting the advertising process.
- * @param   adv_sensorData_p Pointer to the sensor data structure.
- * return   void
- */
-void adv_prepSrvData(ble_sensorData_tst const *adv_sensorData_p);
-
 /**
  * @brief   Starts the advertising process.
  * @details This function is responsible for starting the BLE advertising
- * process. It passes the advertising data payload to the RBK SMP290 BLE library
- * for advertising. The advertising process is then started using the RBK SMP290
+ * process. It takes the last published advertising data payload, if it is newer than
+ * the one of the radio, and passes it to the RBK SMP290 BLE library
+ * for advertising. The advertising interval and duration are the ones of the
+ * operating state: maintenance, alarm or the active sampling profile, in this
+ * order of priority. The advertising process is then started using the RBK SMP290
  * BLE library.
- * @note    This function should be called after preparing the advertising data
- * payload. 
+ * @note    This function should be called after publishing the sensor data
+ * with \ref snapshot_publish.
  *
  * return   void
  */
 void adv_doAdv(void);
 
+/**
+ * @brief   Tells if a frame has to be advertised.
+ * @details A frame is advertised when the pressure or the temperature moved by
+ *          more than the configured delta since the last advertised frame, when
+ *          the heartbeat period elapsed, or while the deflation alarm is active.
+ * @param   frame_p frame of the cycle
+ * @param   now_ms  sequence time [ms]
+ * @return  true if the frame has to be advertised
+ */
+bool adv_isDue(ble_sensorData_tst const *frame_p, uint32_t now_ms);
+
+/**
+ * @brief   Sets the advertising trigger configuration.
+ * @param   cfg_p configuration to apply
+ * return   void
+ */
+void adv_setTrigCfg(adv_trigCfg_tst const *cfg_p);
+
+/**
+ * @brief   Returns the advertising trigger configuration.
+ * @return  The active configuration.
+ */
+adv_trigCfg_tst const *adv_getTrigCfg(void);
+
+/**
+ * @brief   Returns the device information of the scan response.
+ * @return  The device information.
+ */
+adv_devInfo_tst const *adv_getDevInfo(void);
+
+/**
+ * @brief   Sets the advertising settings of a state.
+ * @details The settings apply from the next burst of the state. The interval is within the
+ *          range of the legacy advertising, 20 ms to 10.24 s. The burst is finite and ends
+ *          before the next cycle of the state: the duration is at least 1 ms and shorter than
+ *          the cycle, the shortest one for the maintenance state which runs in every profile.
+ * @param   state      state to configure
+ * @param   cadence_p  settings to apply
+ * @return  false if the state or the settings are out of range, they are then not applied
+ */
+bool adv_setCadence(adv_state_ten state, adv_cadence_tst const *cadence_p);
+
+/**
+ * @brief   Returns the advertising settings of a state.
+ * @param   state  state
+ * @return  The settings of the state.
+ */
+adv_cadence_tst const *adv_getCadence(adv_state_ten state);
+
+/**
+ * @brief   Sets or clears the maintenance flag.
+ * @details While the flag is set, every burst uses the \ref ADV_STATE_MAINT settings,
+ *          a long window in which a central can discover the sensor and connect.
+ * @param   on  true to set the flag
+ * return   void
+ */
+void adv_setMaintenance(bool on);
+
+/**
+ * @brief   Tells if the maintenance flag is set.
+ * @return  true if the flag is set
+ */
+bool adv_isMaintenance(void);
+
+/**
+ * @brief   Sets the advertising mode.
+ * @details In the broadcast mode, the sensor frames are sent as ADV_NONCONN_IND: the
+ *          events do not listen for a SCAN_REQ or a CONNECT_IND. A connectable window
+ *          with the \ref ADV_STATE_MAINT settings is opened every period, so the sensor
+ *          stays reachable over the air.
+ * @param   mode      mode to apply
+ * @param   period_s  period of the connectable windows in the broadcast mode [s], not 0
+ * @return  false if the mode is unknown or broadcast without windows, it is then not applied
+ */
+bool adv_setMode(adv_mode_ten mode, uint16_t period_s);
+
+/**
+ * @brief   Returns the advertising mode.
+ * @return  The active mode.
+ */
+adv_mode_ten adv_getMode(void);
+
+/**
+ * @brief   Returns the period of the connectable windows in the broadcast mode.
+ * @return  The period [s].
+ */
+uint16_t adv_getConnWindowPeriod(void);
+
+/**
+ * @brief   Returns the radio-on time of a state in the last complete hour.
+ * @details The time is estimated per burst from the number of advertising events,
+ *          the three channels, the air time of the PDU and, for a connectable burst,
+ *          the receive window after every PDU.
+ * @param   state  state
+ * @return  The radio-on time [us].
+ */
+uint32_t adv_getRadioOnTime(adv_state_ten state);
+
+/**
+ * @brief   Initializes the TX power control.
+ * @details Creates the RSSI reading timer and starts from the maximum level.
+ * @param   max  The maximum TX power level [dBm].
+ * return   void
+ */
+void txpwr_init(int8_t max);
+
+/**
+ * @brief   Sets the maximum TX power level.
+ * @details The level is applied at once, the control lowers it again from the next RSSI.
+ * @param   max  The maximum TX power level [dBm].
+ * return   void
+ */
+void txpwr_setMax(int8_t max);
+
+/**
+ * @brief   Returns the maximum TX power level.
+ * @return  The maximum TX power level [dBm].
+ */
+int8_t txpwr_getMax(void);
+
+/**
+ * @brief   Sets the margin kept above the sensitivity of the receiver.
+ * @details A margin above 40 dB is refused, it would pin the maximum level on any link.
+ * @param   margin_dB  The margin [dB].
+ * @return  true if the margin is applied, false if it is out of range
+ */
+bool txpwr_setMargin(uint8_t margin_dB);
+
+/**
+ * @brief   Returns the margin kept above the sensitivity of the receiver.
+ * @return  The margin [dB].
+ */
+uint8_t txpwr_getMargin(void);
+
+/**
+ * @brief   Returns the last RSSI the level was adjusted to.
+ * @return  The RSSI [dBm], \ref TXPWR_RSSI_NONE before the first one.
+ */
+int8_t txpwr_getRssi(void);
+
+/**
+ * @brief   Adjusts the TX power level of the advertising to a link hint.
+ * @details The hint is the RSSI of the advertisements measured by a gateway and the
+ *          TX power level they were sent at. The new level is computed from that level,
+ *          not from the current one, so a repeated hint is applied once. It is applied
+ *          when unconnected, from the next disconnection if connected.
+ * @param   rssi   The RSSI [dBm].
+ * @param   level  The TX power level the RSSI was measured at [dBm].
+ * return   void
+ */
+void txpwr_setLinkHint(int8_t rssi, int8_t level);
+
+/**
+ * @brief   Adjusts the TX power level to the RSSI of the peer.
+ * @details Called on \b RBK_SMP290_BLE_GAP_READ_RSSI, ignored when unconnected.
+ * @param   rssi  The RSSI [dBm].
+ * return   void
+ */
+void txpwr_onRssi(int8_t rssi);
+
+/**
+ * @brief   Starts the periodic RSSI readings of a connection.
+ * return   void
+ */
+void txpwr_onConnected(void);
+
+/**
+ * @brief   Stops the RSSI readings and restores the TX power level of the advertising.
+ * return   void
+ */
+void txpwr_onDisconnected(void);
+
+/**
+ * @brief   Initializes the configuration store.
+ * @details Builds the index of the records from the pages in \glos{NVM} and completes an
+ *          interrupted compaction. Without a valid page, the store is formatted and the
+ *          configuration of the former fixed words is taken over. Creates the flush timer.
+ * return   void
+ */
+void nvm_init(void);
+
+/**
+ * @brief   Reads a configuration item from \glos{NVM}.
+ * @param   item   item
+ * @param   dst_p  The value to fill, left unchanged if the item is not found.
+ * @param   len    The length of the value, the stored one has to match.
+ * @return  true if the item is found, false otherwise
+ */
+bool nvm_get(nvm_item_ten item, void *dst_p, uint8_t len);
+
+/**
+ * @brief   Appends a record of a configuration item to \glos{NVM}, unless it already holds the value.
+ * @details A full page is compacted: the next page is erased and the live records of the oldest
+ *          page are copied into it.
+ * @param   item     item
+ * @param   value_p  The value.
+ * @param   len      The length of the value.
+ * @return  @ref RBK_SMP290_NVM_SUCCESS if operation is successful, else the NVM driver error
+ */
+rbk_smp290_nvm_err_ten nvm_set(nvm_item_ten item, void const *value_p, uint8_t len);
+
+/**
+ * @brief   Marks a configuration item dirty.
+ * @details The item is written by \ref nvm_flush when the debounce timer expires,
+ *          with the value of its owner at that time.
+ * @param   item  item
+ * return   void
+ */
+void nvm_setDirty(nvm_item_ten item);
+
+/**
+ * @brief   Writes the dirty configuration items to \glos{NVM}.
+ * @details Called by the task on \b SIG_NVM_FLUSH. The failed items are retried.
+ * return   void
+ */
+void nvm_flush(void);
+
+/**
+ * @brief   Returns the number of \glos{NVM} page erases since reset.
+ * @return  The number of erases.
+ */
+uint32_t nvm_getEraseCnt(void);
+
+/**
+ * @brief   Returns the number of \glos{NVM} words written since reset.
+ * @return  The number of writes.
+ */
+uint32_t nvm_getWriteCnt(void);
+
 /**
  * @brief  Initializes the \glos{GATT} profile.
  * @details This function initializes the attribute server, sets the ACL MAX length,
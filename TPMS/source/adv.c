@@ -10,8 +10,28 @@
  *               interval, duration, and MTU size are configurable constants defined in this file.
  * @note         For BLE advertising, the company ID, appearance, and advertising interval are set to specific values.
  * @note         The advertising data payload is constructed using specific structures defined in this file.
- * @note         The advertising data payload includes flags, sensor data, and appearance.
- * @note         The advertising data payload is stored in a global variable for reuse.
+ * @note         The advertising data payload includes flags, appearance, and the sensor data in a compact format.
+ * @note         The sensor frame of every burst is taken from the triple buffer of snapshot.c, it is never written
+ *               while the advertiser holds it. The frame is taken in Task1, as the sequence publishes it.
+ * @note         The compact format starts with a format byte, followed by the frame counter and the flags. The pressure
+ *               is sent in 12 bits and the temperature in 8 bits, the accelerometer values only for the measured range
+ *               (the high one if both were measured), the battery voltage only when measured and the error only when
+ *               set. The flags tell which optional fields follow. The payload is encoded per burst from the frame of
+ *               the radio into one of two buffers, so the buffer of the running burst is not written.
+ * @note         The batch format appends the pressure and temperature of the last advertised frames to the compact
+ *               frame, as many as fit the advertising data, so a receiver missing a burst gets its sample from the
+ *               next one. The SDK exposes the legacy GAP advertising calls only, without an extended advertising
+ *               set: the batch is bounded by the 31 bytes of a legacy PDU, 2 or 3 samples.
+ * @note         The advertising interval and duration are chosen per burst by a policy indexed by the operating
+ *               state (parked, driving, transition, alarm, maintenance). The radio-on time of every burst is estimated
+ *               and summed per state over an hour, the last complete hour is exported to the custom service.
+ * @note         In the broadcast mode, the sensor frames are sent non-connectable, which shortens every event by
+ *               the receive window. A connectable window is opened every period.
+ * @note         The scan response carries the device information: the firmware and hardware versions, the active
+ *               sampling profile and the battery voltage. A gateway builds its inventory from the scan responses,
+ *               without connecting. The information is cached in \glos{NVM}, so the battery voltage is known at boot
+ *               before its first measurement. The cache is marked dirty only when the versions change or the battery
+ *               voltage moves by more than a hysteresis. Only the connectable bursts are scannable.
  * @note         The desired MTU size is also stored in a global variable for configuration.
  * @copyright    (c) [Robert Bosch GmbH] [2024].
  *               All rights reserved, also regarding any disposal,
@@ -24,6 +44,8 @@
  **/
 
 /* System includes */
+#include <stddef.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* Library includes */
@@ -57,9 +79,123 @@
 /// The BLE advertising duration in ms is set to 60 ms. 0 is infinity
 #define BLE_ADVERTISING_DURATION 60u
 
+/// The BLE advertising interval while parked is set to 100 ms. Frames are rare, the events of
+/// the burst are spread to get past a collision with the frame of another wheel
+#define BLE_ADVERTISING_INTL_PARKED 0x00A0u
+
+/// The BLE advertising duration in ms while parked: 3 events
+#define BLE_ADVERTISING_DURATION_PARKED 250u
+
+/// The BLE advertising duration in ms in the transition profile. Frames are frequent,
+/// the burst must end before the next cycle (250 ms)
+#define BLE_ADVERTISING_DURATION_TRANSITION 40u
+
+/// The BLE advertising duration in ms of an alarm frame: long burst for a high
+/// reception probability, still ending well before the next cycle (250 ms)
+#define BLE_ADVERTISING_DURATION_ALARM 120u
+
+/// The BLE advertising interval in maintenance is set to 100 ms, fast enough for a phone to discover the sensor
+#define BLE_ADVERTISING_INTL_MAINT 0x00A0u
+
+/// The BLE advertising duration in ms in maintenance: 2 events, the burst ends before the
+/// shortest cycle (250 ms). The connectable window spans the bursts of \ref BLE_ADV_CONN_WINDOW_MS
+#define BLE_ADVERTISING_DURATION_MAINT 200u
+
+/// Minimum and maximum advertising intervals of the legacy advertising: 20 ms to 10.24 s
+#define BLE_ADVERTISING_INTL_MIN 0x0020u
+#define BLE_ADVERTISING_INTL_MAX 0x4000u
+
+/// Number of advertising channels
+#define BLE_ADV_NUM_CHANNELS 3u
+
+/// Radio ramp-up before every PDU [us]
+#define BLE_ADV_RAMPUP_US 140u
+
+/// Air time of a byte on the 1M PHY [us]
+#define BLE_ADV_BYTE_US 8u
+
+/// Overhead of an advertising PDU: preamble 1, access address 4, header 2, AdvA 6, CRC 3 [bytes]
+#define BLE_ADV_PDU_OVERHEAD 16u
+
+/// Receive window after a connectable PDU: T_IFS and a SCAN_REQ or CONNECT_IND [us]
+#define BLE_ADV_RX_WINDOW_US 450u
+
+/// Number of advertising payload buffers: built for the next burst, in use by the radio
+#define BLE_ADV_NUM_BUFS 2u
+
+/// Maximum advertising data of a legacy advertising PDU [bytes]
+#define BLE_ADV_LEGACY_DATA_MAX_LEN 31u
+
+/// Maximum advertising data [bytes]: the one of an extended advertising set if the SDK provides it,
+/// else the legacy PDU one
+#if defined(RBK_SMP290_BLE_ADV_EXT_DATA_MAX_LEN)
+#define BLE_ADV_DATA_MAX_LEN RBK_SMP290_BLE_ADV_EXT_DATA_MAX_LEN
+#else
+#define BLE_ADV_DATA_MAX_LEN BLE_ADV_LEGACY_DATA_MAX_LEN
+#endif
+
+/// Length of the radio-on accounting period [ms]
+#define BLE_ADV_RADIO_PERIOD_MS 3600000u
+
+/// Default advertising mode
+#define BLE_ADV_MODE_DFLT ADV_MODE_CONNECTABLE
+
+/// Default period of the connectable windows in the broadcast mode [s]
+#define BLE_ADV_CONN_WINDOW_PERIOD_DFLT 60u
+
+/// Length of a connectable window of the broadcast mode, long enough to connect [ms]
+#define BLE_ADV_CONN_WINDOW_MS 3000u
+
 /// The BLE MTU size
 #define BLE_MTU_SIZE 128
 
+/// Default pressure change that triggers an Adv. [LSB], ~2 kPa
+#define BLE_ADV_TRIG_P_DELTA_DFLT 5u
+
+/// Default temperature change that triggers an Adv. [LSB], 2 degC
+#define BLE_ADV_TRIG_T_DELTA_DFLT 2u
+
+/// Default maximum time between two Adv. [s]
+#define BLE_ADV_TRIG_HEARTBEAT_DFLT 30u
+
+/// Format byte of the compact frame
+#define BLE_ADV_FMT_COMPACT 0x01u
+
+/// Compact frame flag: the battery voltage follows. Bits 0 to 2 are the frame flags,
+/// \ref SEQ_FLAG_ACC_RANGE_LO or \ref SEQ_FLAG_ACC_RANGE_HI telling the range of the
+/// accelerometer values following
+#define BLE_ADV_CFLAG_VBAT ((uint8_t)0x40u)
+
+/// Compact frame flag: the error byte follows
+#define BLE_ADV_CFLAG_ERROR ((uint8_t)0x80u)
+
+/// Maximum pressure of the compact frame [LSB], 12 bits
+#define BLE_ADV_COMPACT_P_MAX 0x0FFF
+
+/// Shift of the battery voltage in the compact frame: 8 bits of 2 LSB (10 mV)
+#define BLE_ADV_COMPACT_VBAT_SHIFT 1
+
+/// Shift of the temperature in the packed pressure and temperature field
+#define BLE_ADV_COMPACT_T_SHIFT 12
+
+/// Maximum length of a compact frame: format, counter, flags, p and T 3, Az and Ax 4, Vbat 1, error 1 [bytes]
+#define BLE_ADV_COMPACT_MAX_LEN 13u
+
+/// Format byte of the batch frame: a compact frame followed by the samples of the last advertised frames
+#define BLE_ADV_FMT_BATCH 0x02u
+
+/// Length of a sample of the batch: frame counter, p and T 3 [bytes]
+#define BLE_ADV_BATCH_SAMPLE_LEN 4u
+
+/// Maximum number of samples of the batch
+#define BLE_ADV_BATCH_MAX 3u
+
+/// Format byte of the device information of the scan response
+#define BLE_ADV_FMT_DEVINFO 0x10u
+
+/// Battery voltage change which rewrites the cached device information [2 LSB], 50 mV
+#define BLE_ADV_DEVINFO_VBAT_HYST 5u
+
 /*******************************************************************************
  *  Types
  ******************************************************************************/
@@ -76,13 +212,12 @@ typedef struct
     uint8_t flags;   //!< Adv. structure flags
 } ble_advStrFlags_tst;
 
-/// BLE Service Data Adv. Structure
+/// BLE Manufacturer Specific Adv. Structure header, followed by the frame
 typedef struct
 {
-    uint8_t length;                 //!< Adv. structure length
-    uint8_t type;                   //!< Adv. structure type: Manufacturer Specific 0xFF)
-    uint16_t companyId;             //!< Company ID (0x02A6)
-    ble_sensorData_tst sensorData;  //!< Sensor data
+    uint8_t length;      //!< Adv. structure length
+    uint8_t type;        //!< Adv. structure type: Manufacturer Specific 0xFF)
+    uint16_t companyId;  //!< Company ID (0x02A6)
 } ble_advStrData_tst;
 
 /// Appearance Adv. Structure
@@ -93,34 +228,601 @@ typedef struct
     uint16_t appearance;  //!< Appearance (0x5905)
 } ble_advStrAppearance_tst;
 
+/// Advertising data payload. The Manufacturer Specific Adv. structure comes last, it has the
+/// variable length of the compact frame.
+typedef struct
+{
+    ble_advStrFlags_tst flags;                                       //!< Flags Adv. structure
+    ble_advStrAppearance_tst appearance;                             //!< Appearance Adv. structure
+    ble_advStrData_tst data;                                         //!< Manufacturer Specific Adv. structure header
+    uint8_t frame[BLE_ADV_DATA_MAX_LEN - sizeof(ble_advStrFlags_tst) - sizeof(ble_advStrAppearance_tst) -
+                  sizeof(ble_advStrData_tst)];                       //!< Compact or batch frame
+} ble_advPayload_tst;
+
+/// Sample of the batch
+typedef struct
+{
+    uint8_t counter;  //!< Frame counter of the sample
+    uint32_t pT;      //!< Packed pressure and temperature, as in the compact frame
+} ble_advSample_tst;
+
+/// Scan response payload: a Manufacturer Specific Adv. structure with the device information
+typedef struct
+{
+    ble_advStrData_tst data;  //!< Manufacturer Specific Adv. structure header
+    uint8_t format;           //!< Format byte, \ref BLE_ADV_FMT_DEVINFO
+    adv_devInfo_tst info;     //!< Device information
+} ble_scanRspPayload_tst;
+
 // Restore default pack
 #pragma pack()
 
-/// Length of the BLE advertisement message
-#define BLE_ADV_DATA_LEN (sizeof(ble_advStrFlags_tst) + sizeof(ble_advStrData_tst) + sizeof(ble_advStrAppearance_tst))
+_Static_assert(BLE_ADV_LEGACY_DATA_MAX_LEN >= sizeof(ble_scanRspPayload_tst), "The device information does not fit a scan response.");
+_Static_assert(BLE_ADV_DATA_MAX_LEN == sizeof(ble_advPayload_tst), "The advertising data does not fill the Adv. PDU.");
+_Static_assert((BLE_ADV_COMPACT_MAX_LEN + BLE_ADV_BATCH_SAMPLE_LEN) <= sizeof(((ble_advPayload_tst *)NULL)->frame),
+               "A batch sample does not fit the largest compact frame.");
 
 /******************************************************************************\
  *  Global variables
 \******************************************************************************/
 
-/// Advertising data payload
-SECTION_PERSISTENT static uint8_t ble_advData[BLE_ADV_DATA_LEN];
+/// Advertising data payload buffers
+SECTION_PERSISTENT static ble_advPayload_tst ble_advData[BLE_ADV_NUM_BUFS];
+
+/// Advertising payload buffer of the next burst
+SECTION_PERSISTENT static uint8_t ble_advBuf = 0u;
+
+/// Scan response payload buffers
+SECTION_PERSISTENT static ble_scanRspPayload_tst ble_scanRsp[BLE_ADV_NUM_BUFS];
+
+/// Scan response payload buffer of the next update
+SECTION_PERSISTENT static uint8_t ble_scanRspBuf = 0u;
+
+/// Device information of the scan response
+SECTION_PERSISTENT static adv_devInfo_tst ble_devInfo;
+
+/// Device information cached in \glos{NVM}
+SECTION_PERSISTENT static adv_devInfo_tst ble_devInfoNvm;
 
 /// Desired MTU size
 uint16_t ble_mtu_size = BLE_MTU_SIZE;
 
+/// Advertising policy: settings of every state, indexed by \ref adv_state_ten
+SECTION_PERSISTENT static adv_cadence_tst ble_advCadence[ADV_STATE_MAX] = {
+    [ADV_STATE_PARKED]     = {BLE_ADVERTISING_INTL_PARKED, BLE_ADVERTISING_DURATION_PARKED},
+    [ADV_STATE_DRIVING]    = {BLE_ADVERTISING_INTL, BLE_ADVERTISING_DURATION},
+    [ADV_STATE_TRANSITION] = {BLE_ADVERTISING_INTL, BLE_ADVERTISING_DURATION_TRANSITION},
+    [ADV_STATE_ALARM]      = {BLE_ADVERTISING_INTL, BLE_ADVERTISING_DURATION_ALARM},
+    [ADV_STATE_MAINT]      = {BLE_ADVERTISING_INTL_MAINT, BLE_ADVERTISING_DURATION_MAINT},
+};
+
+/// State of each sampling profile, indexed by \ref motion_profile_ten
+static const adv_state_ten ble_advProfileState[MOTION_PROFILE_MAX] = {
+    [MOTION_PROFILE_PARKED]     = ADV_STATE_PARKED,
+    [MOTION_PROFILE_DRIVING]    = ADV_STATE_DRIVING,
+    [MOTION_PROFILE_TRANSITION] = ADV_STATE_TRANSITION,
+};
+
+/// State of the configured advertising settings
+SECTION_PERSISTENT static adv_state_ten ble_advState = ADV_STATE_DRIVING;
+
+/// Are the settings of the configured state changed since they were configured
+SECTION_PERSISTENT static bool ble_advCadenceDirty = false;
+
+/// Maintenance flag
+SECTION_PERSISTENT static bool ble_advMaint = false;
+
+/// Advertising mode
+SECTION_PERSISTENT static adv_mode_ten ble_advMode = BLE_ADV_MODE_DFLT;
+
+/// Period of the connectable windows in the broadcast mode [s]
+SECTION_PERSISTENT static uint16_t ble_advConnPeriod_s = BLE_ADV_CONN_WINDOW_PERIOD_DFLT;
+
+/// Sequence time of the start of the last connectable window [ms]
+SECTION_PERSISTENT static uint32_t ble_advConnWindow_ms = 0u;
+
+/// Is a connectable window already opened, the first one is opened at boot
+SECTION_PERSISTENT static bool ble_advConnWindowValid = false;
+
+/// Is the configured advertising type connectable
+SECTION_PERSISTENT static bool ble_advConnectable = true;
+
+/// Radio-on time of every state in the running hour [us]
+SECTION_PERSISTENT static uint32_t ble_advRadioOn_us[ADV_STATE_MAX];
+
+/// Radio-on time of every state in the last complete hour [us]
+SECTION_PERSISTENT static uint32_t ble_advRadioOnLast_us[ADV_STATE_MAX];
+
+/// Sequence time of the start of the running hour [ms]
+SECTION_PERSISTENT static uint32_t ble_advRadioPeriod_ms = 0u;
+
+/// Does the frame of the radio carry the deflation alarm
+SECTION_PERSISTENT static bool ble_advAlarm = false;
+
+/// Samples of the last advertised frames, a ring
+SECTION_PERSISTENT static ble_advSample_tst ble_advBatch[BLE_ADV_BATCH_MAX];
+
+/// Position of the next sample in the ring
+SECTION_PERSISTENT static uint8_t ble_advBatchHead = 0u;
+
+/// Number of samples in the ring
+SECTION_PERSISTENT static uint8_t ble_advBatchCnt = 0u;
+
+/// Advertising trigger configuration
+SECTION_PERSISTENT static adv_trigCfg_tst ble_advTrigCfg = {BLE_ADV_TRIG_P_DELTA_DFLT, BLE_ADV_TRIG_T_DELTA_DFLT,
+                                                            BLE_ADV_TRIG_HEARTBEAT_DFLT};
+
+/// Sequence time of the last advertised frame [ms]
+SECTION_PERSISTENT static uint32_t ble_advLast_ms = 0u;
+
+/// Is a frame already advertised
+SECTION_PERSISTENT static bool ble_advLastValid = false;
+
 /// @}
 
 /******************************************************************************\
  *  Functions declarations
 \******************************************************************************/
 
+/**
+ * @brief      Tells if a connectable window is open or has to be opened.
+ * @details    Only used in the broadcast mode. A burst within an open window keeps
+ *             it connectable.
+ * @param[in]  now_ms  The sequence time.
+ * @return     true if the burst is a connectable window
+ */
+static bool isConnWindow(uint32_t now_ms)
+{
+    uint32_t elapsed_ms = now_ms - ble_advConnWindow_ms;
+
+    return !ble_advConnWindowValid || (elapsed_ms < BLE_ADV_CONN_WINDOW_MS) ||
+           (elapsed_ms >= ((uint32_t)ble_advConnPeriod_s * 1000u));
+}
+
+/**
+ * @brief      Selects the state of the advertising policy.
+ * @param[in]  window  Is a connectable window due.
+ * @return     The maintenance state if the flag is set, else the alarm state for
+ *             an alarm frame, else the maintenance state for a connectable window,
+ *             else the state of the active sampling profile
+ */
+static adv_state_ten selectState(bool window)
+{
+    adv_state_ten state;
+
+    if (ble_advMaint)
+    {
+        state = ADV_STATE_MAINT;
+    }
+    else if (ble_advAlarm)
+    {
+        state = ADV_STATE_ALARM;
+    }
+    else if (window)
+    {
+        state = ADV_STATE_MAINT;
+    }
+    else
+    {
+        state = ble_advProfileState[motion_getProfile()];
+    }
+    return state;
+}
+
+/**
+ * @brief      Returns the cycle of a state, the time to its next burst.
+ * @details    The alarm holds the transition profile. The maintenance state is entered
+ *             in every profile, its cycle is the shortest one.
+ * @param[in]  state  The state.
+ * @return     The cycle [ms].
+ */
+static uint32_t stateCycle(adv_state_ten state)
+{
+    uint32_t cycle_ms = motion_getCycle(MOTION_PROFILE_TRANSITION);
+    uint8_t profile;
+
+    for (profile = 0u; profile < (uint8_t)MOTION_PROFILE_MAX; profile++)
+    {
+        if (ADV_STATE_MAINT == state)
+        {
+            cycle_ms = (motion_getCycle((motion_profile_ten)profile) < cycle_ms) ? motion_getCycle((motion_profile_ten)profile) : cycle_ms;
+        }
+        else if (ble_advProfileState[profile] == state)
+        {
+            cycle_ms = motion_getCycle((motion_profile_ten)profile);
+        }
+        else
+        {
+            // Nothing to do
+        }
+    }
+    return cycle_ms;
+}
+
+/**
+ * @brief      Accounts the radio-on time of a burst.
+ * @details    The burst has an event at its start and one per interval within the duration,
+ *             each event sending the PDU on every channel. An infinite burst is
+ *             accounted as one event, it is ended by a connection or the next burst.
+ * @param[in]  state        The state of the burst.
+ * @param[in]  connectable  Is the burst connectable, every PDU is then followed by a receive window.
+ * @param[in]  len          The length of the advertising data.
+ * return     None
+ */
+static void accountRadioOn(adv_state_ten state, bool connectable, uint16_t len)
+{
+    adv_cadence_tst const *cadence_p = &ble_advCadence[state];
+    uint32_t now_ms                  = sequence_getTime();
+    uint32_t elapsed_ms              = now_ms - ble_advRadioPeriod_ms;
+    uint32_t events                  = ((uint32_t)cadence_p->duration * 1000u) / ((uint32_t)cadence_p->interval * 625u);
+    uint32_t event_us;
+
+    // Latch the hour, an hour without any burst has no radio-on time
+    if (elapsed_ms >= BLE_ADV_RADIO_PERIOD_MS)
+    {
+        if (elapsed_ms >= (2u * BLE_ADV_RADIO_PERIOD_MS))
+        {
+            (void)memset(ble_advRadioOnLast_us, 0x00, sizeof(ble_advRadioOnLast_us));
+        }
+        else
+        {
+            (void)memcpy(ble_advRadioOnLast_us, ble_advRadioOn_us, sizeof(ble_advRadioOnLast_us));
+        }
+        (void)memset(ble_advRadioOn_us, 0x00, sizeof(ble_advRadioOn_us));
+        ble_advRadioPeriod_ms = now_ms - (elapsed_ms % BLE_ADV_RADIO_PERIOD_MS);
+    }
+
+    event_us = BLE_ADV_NUM_CHANNELS * (BLE_ADV_RAMPUP_US + ((BLE_ADV_PDU_OVERHEAD + (uint32_t)len) * BLE_ADV_BYTE_US) +
+                                       (connectable ? BLE_ADV_RX_WINDOW_US : 0u));
+    ble_advRadioOn_us[state] += (0u != cadence_p->duration) ? ((events + 1u) * event_us) : event_us;
+}
+
+/**
+ * @brief      Configures the advertising settings and type of the state of the next burst.
+ * @details    The settings and the type are only passed to the stack when they change.
+ *             In the broadcast mode, only the bursts of the maintenance state are connectable.
+ * @param[in]  len  The length of the advertising data.
+ * return     None
+ */
+static void applyPolicy(uint16_t len)
+{
+    uint32_t now_ms     = sequence_getTime();
+    bool window         = (ADV_MODE_BROADCAST == ble_advMode) && isConnWindow(now_ms);
+    adv_state_ten state = selectState(window);
+    bool connectable    = (ADV_MODE_BROADCAST != ble_advMode) || (ADV_STATE_MAINT == state);
+
+    if (window && (ADV_STATE_MAINT == state) && !ble_advMaint)
+    {
+        // Open the window, or keep the start of the open one
+        if (!ble_advConnWindowValid || ((now_ms - ble_advConnWindow_ms) >= BLE_ADV_CONN_WINDOW_MS))
+        {
+            ble_advConnWindow_ms = now_ms;
+        }
+        ble_advConnWindowValid = true;
+    }
+
+    if ((state != ble_advState) || ble_advCadenceDirty)
+    {
+        ble_advState        = state;
+        ble_advCadenceDirty = false;
+        (void)rbk_smp290_ble_gap_adv_setIntrv(ble_advCadence[state].interval, ble_advCadence[state].duration);
+    }
+
+    if (connectable != ble_advConnectable)
+    {
+        ble_advConnectable = connectable;
+        (void)rbk_smp290_ble_gap_adv_setTyp(connectable ? RBK_SMP290_BLE_ADV_CONN_UNDIRECT : RBK_SMP290_BLE_ADV_NONCONN_UNDIRECT);
+    }
+    accountRadioOn(state, connectable, len);
+}
+
+/**
+ * @brief      Writes a little endian 16 bits value.
+ * @param[in]  val    The value.
+ * @param[out] dst_p  The destination.
+ * @return     The number of bytes written
+ */
+static uint8_t putU16(uint16_t val, uint8_t *dst_p)
+{
+    dst_p[0] = (uint8_t)(val & 0xFFu);
+    dst_p[1] = (uint8_t)(val >> 8);
+    return 2u;
+}
+
+/**
+ * @brief      Packs the pressure and the temperature of a frame in 24 bits.
+ * @details    The pressure takes 12 bits and the temperature 8 bits, out of range values are clipped.
+ * @param[in]  frame_p  The frame.
+ * @return     The packed pressure and temperature
+ */
+static uint32_t packPT(ble_sensorData_tst const *frame_p)
+{
+    int32_t p = frame_p->p_out;
+    int32_t T = frame_p->T_out;
+
+    p = (p < 0) ? 0 : ((p > BLE_ADV_COMPACT_P_MAX) ? BLE_ADV_COMPACT_P_MAX : p);
+    T = (T < INT8_MIN) ? INT8_MIN : ((T > INT8_MAX) ? INT8_MAX : T);
+    return (uint32_t)p | ((uint32_t)(uint8_t)(int8_t)T << BLE_ADV_COMPACT_T_SHIFT);
+}
+
+/**
+ * @brief      Encodes a frame in the compact format.
+ * @param[in]  frame_p  The frame.
+ * @param[out] dst_p    The destination, at least \ref BLE_ADV_COMPACT_MAX_LEN bytes.
+ * @return     The number of bytes written
+ */
+static uint8_t encodeCompact(ble_sensorData_tst const *frame_p, uint8_t *dst_p)
+{
+    uint8_t flags = frame_p->flags & SEQ_FLAG_ALARM;
+    int32_t vbat  = (int32_t)frame_p->Vbat_out >> BLE_ADV_COMPACT_VBAT_SHIFT;
+    uint32_t pT   = packPT(frame_p);
+    uint8_t n     = 0u;
+
+    // Quantize to the field size, an out of range value is clipped
+    vbat = (vbat < 0) ? 0 : ((vbat > (int32_t)UINT8_MAX) ? (int32_t)UINT8_MAX : vbat);
+
+    // Only the measured range of the accelerometer, the high one if both were measured
+    if (0u != (frame_p->flags & SEQ_FLAG_ACC_RANGE_HI))
+    {
+        flags |= SEQ_FLAG_ACC_RANGE_HI;
+    }
+    else
+    {
+        flags |= (frame_p->flags & SEQ_FLAG_ACC_RANGE_LO);
+    }
+    flags |= (0u != (frame_p->fresh & SEQ_CH_BIT(SEQ_CH_VBAT))) ? BLE_ADV_CFLAG_VBAT : 0u;
+    flags |= (0u != frame_p->error) ? BLE_ADV_CFLAG_ERROR : 0u;
+
+    dst_p[n++] = BLE_ADV_FMT_COMPACT;
+    dst_p[n++] = frame_p->frame_counter;
+    dst_p[n++] = flags;
+    dst_p[n++] = (uint8_t)(pT & 0xFFu);
+    dst_p[n++] = (uint8_t)((pT >> 8) & 0xFFu);
+    dst_p[n++] = (uint8_t)(pT >> 16);
+
+    if (0u != (flags & SEQ_FLAG_ACC_RANGE_HI))
+    {
+        n += putU16((uint16_t)frame_p->Az_hi_out, &dst_p[n]);
+        n += putU16((uint16_t)frame_p->Ax_hi_out, &dst_p[n]);
+    }
+    else if (0u != (flags & SEQ_FLAG_ACC_RANGE_LO))
+    {
+        n += putU16((uint16_t)frame_p->Az_lo_out, &dst_p[n]);
+        n += putU16((uint16_t)frame_p->Ax_lo_out, &dst_p[n]);
+    }
+    else
+    {
+        // Nothing to do
+    }
+
+    if (0u != (flags & BLE_ADV_CFLAG_VBAT))
+    {
+        dst_p[n++] = (uint8_t)vbat;
+    }
+    if (0u != (flags & BLE_ADV_CFLAG_ERROR))
+    {
+        dst_p[n++] = frame_p->error;
+    }
+    return n;
+}
+
+/**
+ * @brief      Appends the samples of the last advertised frames to a compact frame.
+ * @details    The samples follow the compact frame newest first, as many as fit the advertising
+ *             data. The format byte tells a batch frame once a sample is appended. The sample of
+ *             the frame is then added to the ring for the next bursts.
+ * @param[in]     frame_p  The frame.
+ * @param[in,out] dst_p    The compact frame of the frame.
+ * @param[in]     len      The length of the compact frame.
+ * @param[in]     maxLen   The maximum length of the batch frame.
+ * @return     The length of the batch frame
+ */
+static uint8_t encodeBatch(ble_sensorData_tst const *frame_p, uint8_t *dst_p, uint8_t len, uint8_t maxLen)
+{
+    uint32_t pT = packPT(frame_p);
+    uint8_t i;
+
+    for (i = 0u; (i < ble_advBatchCnt) && ((len + BLE_ADV_BATCH_SAMPLE_LEN) <= maxLen); i++)
+    {
+        ble_advSample_tst const *sample_p =
+            &ble_advBatch[(ble_advBatchHead + BLE_ADV_BATCH_MAX - 1u - i) % BLE_ADV_BATCH_MAX];
+
+        // A frame advertised again is not a sample of the batch
+        if (sample_p->counter != frame_p->frame_counter)
+        {
+            dst_p[0]     = BLE_ADV_FMT_BATCH;
+            dst_p[len++] = sample_p->counter;
+            dst_p[len++] = (uint8_t)(sample_p->pT & 0xFFu);
+            dst_p[len++] = (uint8_t)((sample_p->pT >> 8) & 0xFFu);
+            dst_p[len++] = (uint8_t)(sample_p->pT >> 16);
+        }
+    }
+
+    // Keep the sample of the frame for the next bursts, once
+    if ((0u == ble_advBatchCnt) ||
+        (ble_advBatch[(ble_advBatchHead + BLE_ADV_BATCH_MAX - 1u) % BLE_ADV_BATCH_MAX].counter != frame_p->frame_counter))
+    {
+        ble_advBatch[ble_advBatchHead].counter = frame_p->frame_counter;
+        ble_advBatch[ble_advBatchHead].pT      = pT;
+        ble_advBatchHead                       = (uint8_t)((ble_advBatchHead + 1u) % BLE_ADV_BATCH_MAX);
+        ble_advBatchCnt                        = (ble_advBatchCnt < BLE_ADV_BATCH_MAX) ? (ble_advBatchCnt + 1u) : BLE_ADV_BATCH_MAX;
+    }
+    return len;
+}
+
+/**
+ * @brief      Builds the advertising data of the next burst and passes it to the stack.
+ * @details    The buffers alternate, so the one of the running burst is not written.
+ * @param[in]  frame_p  The frame of the radio.
+ * @return     The length of the advertising data, 0 if the stack rejects it
+ */
+static uint16_t setAdvData(ble_sensorData_tst const *frame_p)
+{
+    ble_advPayload_tst *payload_p = &ble_advData[ble_advBuf];
+    uint16_t len                  = encodeCompact(frame_p, payload_p->frame);
+
+    len = encodeBatch(frame_p, payload_p->frame, (uint8_t)len, (uint8_t)sizeof(payload_p->frame));
+
+    payload_p->data.length = (uint8_t)((sizeof(ble_advStrData_tst) - 1u) + len);
+    len += (uint16_t)offsetof(ble_advPayload_tst, frame);
+
+    if (RBK_SMP290_BLE_SUCCESS == rbk_smp290_ble_gap_adv_setData((uint8_t *)payload_p, (const uint8_t)len))
+    {
+        ble_advBuf = (uint8_t)((ble_advBuf + 1u) % BLE_ADV_NUM_BUFS);
+    }
+    else
+    {
+        len = 0u;
+    }
+    return len;
+}
+
+/**
+ * @brief      Passes the device information to the stack as scan response.
+ * @details    The buffers alternate, so the one of the running burst is not written.
+ * return     None
+ */
+static void setScanRsp(void)
+{
+    ble_scanRspPayload_tst *payload_p = &ble_scanRsp[ble_scanRspBuf];
+
+    payload_p->info = ble_devInfo;
+
+    if (RBK_SMP290_BLE_SUCCESS == rbk_smp290_ble_gap_adv_setScanRspData((uint8_t *)payload_p, (const uint8_t)sizeof(ble_scanRspPayload_tst)))
+    {
+        ble_scanRspBuf = (uint8_t)((ble_scanRspBuf + 1u) % BLE_ADV_NUM_BUFS);
+    }
+    else
+    {
+        smp290_log(LOG_VERBOSITY_WARNING, "Scan response rejected\r\n");
+    }
+}
+
+/**
+ * @brief      Marks the device information dirty if the cached one is outdated.
+ * @details    The profile changes too often to be cached on its own, it is only written along.
+ * return     None
+ */
+static void cacheDevInfo(void)
+{
+    int32_t dVbat = (int32_t)ble_devInfo.vbat - (int32_t)ble_devInfoNvm.vbat;
+
+    if ((ble_devInfo.fwMajor != ble_devInfoNvm.fwMajor) || (ble_devInfo.fwMinor != ble_devInfoNvm.fwMinor) ||
+        (ble_devInfo.fwPatch != ble_devInfoNvm.fwPatch) || (ble_devInfo.hwVersion != ble_devInfoNvm.hwVersion) ||
+        (abs(dVbat) >= (int32_t)BLE_ADV_DEVINFO_VBAT_HYST))
+    {
+        // Written with the information of the flush
+        ble_devInfoNvm = ble_devInfo;
+        nvm_setDirty(NVM_ITEM_DEVINFO);
+    }
+    else
+    {
+        // Nothing to do
+    }
+}
+
+/**
+ * @brief      Follows the profile and the battery voltage with the device information.
+ * @details    The scan response is only updated on a change.
+ * @param[in]  frame_p  The frame of the radio.
+ * return     None
+ */
+static void updateDevInfo(ble_sensorData_tst const *frame_p)
+{
+    adv_devInfo_tst info = ble_devInfo;
+    int32_t vbat;
+
+    info.profile = (uint8_t)motion_getProfile();
+    if (0u != (frame_p->fresh & SEQ_CH_BIT(SEQ_CH_VBAT)))
+    {
+        // Same quantization as the compact frame
+        vbat      = (int32_t)frame_p->Vbat_out >> BLE_ADV_COMPACT_VBAT_SHIFT;
+        info.vbat = (uint8_t)((vbat < 0) ? 0 : ((vbat > (int32_t)UINT8_MAX) ? (int32_t)UINT8_MAX : vbat));
+    }
+
+    if (0 != memcmp(&info, &ble_devInfo, sizeof(adv_devInfo_tst)))
+    {
+        ble_devInfo = info;
+        setScanRsp();
+        cacheDevInfo();
+    }
+    else
+    {
+        // Nothing to do
+    }
+}
+
+/**
+ * @brief      Loads the advertising configuration from \glos{NVM}.
+ * @details    The items which are not found keep their defaults.
+ * return     None
+ */
+static void loadConfig(void)
+{
+    uint8_t mode[BLE_CUST_SVC_ADV_MODE_LEN];
+    adv_cadence_tst cadence[ADV_STATE_MAX];
+    uint8_t state;
+
+    // TX power level
+    ble_txPwrLvl = RBK_SMP290_BLE_TX_PWR_6_DBM;
+    if (nvm_get(NVM_ITEM_TXPWR, &ble_txPwrLvl, sizeof(ble_txPwrLvl)))
+    {
+        smp290_log(LOG_VERBOSITY_INFO, "Read TxPwr from NVM: %d\r\n", ble_txPwrLvl);
+    }
+    else
+    {
+        smp290_log(LOG_VERBOSITY_INFO, "No TxPwr in NVM. Using default:%d\r\n", ble_txPwrLvl);
+    }
+
+    // Advertising triggers
+    if (!nvm_get(NVM_ITEM_ADVTRIG, &ble_advTrigCfg, sizeof(ble_advTrigCfg)))
+    {
+        smp290_log(LOG_VERBOSITY_INFO, "No Adv. trigger in NVM. Using default\r\n");
+    }
+
+    // Advertising policy, the maintenance flag is not stored. The settings out of range keep the default
+    if (nvm_get(NVM_ITEM_ADVPOL, cadence, sizeof(cadence)))
+    {
+        for (state = 0u; state < (uint8_t)ADV_STATE_MAX; state++)
+        {
+            if (!adv_setCadence((adv_state_ten)state, &cadence[state]))
+            {
+                smp290_log(LOG_VERBOSITY_WARNING, "Invalid Adv. policy %d in NVM. Using default\r\n", state);
+            }
+        }
+    }
+    else
+    {
+        smp290_log(LOG_VERBOSITY_INFO, "No Adv. policy in NVM. Using default\r\n");
+    }
+
+    // Advertising mode
+    if (nvm_get(NVM_ITEM_ADVMODE, mode, sizeof(mode)))
+    {
+        if (!adv_setMode((adv_mode_ten)mode[0], (uint16_t)((uint16_t)mode[1] | ((uint16_t)mode[2] << 8))))
+        {
+            smp290_log(LOG_VERBOSITY_WARNING, "Invalid Adv. mode in NVM. Using default\r\n");
+        }
+    }
+    else
+    {
+        smp290_log(LOG_VERBOSITY_INFO, "No Adv. mode in NVM. Using default\r\n");
+    }
+
+    // Device information of the scan response
+    (void)memset((void *)&ble_devInfoNvm, 0x00, sizeof(ble_devInfoNvm));
+    if (!nvm_get(NVM_ITEM_DEVINFO, &ble_devInfoNvm, sizeof(ble_devInfoNvm)))
+    {
+        smp290_log(LOG_VERBOSITY_INFO, "No device information in NVM\r\n");
+    }
+}
+
 // Initialize the advertising parameters and configurations.
 void adv_init()
 {
-    rbk_smp290_ble_rfOutPwr PwrLvl;
-    // Read the TX power from NVM
-    ble_txPwrLvl = readTxPwrFromNvm();
+    uint8_t i;
+    // Read the configuration from NVM
+    loadConfig();
     // Set the desired MTU
     (void)rbk_smp290_ble_atts_set_mtu(ble_mtu_size);
     // Initialize the Device address
@@ -128,19 +830,21 @@ void adv_init()
     //rbk_smp290_ble_addr addr = {0x30, 0x39, 0x32, 0x50, 0x4D, 0x53};
     //rbk_smp290_ble_gap_addr_setPublic(addr);
 
-    // Configure the TX Power
-    PwrLvl = rbk_smp290_ble_radio_setTxPwr(ble_txPwrLvl);
-    smp290_log(LOG_VERBOSITY_INFO, "TX Power Level: %d\r\n", PwrLvl);
+    // Configure the TX Power: the stored level is the maximum of the control
+    txpwr_init(ble_txPwrLvl);
 
     // Configure the BLE Advertisement parameters
-    // Set the Adv. Interval
-    (void)rbk_smp290_ble_gap_adv_setIntrv(BLE_ADVERTISING_INTL, BLE_ADVERTISING_DURATION);
+    // Set the Adv. Interval of the active state
+    ble_advState        = selectState(false);
+    ble_advCadenceDirty = false;
+    (void)rbk_smp290_ble_gap_adv_setIntrv(ble_advCadence[ble_advState].interval, ble_advCadence[ble_advState].duration);
 
     // Set the Adv. Channel
     (void)rbk_smp290_ble_gap_adv_setChannel(RBK_SMP290_BLE_ADV_CH_ALL);
 
-    // Set the Adv. Type
+    // Set the Adv. Type, the broadcast mode switches it per burst
     (void)rbk_smp290_ble_gap_adv_setTyp(RBK_SMP290_BLE_ADV_CONN_UNDIRECT);
+    ble_advConnectable = true;
 
     // Enable the Temperature Compensation TX Power
     rbk_smp290_ble_radio_enable_cmpd_T();
@@ -150,59 +854,194 @@ void adv_init()
 
     // Set the Adv Filter policy
     (void)rbk_smp290_ble_gap_adv_setFiltPolicy(RBK_SMP290_BLE_ADV_FILT_NONE);
+
+    // Clear the sensor frames, the measurements are written in place
+    snapshot_init();
+
+    // Write the constant parts of the payloads once, the frame is encoded per burst
+    for (i = 0u; i < BLE_ADV_NUM_BUFS; i++)
+    {
+        ble_advPayload_tst *payload_p = &ble_advData[i];
+
+        // GAP advertising flags for discoverable
+        payload_p->flags.length = sizeof(ble_advStrFlags_tst) - 1u;
+        payload_p->flags.type   = (uint8_t)RBK_SMP290_BLE_ADV_TYP_FLAGS;
+        payload_p->flags.flags  = ((uint8_t)RBK_SMP290_BLE_FLAG_LE_GENERAL_DISC | (uint8_t)RBK_SMP290_BLE_FLAG_LE_BREDR_NOT_SUP);
+
+        // Appearance
+        payload_p->appearance.length     = sizeof(ble_advStrAppearance_tst) - 1u;
+        payload_p->appearance.type       = (uint8_t)RBK_SMP290_BLE_ADV_TYP_APPEARANCE;
+        payload_p->appearance.appearance = BLE_ADV_APPEARANCE_TPMS;
+
+        // Manufacturer Specific sensor data struct
+        payload_p->data.length    = sizeof(ble_advStrData_tst) - 1u;
+        payload_p->data.type      = (uint8_t)RBK_SMP290_BLE_ADV_TYP_MANUFACTURER;
+        payload_p->data.companyId = BLE_ADV_COMPANY_ID_BOSCH;
+        (void)memset((void *)payload_p->frame, 0x00, sizeof(payload_p->frame));
+    }
+
+    // Scan response: the cached device information, with the versions of this firmware
+    ble_devInfo           = ble_devInfoNvm;
+    ble_devInfo.fwMajor   = DEVINFO_FW_VERSION_MAJOR;
+    ble_devInfo.fwMinor   = DEVINFO_FW_VERSION_MINOR;
+    ble_devInfo.fwPatch   = DEVINFO_FW_VERSION_PATCH;
+    ble_devInfo.hwVersion = DEVINFO_HW_VERSION;
+    ble_devInfo.profile   = (uint8_t)motion_getProfile();
+    for (i = 0u; i < BLE_ADV_NUM_BUFS; i++)
+    {
+        ble_scanRsp[i].data.length    = sizeof(ble_scanRspPayload_tst) - 1u;
+        ble_scanRsp[i].data.type      = (uint8_t)RBK_SMP290_BLE_ADV_TYP_MANUFACTURER;
+        ble_scanRsp[i].data.companyId = BLE_ADV_COMPANY_ID_BOSCH;
+        ble_scanRsp[i].format         = BLE_ADV_FMT_DEVINFO;
+    }
+    setScanRsp();
+    cacheDevInfo();
 }
 
-// Prepare the advertising data payload.
-void adv_prepSrvData(ble_sensorData_tst const *adv_sensorData_p)
+// Start the advertising process.
+void adv_doAdv()
 {
-    uint8_t index = 0u;
+    // Take the last published frame, it is not written until the next one is taken
+    ble_sensorData_tst const *frame_p = snapshot_take();
+    uint16_t len;
+
+    ble_advAlarm = (0u != (frame_p->flags & SEQ_FLAG_ALARM));
+    updateDevInfo(frame_p);
 
-    // GAP advertising flags for discoverable
-    static const ble_advStrFlags_tst advStr_flags = {
-        .length = sizeof(ble_advStrFlags_tst) - 1u,
-        .type   = (uint8_t)RBK_SMP290_BLE_ADV_TYP_FLAGS,
-        .flags  = ((uint8_t)RBK_SMP290_BLE_FLAG_LE_GENERAL_DISC | (uint8_t)RBK_SMP290_BLE_FLAG_LE_BREDR_NOT_SUP)};
+    // Set the advertising data
+    len = setAdvData(frame_p);
 
-    // Manufacturer Specific sensor data struct
-    static ble_advStrData_tst advStr_data = {
-        .length = sizeof(ble_advStrData_tst) - 1u, 
-        .type = (uint8_t)RBK_SMP290_BLE_ADV_TYP_MANUFACTURER, 
-        .companyId = BLE_ADV_COMPANY_ID_BOSCH};
+    // Follow the operating state with the advertising settings
+    applyPolicy(len);
 
-    // Appearance
-    static const ble_advStrAppearance_tst advStr_appearance = {
-        .length = sizeof(ble_advStrAppearance_tst) - 1u, 
-        .type = (uint8_t)RBK_SMP290_BLE_ADV_TYP_APPEARANCE, 
-        .appearance = BLE_ADV_APPEARANCE_TPMS};
+    // Start advertising
+    rbk_smp290_ble_gap_adv_start();
+}
 
-    // Copy the advStr_flags to the advertising data buffer
-    memcpy(&ble_advData[index], &advStr_flags, sizeof(ble_advStrFlags_tst));
-    index += sizeof(ble_advStrFlags_tst);
+// Tell if a frame has to be advertised.
+bool adv_isDue(ble_sensorData_tst const *frame_p, uint32_t now_ms)
+{
+    // Alarm frames are always advertised
+    bool due = !ble_advLastValid || (0u != (frame_p->flags & SEQ_FLAG_ALARM));
+    // The last published frame is either ready or taken by the advertiser, it is not overwritten
+    ble_sensorData_tst const *last_p = snapshot_getLast();
 
-    if (NULL == adv_sensorData_p)
+    if (!due)
     {
-        memset((void *)&(advStr_data.sensorData), 0x00, sizeof(ble_sensorData_tst));
+        // Change of pressure or temperature
+        due = ((uint32_t)abs((int32_t)frame_p->p_out - (int32_t)last_p->p_out) > ble_advTrigCfg.p_delta) ||
+              ((uint32_t)abs((int32_t)frame_p->T_out - (int32_t)last_p->T_out) > ble_advTrigCfg.T_delta);
+
+        // Heartbeat
+        due = due || ((now_ms - ble_advLast_ms) >= ((uint32_t)ble_advTrigCfg.heartbeat_s * 1000u));
+    }
+
+    if (due)
+    {
+        ble_advLast_ms   = now_ms;
+        ble_advLastValid = true;
     }
     else
     {
-        memcpy((void *)&(advStr_data.sensorData), (void *)adv_sensorData_p, sizeof(ble_sensorData_tst));
+        // Nothing to do
     }
-    // Copy the advStr_data to the advertising data buffer
-    memcpy(&ble_advData[index], &advStr_data, sizeof(ble_advStrData_tst));
-    index += sizeof(ble_advStrData_tst);
+    return due;
+}
 
-    // Copy the advStr_appearance to the advertising data buffer
-    memcpy(&ble_advData[index], &advStr_appearance, sizeof(ble_advStrAppearance_tst));
+// Set the advertising trigger configuration.
+void adv_setTrigCfg(adv_trigCfg_tst const *cfg_p)
+{
+    ble_advTrigCfg = *cfg_p;
+    // Advertise the next frame with the new configuration
+    ble_advLastValid = false;
 }
 
-// Start the advertising process.
-void adv_doAdv()
+// Return the advertising trigger configuration.
+adv_trigCfg_tst const *adv_getTrigCfg(void)
 {
-    // Set the advertising data
-    (void)rbk_smp290_ble_gap_adv_setData((uint8_t *)ble_advData, (const uint8_t)sizeof(ble_advData));
+    return &ble_advTrigCfg;
+}
 
-    // Start advertising
-    rbk_smp290_ble_gap_adv_start();
+// Return the device information of the scan response.
+adv_devInfo_tst const *adv_getDevInfo(void)
+{
+    return &ble_devInfo;
+}
+
+// Set the advertising settings of a state.
+bool adv_setCadence(adv_state_ten state, adv_cadence_tst const *cadence_p)
+{
+    // A burst of 0 ms advertises forever, a burst as long as the cycle overlaps the next one
+    bool ret = (state < ADV_STATE_MAX) && (cadence_p->interval >= BLE_ADVERTISING_INTL_MIN) &&
+               (cadence_p->interval <= BLE_ADVERTISING_INTL_MAX) && (0u != cadence_p->duration) &&
+               ((uint32_t)cadence_p->duration < stateCycle(state));
+
+    if (ret)
+    {
+        ble_advCadence[state] = *cadence_p;
+        ble_advCadenceDirty   = ble_advCadenceDirty || (state == ble_advState);
+    }
+    else
+    {
+        // Nothing to do
+    }
+    return ret;
+}
+
+// Return the advertising settings of a state.
+adv_cadence_tst const *adv_getCadence(adv_state_ten state)
+{
+    return &ble_advCadence[(state < ADV_STATE_MAX) ? state : ADV_STATE_DRIVING];
+}
+
+// Set or clear the maintenance flag.
+void adv_setMaintenance(bool on)
+{
+    ble_advMaint = on;
+    smp290_log(LOG_VERBOSITY_INFO, "\tMaintenance: %d\r\n", on);
+}
+
+// Tell if the maintenance flag is set.
+bool adv_isMaintenance(void)
+{
+    return ble_advMaint;
+}
+
+// Set the advertising mode.
+bool adv_setMode(adv_mode_ten mode, uint16_t period_s)
+{
+    // A broadcast mode without connectable windows could not be left over the air
+    bool ret = (mode < ADV_MODE_MAX) && ((ADV_MODE_BROADCAST != mode) || (0u != period_s));
+
+    if (ret)
+    {
+        ble_advMode         = mode;
+        ble_advConnPeriod_s = period_s;
+        smp290_log(LOG_VERBOSITY_INFO, "\tAdv. mode: %d, window period %d s\r\n", mode, period_s);
+    }
+    else
+    {
+        // Nothing to do
+    }
+    return ret;
+}
+
+// Return the advertising mode.
+adv_mode_ten adv_getMode(void)
+{
+    return ble_advMode;
+}
+
+// Return the period of the connectable windows in the broadcast mode.
+uint16_t adv_getConnWindowPeriod(void)
+{
+    return ble_advConnPeriod_s;
+}
+
+// Return the radio-on time of a state in the last complete hour.
+uint32_t adv_getRadioOnTime(adv_state_ten state)
+{
+    return (state < ADV_STATE_MAX) ? ble_advRadioOnLast_us[state] : 0u;
 }
 
 /** @} */
@@ -0,0 +1,223 @@
+/**
+ * @addtogroup   measure_advertise_conn
+ * @{
+ * @file         alarm.c
+ * @brief        This file contains the rapid deflation alarm of the project \ref measure_advertise_conn.
+ * @details      The alarm module estimates the pressure slope from every pressure sample of the
+ *               sequence. A sample falling faster than the threshold raises the sampling rate
+ *               to confirm the deflation quickly; the alarm is raised when the filtered slope
+ *               crosses the threshold. The sequence then advertises the alarm immediately,
+ *               without waiting for the Adv. step of the cycle.
+ *               The latency from the last stable sample to the alarm is measured on every alarm.
+ *               With the default constants, a deflation of at least twice the threshold is
+ *               confirmed within 3 samples at the high rate, so the latency is bounded by one
+ *               cycle of the active profile plus 3 cycles of the transition profile.
+ * @copyright    (c) [Robert Bosch GmbH] [2024].
+ *               All rights reserved, also regarding any disposal,
+ *               exploitation, reproduction, editing, distribution, as well
+ *               as in the event of applications for industrial property
+ *               rights. The communication of its contents to others without
+ *               express authorization is prohibited. Offenders will be held
+ *               liable for the payment of damages. All rights reserved in
+ *               the event of the grant of a patent, utility model or design.
+ **/
+
+/* Library includes */
+#include "rbk_smp290_types.h"
+
+/* Project includes */
+#include "main.h"
+
+/// @addtogroup measure_advertise_conn_alarm_cfg Deflation alarm configuration definitions
+/// @{
+
+/******************************************************************************\
+ *  Constants
+ \******************************************************************************/
+
+/// Fixed point scale of the slope
+#define ALARM_SLOPE_SCALE 16
+
+/// Slope below which the tire is deflating [1/16 LSB/s], -2 LSB/s (~ -0.8 kPa/s)
+#define ALARM_SLOPE_THLD (-2 * ALARM_SLOPE_SCALE)
+
+/// Slope above which the deflation is over [1/16 LSB/s], -0.5 LSB/s (~ -0.2 kPa/s)
+#define ALARM_SLOPE_CLEAR_THLD (-ALARM_SLOPE_SCALE / 2)
+
+/// Weight of a new slope sample in the filter, as a shift: 1/4
+#define ALARM_SLOPE_FILT_SHIFT 2
+
+/// Consecutive samples above the clear threshold to clear the alarm
+#define ALARM_CLEAR_CNT 8u
+
+/*******************************************************************************
+ *  Types
+ ******************************************************************************/
+
+/// Alarm states
+typedef enum
+{
+    ALARM_ST_IDLE,     //!< No deflation
+    ALARM_ST_SUSPECT,  //!< Deflating sample, sampling rate raised
+    ALARM_ST_ACTIVE    //!< Deflation confirmed
+} alarm_state_ten;
+
+/******************************************************************************\
+ *  Global variables
+\******************************************************************************/
+
+/// Alarm state
+SECTION_PERSISTENT static alarm_state_ten alarm_state = ALARM_ST_IDLE;
+
+/// Last pressure sample [LSB]
+SECTION_PERSISTENT static int16_t alarm_lastP = 0;
+
+/// Sequence time of the last pressure sample [ms]
+SECTION_PERSISTENT static uint32_t alarm_lastP_ms = 0u;
+
+/// Is the last pressure sample valid
+SECTION_PERSISTENT static bool alarm_lastValid = false;
+
+/// Filtered pressure slope [1/16 LSB/s]
+SECTION_PERSISTENT static int32_t alarm_slope = 0;
+
+/// Sequence time of the last sample without deflation [ms]
+SECTION_PERSISTENT static uint32_t alarm_stable_ms = 0u;
+
+/// Number of consecutive samples above the clear threshold
+SECTION_PERSISTENT static uint8_t alarm_clearCnt = 0u;
+
+/// Latency of the last alarm [ms]
+SECTION_PERSISTENT static uint32_t alarm_latency_ms = 0u;
+
+/// Maximum latency of all alarms [ms]
+SECTION_PERSISTENT static uint32_t alarm_maxLatency_ms = 0u;
+
+/// @}
+
+/******************************************************************************\
+ *  Functions declarations
+\******************************************************************************/
+
+/**
+ * @brief      Raises the alarm.
+ * @details    Measures the latency from the last stable sample.
+ * @param[in]  now_ms  The sequence time of the sample.
+ * return     None
+ */
+static void raiseAlarm(uint32_t now_ms)
+{
+    alarm_state      = ALARM_ST_ACTIVE;
+    alarm_clearCnt   = 0u;
+    alarm_latency_ms = now_ms - alarm_stable_ms;
+
+    if (alarm_latency_ms > alarm_maxLatency_ms)
+    {
+        alarm_maxLatency_ms = alarm_latency_ms;
+    }
+    smp290_log(LOG_VERBOSITY_WARNING, "\tDeflation alarm! latency %lu ms, max %lu ms\r\n", (unsigned long)alarm_latency_ms,
+               (unsigned long)alarm_maxLatency_ms);
+}
+
+// Updates the alarm with a new pressure sample.
+bool alarm_update(int16_t p, uint32_t now_ms)
+{
+    bool onset = false;
+    int32_t slope;
+
+    if (alarm_lastValid && (now_ms != alarm_lastP_ms))
+    {
+        // Slope of the sample, filtered
+        slope = (((int32_t)p - (int32_t)alarm_lastP) * ALARM_SLOPE_SCALE * 1000) / (int32_t)(now_ms - alarm_lastP_ms);
+        alarm_slope += (slope - alarm_slope) / (1 << ALARM_SLOPE_FILT_SHIFT);
+
+        switch (alarm_state)
+        {
+            case ALARM_ST_IDLE:
+            {
+                if (slope < ALARM_SLOPE_THLD)
+                {
+                    // Confirm quickly at the high sampling rate
+                    alarm_state = ALARM_ST_SUSPECT;
+                    motion_hold(true);
+                }
+                else
+                {
+                    alarm_stable_ms = now_ms;
+                }
+            }
+            break;
+
+            case ALARM_ST_SUSPECT:
+            {
+                if (alarm_slope < ALARM_SLOPE_THLD)
+                {
+                    raiseAlarm(now_ms);
+                    onset = true;
+                }
+                else if (alarm_slope > ALARM_SLOPE_CLEAR_THLD)
+                {
+                    // False alarm
+                    alarm_state     = ALARM_ST_IDLE;
+                    alarm_stable_ms = now_ms;
+                    motion_hold(false);
+                }
+                else
+                {
+                    // Nothing to do
+                }
+            }
+            break;
+
+            case ALARM_ST_ACTIVE:
+            {
+                alarm_clearCnt = (alarm_slope > ALARM_SLOPE_CLEAR_THLD) ? (alarm_clearCnt + 1u) : 0u;
+
+                if (alarm_clearCnt >= ALARM_CLEAR_CNT)
+                {
+                    alarm_state     = ALARM_ST_IDLE;
+                    alarm_stable_ms = now_ms;
+                    motion_hold(false);
+                    smp290_log(LOG_VERBOSITY_INFO, "\tDeflation alarm cleared\r\n");
+                }
+            }
+            break;
+
+            default:
+            {
+                // Nothing to do
+            }
+            break;
+        }
+    }
+    else
+    {
+        alarm_stable_ms = now_ms;
+    }
+
+    alarm_lastP     = p;
+    alarm_lastP_ms  = now_ms;
+    alarm_lastValid = true;
+
+    return onset;
+}
+
+// Tells if the alarm is active.
+bool alarm_isActive(void)
+{
+    return (ALARM_ST_ACTIVE == alarm_state);
+}
+
+// Returns the latency of the last alarm.
+uint32_t alarm_getLatency(void)
+{
+    return alarm_latency_ms;
+}
+
+// Returns the maximum latency of all alarms.
+uint32_t alarm_getMaxLatency(void)
+{
+    return alarm_maxLatency_ms;
+}
+
+/** @} */
@@ -4,7 +4,9 @@
  * @file         ble_custSvc.c
  * @brief        Ble custom service implementation example
  * @details      This file contains the implementation of a custom BLE service for the measure_advertise_conn example.
- *               The custom service includes characteristics for TX power, counter value, and GPIO status.
+ *               The custom service includes characteristics for TX power, counter value, GPIO status,
+ *               the advertising triggers, policy and mode, the link budget of the TX power control and the
+ *               \glos{NVM} wear counters.
  *               It also provides functions for sending indications and handling timer events.
  * @copyright    (c) [Robert Bosch GmbH] [2024].
  *               All rights reserved, also regarding any disposal,
@@ -47,8 +49,6 @@ volatile uint16_t ble_indicnCntr = 0u;
 static uint8_t ble_indicnBuff[BLE_CUST_SVC_CCC_BUFF_SIZE] = {0};
 /// TX power level
 int8_t ble_txPwrLvl;
-/// Buffer for TX power level
-SECTION_PERSISTENT uint8_t tx_lvl = 1;
 
 /**************************************************************************************************
   Custom service group
@@ -109,6 +109,107 @@ static uint16_t TSDCharDataLen = sizeof(TSDCharData);
 /// TSD characteristic user description value
 static const uint8_t TSDCharUserDesc[]   = "TSD";
 static const uint16_t TSDCharUserDescLen = sizeof(TSDCharUserDesc);
+/**************************************************************************************************
+  Advertising trigger definitions
+ **************************************************************************************************/
+/// Advertising trigger characteristic declaration
+static const uint8_t advTrigCharUuid[] = {BLE_CUST_SVC_ADV_TRIG_CHAR_UUID};
+static const uint8_t advTrigCharVal[]  = {((uint8_t)RBK_SMP290_BLE_ATTS_PPTY_READ | (uint8_t)RBK_SMP290_BLE_ATTS_PPTY_WRITE),
+                                         RBK_SMP290_CONV_U16_TO_BYTES((uint16_t)BLE_CUST_SVC_ADV_TRIG_CHAR_DATA_HNDL), BLE_CUST_SVC_ADV_TRIG_CHAR_UUID};
+static const uint16_t advTrigCharLen   = sizeof(advTrigCharVal);
+
+/// Advertising trigger characteristic value
+static uint8_t advTrigCharData[BLE_CUST_SVC_ADV_TRIG_LEN] = {0};
+static uint16_t advTrigCharDataLen                        = sizeof(advTrigCharData);
+
+/// Advertising trigger characteristic user description value
+static const uint8_t advTrigCharUserDesc[]   = "Adv. trigger: p delta, T delta, heartbeat";
+static const uint16_t advTrigCharUserDescLen = sizeof(advTrigCharUserDesc);
+
+/**************************************************************************************************
+  Advertising policy definitions
+ **************************************************************************************************/
+/// Advertising policy characteristic declaration
+static const uint8_t advPolCharUuid[] = {BLE_CUST_SVC_ADV_POL_CHAR_UUID};
+static const uint8_t advPolCharVal[]  = {((uint8_t)RBK_SMP290_BLE_ATTS_PPTY_READ | (uint8_t)RBK_SMP290_BLE_ATTS_PPTY_WRITE),
+                                        RBK_SMP290_CONV_U16_TO_BYTES((uint16_t)BLE_CUST_SVC_ADV_POL_CHAR_DATA_HNDL), BLE_CUST_SVC_ADV_POL_CHAR_UUID};
+static const uint16_t advPolCharLen   = sizeof(advPolCharVal);
+
+/// Advertising policy characteristic value
+static uint8_t advPolCharData[BLE_CUST_SVC_ADV_POL_LEN] = {0};
+static uint16_t advPolCharDataLen                       = sizeof(advPolCharData);
+
+/// Advertising policy characteristic user description value
+static const uint8_t advPolCharUserDesc[]   = "Adv. policy: maintenance, interval and duration per state";
+static const uint16_t advPolCharUserDescLen = sizeof(advPolCharUserDesc);
+
+/**************************************************************************************************
+  Advertising radio-on time definitions
+ **************************************************************************************************/
+/// Advertising radio-on time characteristic declaration
+static const uint8_t advRadioCharUuid[] = {BLE_CUST_SVC_ADV_RADIO_CHAR_UUID};
+static const uint8_t advRadioCharVal[]  = {(uint8_t)RBK_SMP290_BLE_ATTS_PPTY_READ,
+                                          RBK_SMP290_CONV_U16_TO_BYTES((uint16_t)BLE_CUST_SVC_ADV_RADIO_CHAR_DATA_HNDL), BLE_CUST_SVC_ADV_RADIO_CHAR_UUID};
+static const uint16_t advRadioCharLen   = sizeof(advRadioCharVal);
+
+/// Advertising radio-on time characteristic value
+static uint8_t advRadioCharData[BLE_CUST_SVC_ADV_RADIO_LEN] = {0};
+static uint16_t advRadioCharDataLen                         = sizeof(advRadioCharData);
+
+/// Advertising radio-on time characteristic user description value
+static const uint8_t advRadioCharUserDesc[]   = "Adv. radio-on time per state, last hour [us]";
+static const uint16_t advRadioCharUserDescLen = sizeof(advRadioCharUserDesc);
+
+/**************************************************************************************************
+  Advertising mode definitions
+ **************************************************************************************************/
+/// Advertising mode characteristic declaration
+static const uint8_t advModeCharUuid[] = {BLE_CUST_SVC_ADV_MODE_CHAR_UUID};
+static const uint8_t advModeCharVal[]  = {((uint8_t)RBK_SMP290_BLE_ATTS_PPTY_READ | (uint8_t)RBK_SMP290_BLE_ATTS_PPTY_WRITE),
+                                         RBK_SMP290_CONV_U16_TO_BYTES((uint16_t)BLE_CUST_SVC_ADV_MODE_CHAR_DATA_HNDL), BLE_CUST_SVC_ADV_MODE_CHAR_UUID};
+static const uint16_t advModeCharLen   = sizeof(advModeCharVal);
+
+/// Advertising mode characteristic value
+static uint8_t advModeCharData[BLE_CUST_SVC_ADV_MODE_LEN] = {0};
+static uint16_t advModeCharDataLen                        = sizeof(advModeCharData);
+
+/// Advertising mode characteristic user description value
+static const uint8_t advModeCharUserDesc[]   = "Adv. mode: broadcast, window period [s]";
+static const uint16_t advModeCharUserDescLen = sizeof(advModeCharUserDesc);
+
+/**************************************************************************************************
+  Link budget definitions
+ **************************************************************************************************/
+/// Link budget characteristic declaration
+static const uint8_t linkCharUuid[] = {BLE_CUST_SVC_LINK_CHAR_UUID};
+static const uint8_t linkCharVal[]  = {((uint8_t)RBK_SMP290_BLE_ATTS_PPTY_READ | (uint8_t)RBK_SMP290_BLE_ATTS_PPTY_WRITE),
+                                      RBK_SMP290_CONV_U16_TO_BYTES((uint16_t)BLE_CUST_SVC_LINK_CHAR_DATA_HNDL), BLE_CUST_SVC_LINK_CHAR_UUID};
+static const uint16_t linkCharLen   = sizeof(linkCharVal);
+
+/// Link budget characteristic value
+static uint8_t linkCharData[BLE_CUST_SVC_LINK_LEN] = {0};
+static uint16_t linkCharDataLen                    = sizeof(linkCharData);
+
+/// Link budget characteristic user description value
+static const uint8_t linkCharUserDesc[]   = "Link: margin [dB], RSSI [dBm], TX power [dBm]";
+static const uint16_t linkCharUserDescLen = sizeof(linkCharUserDesc);
+
+/**************************************************************************************************
+  NVM wear definitions
+ **************************************************************************************************/
+/// NVM wear characteristic declaration
+static const uint8_t nvmCharUuid[] = {BLE_CUST_SVC_NVM_CHAR_UUID};
+static const uint8_t nvmCharVal[]  = {(uint8_t)RBK_SMP290_BLE_ATTS_PPTY_READ,
+                                     RBK_SMP290_CONV_U16_TO_BYTES((uint16_t)BLE_CUST_SVC_NVM_CHAR_DATA_HNDL), BLE_CUST_SVC_NVM_CHAR_UUID};
+static const uint16_t nvmCharLen   = sizeof(nvmCharVal);
+
+/// NVM wear characteristic value
+static uint8_t nvmCharData[BLE_CUST_SVC_NVM_LEN] = {0};
+static uint16_t nvmCharDataLen                   = sizeof(nvmCharData);
+
+/// NVM wear characteristic user description value
+static const uint8_t nvmCharUserDesc[]   = "NVM: erases, writes since reset";
+static const uint16_t nvmCharUserDescLen = sizeof(nvmCharUserDesc);
 
 /**************************************************************************************************
   Custom service attributes list
@@ -218,6 +319,174 @@ static const rbk_smp290_ble_attsAttr_tst custSvcAttrGrp[] = {
         sizeof(TSDCharUserDesc),                // Characteristic User Description Value maximum length
         (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic User description Attribute settings
         (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic User description Attribute Permission
+    },
+    /// Advertising trigger Characteristic
+    {
+        rbk_smp290_ble_attsChUuid,                // Characteristic declaration UUID: 0x2803
+        (uint8_t *)advTrigCharVal,               // Characteristic Attribute Value
+        (uint16_t *)&advTrigCharLen,             // Characteristic Attribute Value length
+        sizeof(advTrigCharVal),                  // Characteristic Attribute Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic attribute permission
+    },
+    /// Advertising trigger Characteristic value declaration
+    {
+        advTrigCharUuid,                  // Characteristic UUID: 02a63290-1a04-b83e-af18-025703723367
+        (uint8_t *)advTrigCharData,       // Characteristic value
+        (uint16_t *)&advTrigCharDataLen,  // Characteristic value length
+        sizeof(advTrigCharData),          // Characteristic value maximum Length
+        ((uint8_t)RBK_SMP290_BLE_ATTS_SET_UUID_128 | (uint8_t)RBK_SMP290_BLE_ATTS_SET_VARIABLE_LEN | (uint8_t)RBK_SMP290_BLE_ATTS_SET_READ_CBACK |
+         (uint8_t)RBK_SMP290_BLE_ATTS_SET_WRITE_CBACK),                                        // Characteristic value Attribute settings
+        ((uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ | (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_WRITE)  // Characteristic value Attribute permission
+    },
+    /// Advertising trigger Characteristic User Description
+    {
+        rbk_smp290_ble_attsChUserDescUuid,        // Characteristic User Description: 0x2901
+        (uint8_t *)advTrigCharUserDesc,          // Characteristic User Description Value
+        (uint16_t *)&advTrigCharUserDescLen,     // Characteristic User Description Value length
+        sizeof(advTrigCharUserDesc),             // Characteristic User Description Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic User description Attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic User description Attribute Permission
+    },
+    /// Advertising policy Characteristic
+    {
+        rbk_smp290_ble_attsChUuid,                // Characteristic declaration UUID: 0x2803
+        (uint8_t *)advPolCharVal,                // Characteristic Attribute Value
+        (uint16_t *)&advPolCharLen,              // Characteristic Attribute Value length
+        sizeof(advPolCharVal),                   // Characteristic Attribute Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic attribute permission
+    },
+    /// Advertising policy Characteristic value declaration
+    {
+        advPolCharUuid,                  // Characteristic UUID: 02a63290-1a05-b83e-af18-025703723367
+        (uint8_t *)advPolCharData,       // Characteristic value
+        (uint16_t *)&advPolCharDataLen,  // Characteristic value length
+        sizeof(advPolCharData),          // Characteristic value maximum Length
+        ((uint8_t)RBK_SMP290_BLE_ATTS_SET_UUID_128 | (uint8_t)RBK_SMP290_BLE_ATTS_SET_VARIABLE_LEN | (uint8_t)RBK_SMP290_BLE_ATTS_SET_READ_CBACK |
+         (uint8_t)RBK_SMP290_BLE_ATTS_SET_WRITE_CBACK),                                        // Characteristic value Attribute settings
+        ((uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ | (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_WRITE)  // Characteristic value Attribute permission
+    },
+    /// Advertising policy Characteristic User Description
+    {
+        rbk_smp290_ble_attsChUserDescUuid,        // Characteristic User Description: 0x2901
+        (uint8_t *)advPolCharUserDesc,           // Characteristic User Description Value
+        (uint16_t *)&advPolCharUserDescLen,      // Characteristic User Description Value length
+        sizeof(advPolCharUserDesc),              // Characteristic User Description Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic User description Attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic User description Attribute Permission
+    },
+    /// Advertising radio-on time Characteristic
+    {
+        rbk_smp290_ble_attsChUuid,                // Characteristic declaration UUID: 0x2803
+        (uint8_t *)advRadioCharVal,              // Characteristic Attribute Value
+        (uint16_t *)&advRadioCharLen,            // Characteristic Attribute Value length
+        sizeof(advRadioCharVal),                 // Characteristic Attribute Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic attribute permission
+    },
+    /// Advertising radio-on time Characteristic value declaration
+    {
+        advRadioCharUuid,                  // Characteristic UUID: 02a63290-1a06-b83e-af18-025703723367
+        (uint8_t *)advRadioCharData,       // Characteristic value
+        (uint16_t *)&advRadioCharDataLen,  // Characteristic value length
+        sizeof(advRadioCharData),          // Characteristic value maximum Length
+        ((uint8_t)RBK_SMP290_BLE_ATTS_SET_UUID_128 | (uint8_t)RBK_SMP290_BLE_ATTS_SET_VARIABLE_LEN |
+         (uint8_t)RBK_SMP290_BLE_ATTS_SET_READ_CBACK),  // Characteristic value Attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ        // Characteristic value Attribute permission
+    },
+    /// Advertising radio-on time Characteristic User Description
+    {
+        rbk_smp290_ble_attsChUserDescUuid,        // Characteristic User Description: 0x2901
+        (uint8_t *)advRadioCharUserDesc,         // Characteristic User Description Value
+        (uint16_t *)&advRadioCharUserDescLen,    // Characteristic User Description Value length
+        sizeof(advRadioCharUserDesc),            // Characteristic User Description Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic User description Attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic User description Attribute Permission
+    },
+    /// Advertising mode Characteristic
+    {
+        rbk_smp290_ble_attsChUuid,                // Characteristic declaration UUID: 0x2803
+        (uint8_t *)advModeCharVal,               // Characteristic Attribute Value
+        (uint16_t *)&advModeCharLen,             // Characteristic Attribute Value length
+        sizeof(advModeCharVal),                  // Characteristic Attribute Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic attribute permission
+    },
+    /// Advertising mode Characteristic value declaration
+    {
+        advModeCharUuid,                  // Characteristic UUID: 02a63290-1a07-b83e-af18-025703723367
+        (uint8_t *)advModeCharData,       // Characteristic value
+        (uint16_t *)&advModeCharDataLen,  // Characteristic value length
+        sizeof(advModeCharData),          // Characteristic value maximum Length
+        ((uint8_t)RBK_SMP290_BLE_ATTS_SET_UUID_128 | (uint8_t)RBK_SMP290_BLE_ATTS_SET_VARIABLE_LEN | (uint8_t)RBK_SMP290_BLE_ATTS_SET_READ_CBACK |
+         (uint8_t)RBK_SMP290_BLE_ATTS_SET_WRITE_CBACK),                                        // Characteristic value Attribute settings
+        ((uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ | (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_WRITE)  // Characteristic value Attribute permission
+    },
+    /// Advertising mode Characteristic User Description
+    {
+        rbk_smp290_ble_attsChUserDescUuid,        // Characteristic User Description: 0x2901
+        (uint8_t *)advModeCharUserDesc,          // Characteristic User Description Value
+        (uint16_t *)&advModeCharUserDescLen,     // Characteristic User Description Value length
+        sizeof(advModeCharUserDesc),             // Characteristic User Description Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic User description Attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic User description Attribute Permission
+    },
+    /// Link budget Characteristic
+    {
+        rbk_smp290_ble_attsChUuid,                // Characteristic declaration UUID: 0x2803
+        (uint8_t *)linkCharVal,                  // Characteristic Attribute Value
+        (uint16_t *)&linkCharLen,                // Characteristic Attribute Value length
+        sizeof(linkCharVal),                     // Characteristic Attribute Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic attribute permission
+    },
+    /// Link budget Characteristic value declaration
+    {
+        linkCharUuid,                  // Characteristic UUID: 02a63290-1a08-b83e-af18-025703723367
+        (uint8_t *)linkCharData,       // Characteristic value
+        (uint16_t *)&linkCharDataLen,  // Characteristic value length
+        sizeof(linkCharData),          // Characteristic value maximum Length
+        ((uint8_t)RBK_SMP290_BLE_ATTS_SET_UUID_128 | (uint8_t)RBK_SMP290_BLE_ATTS_SET_VARIABLE_LEN | (uint8_t)RBK_SMP290_BLE_ATTS_SET_READ_CBACK |
+         (uint8_t)RBK_SMP290_BLE_ATTS_SET_WRITE_CBACK),                                        // Characteristic value Attribute settings
+        ((uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ | (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_WRITE)  // Characteristic value Attribute permission
+    },
+    /// Link budget Characteristic User Description
+    {
+        rbk_smp290_ble_attsChUserDescUuid,        // Characteristic User Description: 0x2901
+        (uint8_t *)linkCharUserDesc,             // Characteristic User Description Value
+        (uint16_t *)&linkCharUserDescLen,        // Characteristic User Description Value length
+        sizeof(linkCharUserDesc),                // Characteristic User Description Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic User description Attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic User description Attribute Permission
+    },
+    /// NVM wear Characteristic
+    {
+        rbk_smp290_ble_attsChUuid,                // Characteristic declaration UUID: 0x2803
+        (uint8_t *)nvmCharVal,                   // Characteristic Attribute Value
+        (uint16_t *)&nvmCharLen,                 // Characteristic Attribute Value length
+        sizeof(nvmCharVal),                      // Characteristic Attribute Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic attribute permission
+    },
+    /// NVM wear Characteristic value declaration
+    {
+        nvmCharUuid,                       // Characteristic UUID: 02a63290-1a09-b83e-af18-025703723367
+        (uint8_t *)nvmCharData,            // Characteristic value
+        (uint16_t *)&nvmCharDataLen,       // Characteristic value length
+        sizeof(nvmCharData),               // Characteristic value maximum Length
+        ((uint8_t)RBK_SMP290_BLE_ATTS_SET_UUID_128 | (uint8_t)RBK_SMP290_BLE_ATTS_SET_VARIABLE_LEN |
+         (uint8_t)RBK_SMP290_BLE_ATTS_SET_READ_CBACK),  // Characteristic value Attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ        // Characteristic value Attribute permission
+    },
+    /// NVM wear Characteristic User Description
+    {
+        rbk_smp290_ble_attsChUserDescUuid,        // Characteristic User Description: 0x2901
+        (uint8_t *)nvmCharUserDesc,              // Characteristic User Description Value
+        (uint16_t *)&nvmCharUserDescLen,         // Characteristic User Description Value length
+        sizeof(nvmCharUserDesc),                 // Characteristic User Description Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic User description Attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic User description Attribute Permission
     }
 };
 /**************************************************************************************************
@@ -263,12 +532,6 @@ rbk_smp290_ble_atts_err_ten custSvc_rdCallBack(rbk_smp290_ble_attsConnId connId,
             
             // The configured power level shall be stored in the global variable
             ble_txPwrLvl = rbk_smp290_ble_radio_getTxPwr();
-            // Store value in NVM
-            if (tx_lvl != ble_txPwrLvl)
-                {
-                (void)writeTxPwrToNvm(ble_txPwrLvl);// Get the current TX Power Level
-                tx_lvl = ble_txPwrLvl;
-                }
             *data = (uint8_t)(ble_txPwrLvl);
             *len  = 1;
             break;
@@ -292,6 +555,85 @@ rbk_smp290_ble_atts_err_ten custSvc_rdCallBack(rbk_smp290_ble_attsConnId connId,
             }
         	*len  = 1;
         	break;
+        case BLE_CUST_SVC_ADV_TRIG_CHAR_DATA_HNDL:
+        {
+            // Get the advertising trigger configuration
+            adv_trigCfg_tst const *cfg_p = adv_getTrigCfg();
+            data[0] = (uint8_t)(cfg_p->p_delta & 0xFFu);
+            data[1] = (uint8_t)(cfg_p->p_delta >> 8);
+            data[2] = (uint8_t)(cfg_p->T_delta & 0xFFu);
+            data[3] = (uint8_t)(cfg_p->T_delta >> 8);
+            data[4] = (uint8_t)(cfg_p->heartbeat_s & 0xFFu);
+            data[5] = (uint8_t)(cfg_p->heartbeat_s >> 8);
+            *len    = BLE_CUST_SVC_ADV_TRIG_LEN;
+        }
+        break;
+        case BLE_CUST_SVC_ADV_POL_CHAR_DATA_HNDL:
+        {
+            // Get the maintenance flag and the settings of every state
+            uint8_t state;
+            data[0] = adv_isMaintenance() ? 1u : 0u;
+            for (state = 0u; state < (uint8_t)ADV_STATE_MAX; state++)
+            {
+                adv_cadence_tst const *cadence_p = adv_getCadence((adv_state_ten)state);
+                uint8_t *dst_p                   = &data[1u + (state * BLE_CUST_SVC_ADV_POL_STATE_LEN)];
+                dst_p[0] = (uint8_t)(cadence_p->interval & 0xFFu);
+                dst_p[1] = (uint8_t)(cadence_p->interval >> 8);
+                dst_p[2] = (uint8_t)(cadence_p->duration & 0xFFu);
+                dst_p[3] = (uint8_t)(cadence_p->duration >> 8);
+            }
+            *len = BLE_CUST_SVC_ADV_POL_LEN;
+        }
+        break;
+        case BLE_CUST_SVC_ADV_RADIO_CHAR_DATA_HNDL:
+        {
+            // Get the radio-on time of every state in the last complete hour
+            uint8_t state;
+            for (state = 0u; state < (uint8_t)ADV_STATE_MAX; state++)
+            {
+                uint32_t radioOn_us = adv_getRadioOnTime((adv_state_ten)state);
+                uint8_t *dst_p      = &data[state * 4u];
+                dst_p[0] = (uint8_t)(radioOn_us & 0xFFu);
+                dst_p[1] = (uint8_t)((radioOn_us >> 8) & 0xFFu);
+                dst_p[2] = (uint8_t)((radioOn_us >> 16) & 0xFFu);
+                dst_p[3] = (uint8_t)(radioOn_us >> 24);
+            }
+            *len = BLE_CUST_SVC_ADV_RADIO_LEN;
+        }
+        break;
+        case BLE_CUST_SVC_ADV_MODE_CHAR_DATA_HNDL:
+        {
+            // Get the advertising mode and the period of the connectable windows
+            uint16_t period_s = adv_getConnWindowPeriod();
+            data[0] = (uint8_t)adv_getMode();
+            data[1] = (uint8_t)(period_s & 0xFFu);
+            data[2] = (uint8_t)(period_s >> 8);
+            *len    = BLE_CUST_SVC_ADV_MODE_LEN;
+        }
+        break;
+        case BLE_CUST_SVC_LINK_CHAR_DATA_HNDL:
+            // Get the margin, the last RSSI and the TX power level of the control
+            data[0] = txpwr_getMargin();
+            data[1] = (uint8_t)txpwr_getRssi();
+            data[2] = (uint8_t)rbk_smp290_ble_radio_getTxPwr();
+            *len    = BLE_CUST_SVC_LINK_LEN;
+            break;
+        case BLE_CUST_SVC_NVM_CHAR_DATA_HNDL:
+        {
+            // Get the NVM erase and write counts
+            uint32_t cnt[2] = {nvm_getEraseCnt(), nvm_getWriteCnt()};
+            uint8_t i;
+            for (i = 0u; i < 2u; i++)
+            {
+                uint8_t *dst_p = &data[i * 4u];
+                dst_p[0] = (uint8_t)(cnt[i] & 0xFFu);
+                dst_p[1] = (uint8_t)((cnt[i] >> 8) & 0xFFu);
+                dst_p[2] = (uint8_t)((cnt[i] >> 16) & 0xFFu);
+                dst_p[3] = (uint8_t)(cnt[i] >> 24);
+            }
+            *len = BLE_CUST_SVC_NVM_LEN;
+        }
+        break;
         default:
         {
             return RBK_SMP290_BLE_ATTS_ERR_HANDLE;
@@ -319,6 +661,48 @@ rbk_smp290_ble_atts_err_ten custSvc_wrCallBack(rbk_smp290_ble_attsConnId connId,
         case BLE_CUST_SVC_TSD_CHAR_DATA_HNDL:
             // Configure TSD
         	config_tsd(*pValue);
+            nvm_setDirty(NVM_ITEM_TSD);
+            break;
+        case BLE_CUST_SVC_ADV_TRIG_CHAR_DATA_HNDL:
+            // Configure the advertising triggers
+            if (BLE_CUST_SVC_ADV_TRIG_LEN != len)
+            {
+                return BLE_CUST_SVC_ATT_ERR_INVALID_LEN;
+            }
+            config_advTrig(pValue);
+            break;
+        case BLE_CUST_SVC_ADV_POL_CHAR_DATA_HNDL:
+            // Configure the advertising policy
+            if ((BLE_CUST_SVC_ADV_POL_MAINT_WR_LEN != len) && (BLE_CUST_SVC_ADV_POL_STATE_WR_LEN != len))
+            {
+                return BLE_CUST_SVC_ATT_ERR_INVALID_LEN;
+            }
+            if (!config_advPolicy(pValue, len))
+            {
+                return BLE_CUST_SVC_ATT_ERR_VALUE_NOT_ALLOWED;
+            }
+            break;
+        case BLE_CUST_SVC_ADV_MODE_CHAR_DATA_HNDL:
+            // Configure the advertising mode
+            if (BLE_CUST_SVC_ADV_MODE_LEN != len)
+            {
+                return BLE_CUST_SVC_ATT_ERR_INVALID_LEN;
+            }
+            if (!config_advMode(pValue))
+            {
+                return BLE_CUST_SVC_ATT_ERR_VALUE_NOT_ALLOWED;
+            }
+            break;
+        case BLE_CUST_SVC_LINK_CHAR_DATA_HNDL:
+            // Configure the link budget
+            if ((BLE_CUST_SVC_LINK_MARGIN_WR_LEN != len) && (BLE_CUST_SVC_LINK_HINT_WR_LEN != len))
+            {
+                return BLE_CUST_SVC_ATT_ERR_INVALID_LEN;
+            }
+            if (!config_link(pValue, len))
+            {
+                return BLE_CUST_SVC_ATT_ERR_VALUE_NOT_ALLOWED;
+            }
             break;
         default:
         {
@@ -393,12 +777,16 @@ static void custSvc_indication_timer_callback(rbk_smp290_ble_tmrPrm prm)
 }
 void addCustSvc()
 {
+    uint8_t tsd;
+
     (void)rbk_smp290_ble_atts_addAttrGrp((rbk_smp290_ble_attsAttrGrp_tst *)&custSvcGrp);
     // Periodic notification timer
     cntrCharIndicnTmr.prm  = (rbk_smp290_ble_tmrPrm)BLE_CUST_SVC_CNTR_CHAR_DATA_HNDL;
     (void)rbk_smp290_ble_timer_create(&cntrCharIndicnTmr, custSvc_indication_timer_callback);
-    //Set TSD default state
-    config_tsd(TSD_DEFAULT_STATUS);
+    //Set TSD state from NVM, else the default one
+    tsd = TSD_DEFAULT_STATUS;
+    (void)nvm_get(NVM_ITEM_TSD, &tsd, sizeof(tsd));
+    config_tsd(tsd);
 }
 void rmCustSvc()
 {
@@ -410,47 +798,103 @@ void config_txPwr(int8_t txPwr)
 {
     smp290_log(LOG_VERBOSITY_INFO, "TX Power :Received %d \r\n", txPwr);
 
-    if (ble_txPwrLvl != txPwr)
+    if (txpwr_getMax() != txPwr)
     {
-        // Set the RF out power
-        (void)rbk_smp290_ble_radio_setTxPwr(txPwr);
-        
+        // Set the maximum RF out power of the control
+        txpwr_setMax(txPwr);
+        nvm_setDirty(NVM_ITEM_TXPWR);
     }
     smp290_log(LOG_VERBOSITY_INFO, "TX Power :Configured :%d \r\n", ble_txPwrLvl);
 }
 
-rbk_smp290_nvm_err_ten writeTxPwrToNvm(int8_t txPwr)
+void config_advTrig(const uint8_t *value)
 {
-    rbk_smp290_nvm_err_ten ret;
-    // Create a NVM word sized buffer
-    ble_TxPwrNvm_tst buf;
+    adv_trigCfg_tst cfg;
 
-    // Set all bytes to 0
-    memset((void *)&buf, 0, sizeof(ble_TxPwrNvm_tst));
+    cfg.p_delta     = (uint16_t)((uint16_t)value[0] | ((uint16_t)value[1] << 8));
+    cfg.T_delta     = (uint16_t)((uint16_t)value[2] | ((uint16_t)value[3] << 8));
+    cfg.heartbeat_s = (uint16_t)((uint16_t)value[4] | ((uint16_t)value[5] << 8));
+    smp290_log(LOG_VERBOSITY_INFO, "Adv. trigger :Received p %d T %d heartbeat %d s\r\n", cfg.p_delta, cfg.T_delta, cfg.heartbeat_s);
 
-    buf.TxPwrNvm     = txPwr;
-    buf.TxPwrNvmStrd = true;
+    adv_setTrigCfg(&cfg);
+    nvm_setDirty(NVM_ITEM_ADVTRIG);
+}
 
-    ret = rbk_smp290_nvm_writeWithErase((void *)TXPWR_NVM_ADR, (const void *)&buf, 1u);
+bool config_advPolicy(const uint8_t *value, uint16_t len)
+{
+    adv_cadence_tst cadence;
+    bool ret = true;
 
+    if (BLE_CUST_SVC_ADV_POL_MAINT_WR_LEN == len)
+    {
+        adv_setMaintenance(0u != value[0]);
+    }
+    else
+    {
+        cadence.interval = (uint16_t)((uint16_t)value[1] | ((uint16_t)value[2] << 8));
+        cadence.duration = (uint16_t)((uint16_t)value[3] | ((uint16_t)value[4] << 8));
+        smp290_log(LOG_VERBOSITY_INFO, "Adv. policy :Received state %d interval %d duration %d ms\r\n", value[0], cadence.interval,
+                   cadence.duration);
+
+        // The interval and the duration are bounded per state
+        ret = (value[0] < (uint8_t)ADV_STATE_MAX) && adv_setCadence((adv_state_ten)value[0], &cadence);
+        if (ret)
+        {
+            nvm_setDirty(NVM_ITEM_ADVPOL);
+        }
+        else
+        {
+            // Nothing to do
+        }
+    }
+    return ret;
+}
+
+bool config_advMode(const uint8_t *value)
+{
+    uint16_t period_s = (uint16_t)((uint16_t)value[1] | ((uint16_t)value[2] << 8));
+    bool ret          = (value[0] < (uint8_t)ADV_MODE_MAX);
+
+    smp290_log(LOG_VERBOSITY_INFO, "Adv. mode :Received mode %d window period %d s\r\n", value[0], period_s);
+    // Only a mode the sensor can be reconnected from is stored
+    ret = ret && adv_setMode((adv_mode_ten)value[0], period_s);
+    if (ret)
+    {
+        nvm_setDirty(NVM_ITEM_ADVMODE);
+    }
+    else
+    {
+        // Nothing to do
+    }
     return ret;
 }
 
-int8_t readTxPwrFromNvm()
+bool config_link(const uint8_t *value, uint16_t len)
 {
-    const ble_TxPwrNvm_tst *txPwrNvmStruct = (ble_TxPwrNvm_tst *)TXPWR_NVM_ADR;
+    bool hint   = (BLE_CUST_SVC_LINK_HINT_WR_LEN == len);
+    int8_t rssi = hint ? (int8_t)value[1] : TXPWR_RSSI_NONE;
+    bool ret;
 
-    // Initialize with the default value
-    int8_t ret = RBK_SMP290_BLE_TX_PWR_6_DBM;
+    smp290_log(LOG_VERBOSITY_INFO, "Link :Received margin %d dB\r\n", value[0]);
+    if (hint)
+    {
+        smp290_log(LOG_VERBOSITY_INFO, "Link :Received hint %d dBm at %d dBm\r\n", rssi, (int8_t)value[2]);
+    }
 
-    if (1u == txPwrNvmStruct->TxPwrNvmStrd)
+    // The whole value is checked before any part is applied. RSSI range of the HCI, 127 is not available.
+    ret = !hint || (rssi < TXPWR_RSSI_NONE);
+    ret = ret && txpwr_setMargin(value[0]);
+    if (ret)
     {
-        ret = txPwrNvmStruct->TxPwrNvm;
-        smp290_log(LOG_VERBOSITY_INFO, "Read TxPwr from NVM: %d\r\n", ret);
+        nvm_setDirty(NVM_ITEM_LINK);
+        if (hint)
+        {
+            txpwr_setLinkHint(rssi, (int8_t)value[2]);
+        }
     }
     else
     {
-        smp290_log(LOG_VERBOSITY_INFO, "No TxPwr in NVM. Using default:%d\r\n", ret);
+        // Nothing to do
     }
     return ret;
 }
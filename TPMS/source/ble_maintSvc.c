@@ -17,6 +17,7 @@
  **/
 
 /* System includes */
+#include <stdio.h>
 #include <string.h>
 
 /* Library includes */
@@ -423,6 +424,10 @@ static void custmaintSvc_indication_timer_callback(rbk_smp290_ble_tmrPrm prm, rb
 
 void addCustmaintSvc()
 {
+    // Versions, also advertised in the scan response
+    HW_VerCharDataLen = (uint16_t)snprintf((char *)HW_VerCharData, sizeof(HW_VerCharData), "%u", DEVINFO_HW_VERSION);
+    FW_VerCharDataLen = (uint16_t)snprintf((char *)FW_VerCharData, sizeof(FW_VerCharData), "%u.%u.%u", DEVINFO_FW_VERSION_MAJOR,
+                                           DEVINFO_FW_VERSION_MINOR, DEVINFO_FW_VERSION_PATCH);
     (void)rbk_smp290_ble_atts_addAttrGrp((rbk_smp290_ble_attsAttrGrp_tst *)&custmaintSvcGrp);
     // Periodic notification timer
     //TP_SlftstCharIndicnTmr.prm  = (rbk_smp290_ble_tmrPrm)BLE_CUST_SVC_MAINT_TP_SLFTST_CHAR_DATA_HNDL;
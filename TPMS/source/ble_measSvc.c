@@ -5,7 +5,11 @@
  * @brief        Ble custom service implementation example
  * @details      This file contains the implementation of a custom BLE service for the measure_advertise_conn example.
  *               The custom service includes characteristics for triggering measurements.
- *               It also provides functions for sending indications and handling timer events.
+ *               The results are notified or indicated as configured by the client per characteristic, the
+ *               frame of every cycle of the sequence is streamed while connected. The deliveries are counted,
+ *               a burst of stream values measures the throughput of the link. The All characteristic captures
+ *               every channel in one request and returns them as one frame. The requests written while a
+ *               measurement runs are queued and started from its completion.
  * @copyright    (c) [Robert Bosch GmbH] [2024].
  *               All rights reserved, also regarding any disposal,
  *               exploitation, reproduction, editing, distribution, as well
@@ -51,6 +55,12 @@ static uint8_t ble_indicnSnsrBuffDouble[BLE_CUST_SVC_MEAS_CCC_BUFF_SIZE_DOUBLE]
 SECTION_PERSISTENT static uint16_t Snsr_buffer;
 /// Sensor measurement done
 SECTION_PERSISTENT bool meas_done = true;
+/// Measurement requests waiting for the sensor, handles of the characteristic values
+SECTION_PERSISTENT static rbk_smp290_ble_attsHndl MeasQueue[BLE_CUST_SVC_MEAS_QUEUE_LEN];
+/// Index of the oldest queued request
+SECTION_PERSISTENT static uint8_t MeasQueueHead = 0u;
+/// Number of queued requests
+SECTION_PERSISTENT static uint8_t MeasQueueCnt = 0u;
 /// Buffer for all mearuement results
 SECTION_PERSISTENT uint16_t meas_res[4] = {0};
 
@@ -68,7 +78,7 @@ static const uint16_t custmeasSvcLen = sizeof(custmeasSvc);
  **************************************************************************************************/
 /// Temperature characteristic declaration
 static const uint8_t TCharUuid[] = {BLE_CUST_SVC_MEAS_T_CHAR_UUID};
-static const uint8_t TCharVal[]  = {(uint8_t)RBK_SMP290_BLE_ATTS_PPTY_READ,
+static const uint8_t TCharVal[]  = {((uint8_t)RBK_SMP290_BLE_ATTS_PPTY_READ | (uint8_t)RBK_SMP290_BLE_ATTS_PPTY_NOTIFY | (uint8_t)RBK_SMP290_BLE_ATTS_PPTY_INDICATE),
                                            RBK_SMP290_CONV_U16_TO_BYTES((uint16_t)BLE_CUST_SVC_MEAS_T_CHAR_DATA_HNDL), BLE_CUST_SVC_MEAS_T_CHAR_UUID};
 static const uint16_t TCharLen   = sizeof(TCharVal);
 
@@ -89,7 +99,7 @@ static const uint16_t TCharCccLen = sizeof(TCharCccVal);
  **************************************************************************************************/
 /// TPAZ characteristic declaration
 static const uint8_t TPAZCharUuid[] = {BLE_CUST_SVC_MEAS_TPAZ_CHAR_UUID};
-static const uint8_t TPAZCharVal[]  = {(uint8_t)RBK_SMP290_BLE_ATTS_PPTY_READ,
+static const uint8_t TPAZCharVal[]  = {((uint8_t)RBK_SMP290_BLE_ATTS_PPTY_READ | (uint8_t)RBK_SMP290_BLE_ATTS_PPTY_NOTIFY | (uint8_t)RBK_SMP290_BLE_ATTS_PPTY_INDICATE),
                                            RBK_SMP290_CONV_U16_TO_BYTES((uint16_t)BLE_CUST_SVC_MEAS_TPAZ_CHAR_DATA_HNDL), BLE_CUST_SVC_MEAS_TPAZ_CHAR_UUID};
 static const uint16_t TPAZCharLen   = sizeof(TPAZCharVal);
 
@@ -110,7 +120,7 @@ static const uint16_t TPAZCharCccLen = sizeof(TPAZCharCccVal);
  **************************************************************************************************/
 /// TAZAX characteristic declaration
 static const uint8_t TAZAXCharUuid[] = {BLE_CUST_SVC_MEAS_TAZAX_CHAR_UUID};
-static const uint8_t TAZAXCharVal[]  = {(uint8_t)RBK_SMP290_BLE_ATTS_PPTY_READ,
+static const uint8_t TAZAXCharVal[]  = {((uint8_t)RBK_SMP290_BLE_ATTS_PPTY_READ | (uint8_t)RBK_SMP290_BLE_ATTS_PPTY_NOTIFY | (uint8_t)RBK_SMP290_BLE_ATTS_PPTY_INDICATE),
                                            RBK_SMP290_CONV_U16_TO_BYTES((uint16_t)BLE_CUST_SVC_MEAS_TAZAX_CHAR_DATA_HNDL), BLE_CUST_SVC_MEAS_TAZAX_CHAR_UUID};
 static const uint16_t TAZAXCharLen   = sizeof(TAZAXCharVal);
 
@@ -131,7 +141,7 @@ static const uint16_t TAZAXCharCccLen = sizeof(TAZAXCharCccVal);
  **************************************************************************************************/
 /// VBAT characteristic declaration
 static const uint8_t VBATCharUuid[] = {BLE_CUST_SVC_MEAS_VBAT_CHAR_UUID};
-static const uint8_t VBATCharVal[]  = {(uint8_t)RBK_SMP290_BLE_ATTS_PPTY_READ,
+static const uint8_t VBATCharVal[]  = {((uint8_t)RBK_SMP290_BLE_ATTS_PPTY_READ | (uint8_t)RBK_SMP290_BLE_ATTS_PPTY_NOTIFY | (uint8_t)RBK_SMP290_BLE_ATTS_PPTY_INDICATE),
                                            RBK_SMP290_CONV_U16_TO_BYTES((uint16_t)BLE_CUST_SVC_MEAS_VBAT_CHAR_DATA_HNDL), BLE_CUST_SVC_MEAS_VBAT_CHAR_UUID};
 static const uint16_t VBATCharLen   = sizeof(VBATCharVal);
 
@@ -147,6 +157,130 @@ static const uint16_t VBATCharUserDescLen = sizeof(VBATCharUserDesc);
 static uint8_t VBATCharCccVal[]      = {0x00, 0x00, 0x00};
 static const uint16_t VBATCharCccLen = sizeof(VBATCharCccVal);
 
+/**************************************************************************************************
+  History definitions
+ **************************************************************************************************/
+/// History characteristic declaration
+static const uint8_t HistCharUuid[] = {BLE_CUST_SVC_MEAS_HIST_CHAR_UUID};
+static const uint8_t HistCharVal[]  = {((uint8_t)RBK_SMP290_BLE_ATTS_PPTY_READ | (uint8_t)RBK_SMP290_BLE_ATTS_PPTY_WRITE),
+                                           RBK_SMP290_CONV_U16_TO_BYTES((uint16_t)BLE_CUST_SVC_MEAS_HIST_CHAR_DATA_HNDL), BLE_CUST_SVC_MEAS_HIST_CHAR_UUID};
+static const uint16_t HistCharLen   = sizeof(HistCharVal);
+
+/// History characteristic value: header followed by the records
+static uint8_t HistCharData[BLE_CUST_SVC_MEAS_HIST_LEN] = {0};
+static uint16_t HistCharDataLen = BLE_CUST_SVC_MEAS_HIST_HDR_LEN;
+
+/// History characteristic user description value
+static const uint8_t HistCharUserDesc[]   = "History";
+static const uint16_t HistCharUserDescLen = sizeof(HistCharUserDesc);
+
+/// Sequence number of the first history record read, moved by the client only
+SECTION_PERSISTENT static uint32_t HistCursor = 0u;
+
+/**************************************************************************************************
+  Stream definitions
+ **************************************************************************************************/
+/// Stream characteristic declaration
+static const uint8_t StreamCharUuid[] = {BLE_CUST_SVC_MEAS_STREAM_CHAR_UUID};
+static const uint8_t StreamCharVal[]  = {((uint8_t)RBK_SMP290_BLE_ATTS_PPTY_READ | (uint8_t)RBK_SMP290_BLE_ATTS_PPTY_NOTIFY | (uint8_t)RBK_SMP290_BLE_ATTS_PPTY_INDICATE),
+                                           RBK_SMP290_CONV_U16_TO_BYTES((uint16_t)BLE_CUST_SVC_MEAS_STREAM_CHAR_DATA_HNDL), BLE_CUST_SVC_MEAS_STREAM_CHAR_UUID};
+static const uint16_t StreamCharLen   = sizeof(StreamCharVal);
+
+/// Stream characteristic value: the frame of the last completed cycle
+static uint8_t StreamCharData[BLE_CUST_SVC_MEAS_STREAM_LEN] = {0};
+static uint16_t StreamCharDataLen = sizeof(StreamCharData);
+
+/// Stream characteristic user description value
+static const uint8_t StreamCharUserDesc[]   = "Stream";
+static const uint16_t StreamCharUserDescLen = sizeof(StreamCharUserDesc);
+
+/// Stream Characteristic Client Characteristic Configuration
+static uint8_t StreamCharCccVal[]      = {0x00, 0x00};
+static const uint16_t StreamCharCccLen = sizeof(StreamCharCccVal);
+
+/// Client Characteristic Configuration of the Stream characteristic set by the client
+SECTION_PERSISTENT static rbk_smp290_ble_atts_CccVal_ten StreamCcc = RBK_SMP290_BLE_ATTS_CCC_VAL_DISAD;
+
+/**************************************************************************************************
+  Delivery definitions
+ **************************************************************************************************/
+/// Delivery characteristic declaration
+static const uint8_t DlvrCharUuid[] = {BLE_CUST_SVC_MEAS_DLVR_CHAR_UUID};
+static const uint8_t DlvrCharVal[]  = {((uint8_t)RBK_SMP290_BLE_ATTS_PPTY_READ | (uint8_t)RBK_SMP290_BLE_ATTS_PPTY_WRITE),
+                                           RBK_SMP290_CONV_U16_TO_BYTES((uint16_t)BLE_CUST_SVC_MEAS_DLVR_CHAR_DATA_HNDL), BLE_CUST_SVC_MEAS_DLVR_CHAR_UUID};
+static const uint16_t DlvrCharLen   = sizeof(DlvrCharVal);
+
+/// Delivery characteristic value
+static uint8_t DlvrCharData[BLE_CUST_SVC_MEAS_DLVR_LEN] = {0};
+static uint16_t DlvrCharDataLen = sizeof(DlvrCharData);
+
+/// Delivery characteristic user description value
+static const uint8_t DlvrCharUserDesc[]   = "Delivery: notifications, indications, confirmations, failures";
+static const uint16_t DlvrCharUserDescLen = sizeof(DlvrCharUserDesc);
+
+/// Client Characteristic Configuration of the measurement characteristics set by the client
+SECTION_PERSISTENT static rbk_smp290_ble_atts_CccVal_ten TCcc     = RBK_SMP290_BLE_ATTS_CCC_VAL_DISAD;
+SECTION_PERSISTENT static rbk_smp290_ble_atts_CccVal_ten TPAZCcc  = RBK_SMP290_BLE_ATTS_CCC_VAL_DISAD;
+SECTION_PERSISTENT static rbk_smp290_ble_atts_CccVal_ten TAZAXCcc = RBK_SMP290_BLE_ATTS_CCC_VAL_DISAD;
+SECTION_PERSISTENT static rbk_smp290_ble_atts_CccVal_ten VBATCcc  = RBK_SMP290_BLE_ATTS_CCC_VAL_DISAD;
+
+/// Number of values notified, indicated, confirmed and refused by the stack
+SECTION_PERSISTENT static uint32_t DlvrNotifyCnt = 0u;
+SECTION_PERSISTENT static uint32_t DlvrIndicnCnt = 0u;
+SECTION_PERSISTENT static uint32_t DlvrCnfCnt    = 0u;
+SECTION_PERSISTENT static uint32_t DlvrFailCnt   = 0u;
+/// Number of stream values left in the delivery burst
+SECTION_PERSISTENT static uint16_t DlvrBurst = 0u;
+/// Delivery burst timer, paces the notifications which are not confirmed
+static rbk_smp290_ble_tmr_tst DlvrTmr;
+
+/**************************************************************************************************
+  All channels definitions
+ **************************************************************************************************/
+/// All channels characteristic declaration
+static const uint8_t AllCharUuid[] = {BLE_CUST_SVC_MEAS_ALL_CHAR_UUID};
+static const uint8_t AllCharVal[]  = {((uint8_t)RBK_SMP290_BLE_ATTS_PPTY_READ | (uint8_t)RBK_SMP290_BLE_ATTS_PPTY_WRITE |
+                                       (uint8_t)RBK_SMP290_BLE_ATTS_PPTY_NOTIFY | (uint8_t)RBK_SMP290_BLE_ATTS_PPTY_INDICATE),
+                                           RBK_SMP290_CONV_U16_TO_BYTES((uint16_t)BLE_CUST_SVC_MEAS_ALL_CHAR_DATA_HNDL), BLE_CUST_SVC_MEAS_ALL_CHAR_UUID};
+static const uint16_t AllCharLen   = sizeof(AllCharVal);
+
+/// All channels characteristic value: the frame of the last capture
+static uint8_t AllCharData[BLE_CUST_SVC_MEAS_ALL_LEN] = {0};
+static uint16_t AllCharDataLen = sizeof(AllCharData);
+
+/// All channels characteristic user description value
+static const uint8_t AllCharUserDesc[]   = "All";
+static const uint16_t AllCharUserDescLen = sizeof(AllCharUserDesc);
+
+/// All channels Characteristic Client Characteristic Configuration
+static uint8_t AllCharCccVal[]      = {0x00, 0x00};
+static const uint16_t AllCharCccLen = sizeof(AllCharCccVal);
+
+/// Client Characteristic Configuration of the All channels characteristic set by the client
+SECTION_PERSISTENT static rbk_smp290_ble_atts_CccVal_ten AllCcc = RBK_SMP290_BLE_ATTS_CCC_VAL_DISAD;
+
+/**************************************************************************************************
+  Alarm latency definitions
+ **************************************************************************************************/
+/// Alarm latency characteristic declaration
+static const uint8_t AlarmCharUuid[] = {BLE_CUST_SVC_MEAS_ALARM_CHAR_UUID};
+static const uint8_t AlarmCharVal[]  = {(uint8_t)RBK_SMP290_BLE_ATTS_PPTY_READ,
+                                           RBK_SMP290_CONV_U16_TO_BYTES((uint16_t)BLE_CUST_SVC_MEAS_ALARM_CHAR_DATA_HNDL), BLE_CUST_SVC_MEAS_ALARM_CHAR_UUID};
+static const uint16_t AlarmCharLen   = sizeof(AlarmCharVal);
+
+/// Alarm latency characteristic value
+static uint8_t AlarmCharData[BLE_CUST_SVC_MEAS_ALARM_LEN] = {0};
+static uint16_t AlarmCharDataLen = sizeof(AlarmCharData);
+
+/// Alarm latency characteristic user description value
+static const uint8_t AlarmCharUserDesc[]   = "Alarm latency: last, max";
+static const uint16_t AlarmCharUserDescLen = sizeof(AlarmCharUserDesc);
+
+/// Frame of the ongoing capture
+SECTION_PERSISTENT static ble_sensorData_tst AllFrame;
+/// Conversion of the ongoing capture
+SECTION_PERSISTENT static uint8_t AllStep;
+
 /**************************************************************************************************
   Custom service attributes list
  **************************************************************************************************/
@@ -312,6 +446,166 @@ static const rbk_smp290_ble_attsAttr_tst custmeasSvcAttrGrp[] = {
         (uint8_t)RBK_SMP290_BLE_ATTS_SET_CCC,  // Client characteristic configuration Attribute settings
         (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ |
         (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_WRITE  // Client characteristic configuration Attribute permission
+    },
+
+    /// History Characteristic
+    {
+        rbk_smp290_ble_attsChUuid,                // Characteristic declaration UUID: 0x2803
+        (uint8_t *)HistCharVal,                   // Characteristic Attribute Value
+        (uint16_t *)&HistCharLen,                 // Characteristic Attribute Value length
+        sizeof(HistCharVal),                      // Characteristic Attribute Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic attribute permission
+    },
+    /// History Characteristic value declaration
+    {
+        HistCharUuid,                      // Characteristic UUID
+        (uint8_t *)HistCharData,           // Characteristic value
+        (uint16_t *)&HistCharDataLen,      // Characteristic value length
+        sizeof(HistCharData),              // Characteristic value maximum Length
+        ((uint8_t)RBK_SMP290_BLE_ATTS_SET_UUID_128 | (uint8_t)RBK_SMP290_BLE_ATTS_SET_VARIABLE_LEN |
+         (uint8_t)RBK_SMP290_BLE_ATTS_SET_READ_CBACK | (uint8_t)RBK_SMP290_BLE_ATTS_SET_WRITE_CBACK),  // Characteristic value Attribute settings
+        ((uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ | (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_WRITE)         // Characteristic value Attribute permission
+    },
+    /// History Characteristic User Description
+    {
+        rbk_smp290_ble_attsChUserDescUuid,        // Characteristic User Description: 0x2901
+        (uint8_t *)HistCharUserDesc,              // Characteristic User Description Value
+        (uint16_t *)&HistCharUserDescLen,         // Characteristic User Description Value length
+        sizeof(HistCharUserDesc),                 // Characteristic User Description Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic User description Attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic User description Attribute Permission
+    },
+    /// Stream Characteristic
+    {
+        rbk_smp290_ble_attsChUuid,                // Characteristic declaration UUID: 0x2803
+        (uint8_t *)StreamCharVal,                 // Characteristic Attribute Value
+        (uint16_t *)&StreamCharLen,               // Characteristic Attribute Value length
+        sizeof(StreamCharVal),                    // Characteristic Attribute Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic attribute permission
+    },
+    /// Stream Characteristic value declaration
+    {
+        StreamCharUuid,                                // Characteristic UUID
+        (uint8_t *)StreamCharData,                     // Characteristic value
+        (uint16_t *)&StreamCharDataLen,                // Characteristic value length
+        sizeof(StreamCharData),                        // Characteristic value maximum Length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_UUID_128,     // Characteristic value Attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ       // Characteristic value Attribute permission
+    },
+    /// Stream Characteristic User Description
+    {
+        rbk_smp290_ble_attsChUserDescUuid,        // Characteristic User Description: 0x2901
+        (uint8_t *)StreamCharUserDesc,            // Characteristic User Description Value
+        (uint16_t *)&StreamCharUserDescLen,       // Characteristic User Description Value length
+        sizeof(StreamCharUserDesc),               // Characteristic User Description Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic User description Attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic User description Attribute Permission
+    },
+    /// Stream Characteristic client characteristic configuration
+    {
+        rbk_smp290_ble_attsCliChCfgUuid,       // Client characteristic configuration UUID: 0x2902
+        (uint8_t *)StreamCharCccVal,           // Client characteristic configuration Value
+        (uint16_t *)&StreamCharCccLen,         // Client characteristic configuration Value length
+        sizeof(StreamCharCccVal),              // Client characteristic configuration Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_CCC,  // Client characteristic configuration Attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ |
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_WRITE  // Client characteristic configuration Attribute permission
+    },
+    /// Delivery Characteristic
+    {
+        rbk_smp290_ble_attsChUuid,                // Characteristic declaration UUID: 0x2803
+        (uint8_t *)DlvrCharVal,                   // Characteristic Attribute Value
+        (uint16_t *)&DlvrCharLen,                 // Characteristic Attribute Value length
+        sizeof(DlvrCharVal),                      // Characteristic Attribute Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic attribute permission
+    },
+    /// Delivery Characteristic value declaration
+    {
+        DlvrCharUuid,                      // Characteristic UUID
+        (uint8_t *)DlvrCharData,           // Characteristic value
+        (uint16_t *)&DlvrCharDataLen,      // Characteristic value length
+        sizeof(DlvrCharData),              // Characteristic value maximum Length
+        ((uint8_t)RBK_SMP290_BLE_ATTS_SET_UUID_128 | (uint8_t)RBK_SMP290_BLE_ATTS_SET_VARIABLE_LEN |
+         (uint8_t)RBK_SMP290_BLE_ATTS_SET_READ_CBACK | (uint8_t)RBK_SMP290_BLE_ATTS_SET_WRITE_CBACK),  // Characteristic value Attribute settings
+        ((uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ | (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_WRITE)         // Characteristic value Attribute permission
+    },
+    /// Delivery Characteristic User Description
+    {
+        rbk_smp290_ble_attsChUserDescUuid,        // Characteristic User Description: 0x2901
+        (uint8_t *)DlvrCharUserDesc,              // Characteristic User Description Value
+        (uint16_t *)&DlvrCharUserDescLen,         // Characteristic User Description Value length
+        sizeof(DlvrCharUserDesc),                 // Characteristic User Description Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic User description Attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic User description Attribute Permission
+    },
+    /// All channels Characteristic
+    {
+        rbk_smp290_ble_attsChUuid,                // Characteristic declaration UUID: 0x2803
+        (uint8_t *)AllCharVal,                    // Characteristic Attribute Value
+        (uint16_t *)&AllCharLen,                  // Characteristic Attribute Value length
+        sizeof(AllCharVal),                       // Characteristic Attribute Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic attribute permission
+    },
+    /// All channels Characteristic value declaration
+    {
+        AllCharUuid,                       // Characteristic UUID
+        (uint8_t *)AllCharData,            // Characteristic value
+        (uint16_t *)&AllCharDataLen,       // Characteristic value length
+        sizeof(AllCharData),               // Characteristic value maximum Length
+        ((uint8_t)RBK_SMP290_BLE_ATTS_SET_UUID_128 | (uint8_t)RBK_SMP290_BLE_ATTS_SET_VARIABLE_LEN |
+         (uint8_t)RBK_SMP290_BLE_ATTS_SET_WRITE_CBACK),                                         // Characteristic value Attribute settings
+        ((uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ | (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_WRITE)  // Characteristic value Attribute permission
+    },
+    /// All channels Characteristic User Description
+    {
+        rbk_smp290_ble_attsChUserDescUuid,        // Characteristic User Description: 0x2901
+        (uint8_t *)AllCharUserDesc,               // Characteristic User Description Value
+        (uint16_t *)&AllCharUserDescLen,          // Characteristic User Description Value length
+        sizeof(AllCharUserDesc),                  // Characteristic User Description Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic User description Attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic User description Attribute Permission
+    },
+    /// All channels Characteristic client characteristic configuration
+    {
+        rbk_smp290_ble_attsCliChCfgUuid,       // Client characteristic configuration UUID: 0x2902
+        (uint8_t *)AllCharCccVal,              // Client characteristic configuration Value
+        (uint16_t *)&AllCharCccLen,            // Client characteristic configuration Value length
+        sizeof(AllCharCccVal),                 // Client characteristic configuration Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_CCC,  // Client characteristic configuration Attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ |
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_WRITE  // Client characteristic configuration Attribute permission
+    },
+    /// Alarm latency Characteristic
+    {
+        rbk_smp290_ble_attsChUuid,                // Characteristic declaration UUID: 0x2803
+        (uint8_t *)AlarmCharVal,                  // Characteristic Attribute Value
+        (uint16_t *)&AlarmCharLen,                // Characteristic Attribute Value length
+        sizeof(AlarmCharVal),                     // Characteristic Attribute Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic attribute permission
+    },
+    /// Alarm latency Characteristic value declaration
+    {
+        AlarmCharUuid,                     // Characteristic UUID
+        (uint8_t *)AlarmCharData,          // Characteristic value
+        (uint16_t *)&AlarmCharDataLen,     // Characteristic value length
+        sizeof(AlarmCharData),             // Characteristic value maximum Length
+        ((uint8_t)RBK_SMP290_BLE_ATTS_SET_UUID_128 | (uint8_t)RBK_SMP290_BLE_ATTS_SET_VARIABLE_LEN |
+         (uint8_t)RBK_SMP290_BLE_ATTS_SET_READ_CBACK),  // Characteristic value Attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ        // Characteristic value Attribute permission
+    },
+    /// Alarm latency Characteristic User Description
+    {
+        rbk_smp290_ble_attsChUserDescUuid,        // Characteristic User Description: 0x2901
+        (uint8_t *)AlarmCharUserDesc,             // Characteristic User Description Value
+        (uint16_t *)&AlarmCharUserDescLen,        // Characteristic User Description Value length
+        sizeof(AlarmCharUserDesc),                // Characteristic User Description Value maximum length
+        (uint8_t)RBK_SMP290_BLE_ATTS_SET_NONE,    // Characteristic User description Attribute settings
+        (uint8_t)RBK_SMP290_BLE_ATTS_PERMIT_READ  // Characteristic User description Attribute Permission
     }
 };
 /**************************************************************************************************
@@ -340,6 +634,26 @@ static void send_TAZAXChar_indication(rbk_smp290_ble_tmrPrm Evt, rbk_smp290_snsr
 static void send_VBATChar_indication(rbk_smp290_ble_tmrPrm Evt, rbk_smp290_snsr_err_ten status);
 // Custom service indication timer call back
 static void custmeasSvc_indication_timer_callback(rbk_smp290_ble_tmrPrm prm, rbk_smp290_snsr_err_ten status);
+// Fill the history characteristic value
+static void fillHistChar(uint8_t *data, uint16_t *len);
+// Send a value as configured by the client
+static bool sendValue(rbk_smp290_ble_atts_CccVal_ten cccVal, rbk_smp290_ble_attsHndl hndl, uint16_t len, uint8_t *value_p);
+// Send the next value of the delivery burst
+static void sendBurstValue(void);
+// Delivery burst timer call back
+static void dlvrTimerCallback(rbk_smp290_ble_tmrPrm prm);
+// Start a conversion of the all channels capture
+static rbk_smp290_snsr_err_ten startAllStep(uint8_t step);
+// Collect a conversion of the all channels capture
+static void collectAllStep(uint8_t step);
+// Continue the all channels capture
+static void send_AllChar_indication(rbk_smp290_ble_tmrPrm Evt, rbk_smp290_snsr_err_ten status);
+// Start a measurement request
+static rbk_smp290_snsr_err_ten startMeas(rbk_smp290_ble_attsHndl hndl);
+// Queue a measurement request
+static bool queueMeas(rbk_smp290_ble_attsHndl hndl);
+// Report a measurement request refused by the driver
+static void failMeas(rbk_smp290_ble_attsHndl hndl, rbk_smp290_snsr_err_ten status);
 
 /// Buffer for Battery voltage reading
 static rbk_smp290_snsr_Vbat_buff_tst vbat_meas_buff;
@@ -353,7 +667,6 @@ rbk_smp290_ble_atts_err_ten custmeasSvc_rdCallBack(rbk_smp290_ble_attsConnId con
 {
     (void)(connId);
     (void)(Op);
-    (void)(offset);
 
     
     uint8_t *data = pAttr->pAttValue;
@@ -361,6 +674,22 @@ rbk_smp290_ble_atts_err_ten custmeasSvc_rdCallBack(rbk_smp290_ble_attsConnId con
 
     switch (handle)
     {
+        case BLE_CUST_SVC_MEAS_HIST_CHAR_DATA_HNDL:
+            // Long read: the value is filled on the first part only, the following
+            // parts are served by the stack from the same snapshot at their offset
+            if (0u == offset)
+            {
+                fillHistChar(data, len);
+            }
+            else if (offset > *len)
+            {
+                return RBK_SMP290_BLE_ATTS_ERR_OFFSET;
+            }
+            else
+            {
+                // Nothing to do
+            }
+            break;
         
         case BLE_CUST_SVC_MEAS_T_CHAR_DATA_HNDL:
             //Get T
@@ -406,6 +735,38 @@ rbk_smp290_ble_atts_err_ten custmeasSvc_rdCallBack(rbk_smp290_ble_attsConnId con
 
         	*len  = 2;
         	break;
+        case BLE_CUST_SVC_MEAS_DLVR_CHAR_DATA_HNDL:
+        {
+            // Get the delivery counts
+            uint32_t cnt[4] = {DlvrNotifyCnt, DlvrIndicnCnt, DlvrCnfCnt, DlvrFailCnt};
+            uint8_t i;
+            for (i = 0u; i < 4u; i++)
+            {
+                uint8_t *dst_p = &data[i * 4u];
+                dst_p[0] = (uint8_t)(cnt[i] & 0xFFu);
+                dst_p[1] = (uint8_t)((cnt[i] >> 8) & 0xFFu);
+                dst_p[2] = (uint8_t)((cnt[i] >> 16) & 0xFFu);
+                dst_p[3] = (uint8_t)(cnt[i] >> 24);
+            }
+            *len = BLE_CUST_SVC_MEAS_DLVR_LEN;
+        }
+        break;
+        case BLE_CUST_SVC_MEAS_ALARM_CHAR_DATA_HNDL:
+        {
+            // Get the latencies of the deflation alarm
+            uint32_t lat[2] = {alarm_getLatency(), alarm_getMaxLatency()};
+            uint8_t i;
+            for (i = 0u; i < 2u; i++)
+            {
+                uint8_t *dst_p = &data[i * 4u];
+                dst_p[0] = (uint8_t)(lat[i] & 0xFFu);
+                dst_p[1] = (uint8_t)((lat[i] >> 8) & 0xFFu);
+                dst_p[2] = (uint8_t)((lat[i] >> 16) & 0xFFu);
+                dst_p[3] = (uint8_t)(lat[i] >> 24);
+            }
+            *len = BLE_CUST_SVC_MEAS_ALARM_LEN;
+        }
+        break;
         default:
         {
             return RBK_SMP290_BLE_ATTS_ERR_HANDLE;
@@ -428,45 +789,51 @@ rbk_smp290_ble_atts_err_ten custmeasSvc_wrCallBack(rbk_smp290_ble_attsConnId con
 
     switch (handle)
     {
-        
-        case BLE_CUST_SVC_MEAS_T_CHAR_DATA_HNDL:
-            // Configure T
-            if (meas_done)
+        case BLE_CUST_SVC_MEAS_HIST_CHAR_DATA_HNDL:
+            // Acknowledge the records read: set the sequence number of the first record of the next read
+            if (BLE_CUST_SVC_MEAS_HIST_CURSOR_LEN != len)
             {
-                meas_done = false;
-                Snsr_buffer = (rbk_smp290_ble_tmrPrm)BLE_CUST_SVC_MEAS_T_CHAR_DATA_HNDL;
-                status = rbk_smp290_snsr_meas_cmpd_T();
+                return RBK_SMP290_BLE_ATTS_ERR_LENGTH;
             }
+            HistCursor = (uint32_t)pValue[0] | ((uint32_t)pValue[1] << 8) | ((uint32_t)pValue[2] << 16) | ((uint32_t)pValue[3] << 24);
             break;
-        case BLE_CUST_SVC_MEAS_TPAZ_CHAR_DATA_HNDL:
-            // Configure TPAZ
-            if (meas_done)
+
+        case BLE_CUST_SVC_MEAS_DLVR_CHAR_DATA_HNDL:
+            // Reset the counts and send a burst of stream values, each one after the previous one is sent
+            if (BLE_CUST_SVC_MEAS_DLVR_BURST_LEN != len)
             {
-                meas_done = false;
-                Snsr_buffer = (rbk_smp290_ble_tmrPrm)BLE_CUST_SVC_MEAS_TPAZ_CHAR_DATA_HNDL;
-                status = rbk_smp290_snsr_meas_cmpd_p(RBK_SMP290_SNSR_EN_ENABLE, RBK_SMP290_SNSR_EN_ENABLE);
+                return RBK_SMP290_BLE_ATTS_ERR_LENGTH;
             }
-            break;
-        case BLE_CUST_SVC_MEAS_TAZAX_CHAR_DATA_HNDL:
-            // Configure TAZAX
-            if (meas_done)
+            DlvrNotifyCnt = 0u;
+            DlvrIndicnCnt = 0u;
+            DlvrCnfCnt    = 0u;
+            DlvrFailCnt   = 0u;
+            DlvrBurst     = (uint16_t)pValue[0] | ((uint16_t)pValue[1] << 8);
+            (void)rbk_smp290_ble_timer_disable(&DlvrTmr);
+            if (0u != DlvrBurst)
             {
-                meas_done = false;
-                Snsr_buffer = (rbk_smp290_ble_tmrPrm)BLE_CUST_SVC_MEAS_TAZAX_CHAR_DATA_HNDL;
-                status = rbk_smp290_snsr_meas_cmpd_az_ax(RBK_SMP290_SNSR_EN_ENABLE, RBK_SMP290_SNSR_RANGE_HI, RBK_SMP290_SNSR_RANGE_HI);
+                sendBurstValue();
             }
             break;
+        
+        case BLE_CUST_SVC_MEAS_T_CHAR_DATA_HNDL:
+        case BLE_CUST_SVC_MEAS_TPAZ_CHAR_DATA_HNDL:
+        case BLE_CUST_SVC_MEAS_TAZAX_CHAR_DATA_HNDL:
         case BLE_CUST_SVC_MEAS_VBAT_CHAR_DATA_HNDL:
-            // Configure VBAT
+        case BLE_CUST_SVC_MEAS_ALL_CHAR_DATA_HNDL:
+            // Start the measurement, or queue it behind the ongoing one
             if (meas_done)
             {
-                meas_done = false;
-                Snsr_buffer = (rbk_smp290_ble_tmrPrm)BLE_CUST_SVC_MEAS_VBAT_CHAR_DATA_HNDL;
-                static const rbk_smp290_snsr_cfg_Vbat_tst vbat_meas_cfg = {.N_rep     = (uint8_t)SEQ_VBAT_NREP_MEAS,
-                                                                  .t_rep     = SEQ_VBAT_TREP_MEAS,
-                                                                  .osr       = RBK_SMP290_SNSR_OSR_4X,
-                                                                  .Vbat_load = RBK_SMP290_SNSR_VBAT_LOAD_DISABLE};
-                status                                          = rbk_smp290_snsr_meas_and_get_Vbat(&vbat_meas_cfg, &vbat_meas_buff);
+                status = startMeas(handle);
+            }
+            else if (!queueMeas(handle))
+            {
+                smp290_log(LOG_VERBOSITY_WARNING, "Meas queue full\r\n");
+                return BLE_CUST_SVC_MEAS_ERR_BUSY;
+            }
+            else
+            {
+                // Nothing to do
             }
             break;
         default:
@@ -475,19 +842,34 @@ rbk_smp290_ble_atts_err_ten custmeasSvc_wrCallBack(rbk_smp290_ble_attsConnId con
         }
         break;
     }
+    if (RBK_SMP290_SNSR_ERR_BUSY == status)
+    {
+        // The sensor is busy with the sequence, no completion will come for the request: retry it from the queue
+        smp290_log(LOG_VERBOSITY_DEBUG, "Meas request deferred (0x%2X)\r\n", status);
+        if (!queueMeas(handle))
+        {
+            return BLE_CUST_SVC_MEAS_ERR_BUSY;
+        }
+    }
+    else if (RBK_SMP290_SNSR_SUCCESS != status)
+    {
+        failMeas(handle, status);
+    }
+    else
+    {
+        // Nothing to do
+    }
     return RBK_SMP290_BLE_ATTS_SUCCESS;
 }
 
 /**
- * @brief Sends a counter characteristic indication.
- * @details This function increments the indication counter, prepares the indication buffer,
- *          and sends the indication using the BLE stack. If the indication fails, the timer is disabled.
- * @param Evt The event that triggered the indication.
+ * @brief Sends a measurement result.
+ * @details The result is notified or indicated as configured by the client for the characteristic.
+ * @param Evt The handle of the characteristic value.
+ * @param status The status of the measurement.
  */
 static void send_TChar_indication(rbk_smp290_ble_tmrPrm Evt, rbk_smp290_snsr_err_ten status)
 {
-    rbk_smp290_ble_atts_err_ten ret;
-    
     ble_indicnSnsrBuff[0] = status;
 
     meas_res[0] = rbk_smp290_snsr_get_cmpd_T();
@@ -495,24 +877,18 @@ static void send_TChar_indication(rbk_smp290_ble_tmrPrm Evt, rbk_smp290_snsr_err
     ble_indicnSnsrBuff[1] = ((meas_res[0] >> 8) & 0xFF);
     ble_indicnSnsrBuff[2] = (meas_res[0] & 0xFF);
 
-    ret = rbk_smp290_ble_atts_sendIndication((rbk_smp290_ble_attsHndl)Evt, BLE_CUST_SVC_MEAS_CCC_BUFF_SIZE, ble_indicnSnsrBuff);
-    if (ret != RBK_SMP290_BLE_ATTS_SUCCESS)
-    {
-    	smp290_log(LOG_VERBOSITY_WARNING, "T meas indication failed.\r\n");
-    }
+    (void)sendValue(TCcc, (rbk_smp290_ble_attsHndl)Evt, BLE_CUST_SVC_MEAS_CCC_BUFF_SIZE, ble_indicnSnsrBuff);
     meas_done = true;
 }
 
 /**
- * @brief Sends a counter characteristic indication.
- * @details This function increments the indication counter, prepares the indication buffer,
- *          and sends the indication using the BLE stack. If the indication fails, the timer is disabled.
- * @param Evt The event that triggered the indication.
+ * @brief Sends a measurement result.
+ * @details The result is notified or indicated as configured by the client for the characteristic.
+ * @param Evt The handle of the characteristic value.
+ * @param status The status of the measurement.
  */
 static void send_TPAZChar_indication(rbk_smp290_ble_tmrPrm Evt, rbk_smp290_snsr_err_ten status)
 {
-    rbk_smp290_ble_atts_err_ten ret;
-    
     ble_indicnSnsrBuffDouble[0] = status;
 
     meas_res[0] = rbk_smp290_snsr_get_cmpd_T();
@@ -527,24 +903,18 @@ static void send_TPAZChar_indication(rbk_smp290_ble_tmrPrm Evt, rbk_smp290_snsr_
     ble_indicnSnsrBuffDouble[5] = ((meas_res[2] >> 8) & 0xFF);
     ble_indicnSnsrBuffDouble[6] = (meas_res[2] & 0xFF);
 
-    ret = rbk_smp290_ble_atts_sendIndication((rbk_smp290_ble_attsHndl)Evt, BLE_CUST_SVC_MEAS_CCC_BUFF_SIZE_DOUBLE, ble_indicnSnsrBuffDouble);
-    if (ret != RBK_SMP290_BLE_ATTS_SUCCESS)
-    {
-    	smp290_log(LOG_VERBOSITY_WARNING, "TPAZ meas indication failed.\r\n");
-    }
+    (void)sendValue(TPAZCcc, (rbk_smp290_ble_attsHndl)Evt, BLE_CUST_SVC_MEAS_CCC_BUFF_SIZE_DOUBLE, ble_indicnSnsrBuffDouble);
     meas_done = true;
 }
 
 /**
- * @brief Sends a counter characteristic indication.
- * @details This function increments the indication counter, prepares the indication buffer,
- *          and sends the indication using the BLE stack. If the indication fails, the timer is disabled.
- * @param Evt The event that triggered the indication.
+ * @brief Sends a measurement result.
+ * @details The result is notified or indicated as configured by the client for the characteristic.
+ * @param Evt The handle of the characteristic value.
+ * @param status The status of the measurement.
  */
 static void send_TAZAXChar_indication(rbk_smp290_ble_tmrPrm Evt, rbk_smp290_snsr_err_ten status)
 {
-    rbk_smp290_ble_atts_err_ten ret;
-    
     ble_indicnSnsrBuffDouble[0] = status;
 
     meas_res[0] = rbk_smp290_snsr_get_cmpd_T();
@@ -558,37 +928,504 @@ static void send_TAZAXChar_indication(rbk_smp290_ble_tmrPrm Evt, rbk_smp290_snsr
     meas_res[3] = rbk_smp290_snsr_get_cmpd_ax(RBK_SMP290_SNSR_RANGE_HI);
     ble_indicnSnsrBuffDouble[5] = ((meas_res[3] >> 8) & 0xFF);
     ble_indicnSnsrBuffDouble[6] = (meas_res[3] & 0xFF);
-    ret = rbk_smp290_ble_atts_sendIndication((rbk_smp290_ble_attsHndl)Evt, BLE_CUST_SVC_MEAS_CCC_BUFF_SIZE_DOUBLE, ble_indicnSnsrBuffDouble);
-    if (ret != RBK_SMP290_BLE_ATTS_SUCCESS)
-    {
-    	smp290_log(LOG_VERBOSITY_WARNING, "TAZAX meas indication failed.\r\n");
-    }
+    (void)sendValue(TAZAXCcc, (rbk_smp290_ble_attsHndl)Evt, BLE_CUST_SVC_MEAS_CCC_BUFF_SIZE_DOUBLE, ble_indicnSnsrBuffDouble);
     meas_done = true;
 }
 
 /**
- * @brief Sends a counter characteristic indication.
- * @details This function increments the indication counter, prepares the indication buffer,
- *          and sends the indication using the BLE stack. If the indication fails, the timer is disabled.
- * @param Evt The event that triggered the indication.
+ * @brief Sends a measurement result.
+ * @details The result is notified or indicated as configured by the client for the characteristic.
+ * @param Evt The handle of the characteristic value.
+ * @param status The status of the measurement.
  */
 static void send_VBATChar_indication(rbk_smp290_ble_tmrPrm Evt, rbk_smp290_snsr_err_ten status)
 {
-    rbk_smp290_ble_atts_err_ten ret;
-    
     ble_indicnSnsrBuff[0] = status;
     ble_indicnSnsrBuff[1] = ((vbat_meas_buff.Vbat[0] >> 8) & 0xFF);
     ble_indicnSnsrBuff[2] = (vbat_meas_buff.Vbat[0] & 0xFF); 
 
-    ret = rbk_smp290_ble_atts_sendIndication((rbk_smp290_ble_attsHndl)Evt, BLE_CUST_SVC_MEAS_CCC_BUFF_SIZE, ble_indicnSnsrBuff);
+    (void)sendValue(VBATCcc, (rbk_smp290_ble_attsHndl)Evt, BLE_CUST_SVC_MEAS_CCC_BUFF_SIZE, ble_indicnSnsrBuff);
+    meas_done = true;
+}
+
+/**
+ * @brief Sends a value as configured by the client.
+ * @details A notification is preferred: it takes no confirmation round trip, so a value can be
+ *          sent every connection event. The value is indicated only if the client subscribed to
+ *          indications alone, it then needs the delivery to be acknowledged. Nothing is sent if the
+ *          client did not subscribe, the value can still be read.
+ * @param[in]  cccVal   The client characteristic configuration of the characteristic.
+ * @param[in]  hndl     The handle of the characteristic value.
+ * @param[in]  len      The length of the value.
+ * @param[in]  value_p  The value.
+ * @return true if the value was handed to the stack, false otherwise
+ */
+static bool sendValue(rbk_smp290_ble_atts_CccVal_ten cccVal, rbk_smp290_ble_attsHndl hndl, uint16_t len, uint8_t *value_p)
+{
+    rbk_smp290_ble_atts_err_ten ret = RBK_SMP290_BLE_ATTS_SUCCESS;
+    bool sent                       = false;
+
+    if (0u != ((uint16_t)cccVal & (uint16_t)RBK_SMP290_BLE_ATTS_CCC_VAL_NOTIFY))
+    {
+        ret  = rbk_smp290_ble_atts_sendNotification(hndl, len, value_p);
+        sent = (RBK_SMP290_BLE_ATTS_SUCCESS == ret);
+        if (sent)
+        {
+            DlvrNotifyCnt++;
+        }
+    }
+    else if (0u != ((uint16_t)cccVal & (uint16_t)RBK_SMP290_BLE_ATTS_CCC_VAL_INDICN))
+    {
+        ret  = rbk_smp290_ble_atts_sendIndication(hndl, len, value_p);
+        sent = (RBK_SMP290_BLE_ATTS_SUCCESS == ret);
+        if (sent)
+        {
+            DlvrIndicnCnt++;
+        }
+    }
+    else
+    {
+        // Nothing to do
+    }
+
     if (ret != RBK_SMP290_BLE_ATTS_SUCCESS)
     {
-    	smp290_log(LOG_VERBOSITY_WARNING, "T meas indication failed.\r\n");
+        // No buffer left in the stack or an indication still unconfirmed
+        DlvrFailCnt++;
+        smp290_log(LOG_VERBOSITY_WARNING, "Meas value 0x%04X not sent (0x%2X)\r\n", hndl, ret);
     }
-    meas_done = true;
+    return sent;
 }
 
-//void custmeasSvc_procCccEvt(rbk_smp290_ble_atts_CccVal_ten cccVal, rbk_smp290_ble_attsHndl hndl, uint8_t idx)
+/**
+ * @brief Sends the next stream value of the delivery burst.
+ * @details An indicated value is followed by the next one on its confirmation. A notification is
+ *          not confirmed, the next value is sent from the burst timer. A value the stack refuses
+ *          is sent again from the timer.
+ * return     None
+ */
+static void sendBurstValue(void)
+{
+    if (sendValue(StreamCcc, (rbk_smp290_ble_attsHndl)BLE_CUST_SVC_MEAS_STREAM_CHAR_DATA_HNDL, BLE_CUST_SVC_MEAS_STREAM_LEN, StreamCharData))
+    {
+        if (0u != ((uint16_t)StreamCcc & (uint16_t)RBK_SMP290_BLE_ATTS_CCC_VAL_NOTIFY))
+        {
+            DlvrBurst--;
+            if (0u != DlvrBurst)
+            {
+                (void)rbk_smp290_ble_timer_enable_ms(&DlvrTmr, BLE_CUST_SVC_MEAS_DLVR_TMR_INTERVAL);
+            }
+        }
+        else
+        {
+            // Nothing to do, the confirmation of the indication continues the burst
+        }
+    }
+    else if (RBK_SMP290_BLE_ATTS_CCC_VAL_DISAD != StreamCcc)
+    {
+        // Refused by the stack, retry
+        (void)rbk_smp290_ble_timer_enable_ms(&DlvrTmr, BLE_CUST_SVC_MEAS_DLVR_TMR_INTERVAL);
+    }
+    else
+    {
+        // The client did not subscribe, nothing can be delivered
+        DlvrBurst = 0u;
+    }
+}
+
+/**
+ * @brief Delivery burst timer callback.
+ * @param[in]  prm  The timer parameter, not used.
+ * return     None
+ */
+static void dlvrTimerCallback(rbk_smp290_ble_tmrPrm prm)
+{
+    (void)(prm);
+
+    if (0u != DlvrBurst)
+    {
+        sendBurstValue();
+    }
+    else
+    {
+        // Nothing to do
+    }
+}
+
+/**
+ * @brief Starts a conversion of the all channels capture.
+ * @details T is yielded by every conversion, it is not converted on its own.
+ * @param[in]  step  The conversion.
+ * @return the measurement scheduling status
+ */
+static rbk_smp290_snsr_err_ten startAllStep(uint8_t step)
+{
+    rbk_smp290_snsr_err_ten ret;
+
+    switch (step)
+    {
+        case 0u:
+            ret = rbk_smp290_snsr_meas_cmpd_p(RBK_SMP290_SNSR_EN_ENABLE, RBK_SMP290_SNSR_EN_ENABLE);
+            break;
+        case 1u:
+            ret = rbk_smp290_snsr_meas_cmpd_az_ax(RBK_SMP290_SNSR_EN_ENABLE, RBK_SMP290_SNSR_RANGE_LO, RBK_SMP290_SNSR_RANGE_LO);
+            break;
+        case 2u:
+            ret = rbk_smp290_snsr_meas_cmpd_az_ax(RBK_SMP290_SNSR_EN_ENABLE, RBK_SMP290_SNSR_RANGE_HI, RBK_SMP290_SNSR_RANGE_HI);
+            break;
+        default:
+        {
+            static const rbk_smp290_snsr_cfg_Vbat_tst vbat_meas_cfg = {.N_rep     = (uint8_t)SEQ_VBAT_NREP_MEAS,
+                                                                       .t_rep     = SEQ_VBAT_TREP_MEAS,
+                                                                       .osr       = RBK_SMP290_SNSR_OSR_4X,
+                                                                       .Vbat_load = RBK_SMP290_SNSR_VBAT_LOAD_DISABLE};
+            ret = rbk_smp290_snsr_meas_and_get_Vbat(&vbat_meas_cfg, &vbat_meas_buff);
+        }
+        break;
+    }
+    return ret;
+}
+
+/**
+ * @brief Collects a conversion of the all channels capture into its frame.
+ * @param[in]  step  The conversion.
+ * return     None
+ */
+static void collectAllStep(uint8_t step)
+{
+    uint8_t ch;
+
+    switch (step)
+    {
+        case 0u:
+            AllFrame.T_out     = rbk_smp290_snsr_get_cmpd_T();
+            AllFrame.p_out     = rbk_smp290_snsr_get_cmpd_p();
+            AllFrame.Az_hi_out = rbk_smp290_snsr_get_cmpd_az(RBK_SMP290_SNSR_RANGE_HI);
+            AllFrame.fresh |= (uint8_t)(SEQ_CH_BIT(SEQ_CH_T) | SEQ_CH_BIT(SEQ_CH_P) | SEQ_CH_BIT(SEQ_CH_AZ_HI));
+            break;
+        case 1u:
+            AllFrame.T_out     = rbk_smp290_snsr_get_cmpd_T();
+            AllFrame.Az_lo_out = rbk_smp290_snsr_get_cmpd_az(RBK_SMP290_SNSR_RANGE_LO);
+            AllFrame.Ax_lo_out = rbk_smp290_snsr_get_cmpd_ax(RBK_SMP290_SNSR_RANGE_LO);
+            AllFrame.fresh |= (uint8_t)(SEQ_CH_BIT(SEQ_CH_AZ_LO) | SEQ_CH_BIT(SEQ_CH_AX_LO));
+            AllFrame.flags |= SEQ_FLAG_ACC_RANGE_LO;
+            break;
+        case 2u:
+            AllFrame.T_out     = rbk_smp290_snsr_get_cmpd_T();
+            AllFrame.Az_hi_out = rbk_smp290_snsr_get_cmpd_az(RBK_SMP290_SNSR_RANGE_HI);
+            AllFrame.Ax_hi_out = rbk_smp290_snsr_get_cmpd_ax(RBK_SMP290_SNSR_RANGE_HI);
+            AllFrame.fresh |= (uint8_t)(SEQ_CH_BIT(SEQ_CH_AZ_HI) | SEQ_CH_BIT(SEQ_CH_AX_HI));
+            AllFrame.flags |= SEQ_FLAG_ACC_RANGE_HI;
+            break;
+        default:
+            AllFrame.Vbat_out = vbat_meas_buff.Vbat[0];
+            AllFrame.fresh |= SEQ_CH_BIT(SEQ_CH_VBAT);
+            break;
+    }
+
+    for (ch = 0u; ch < (uint8_t)SEQ_CH_MAX; ch++)
+    {
+        if (0u != (AllFrame.fresh & SEQ_CH_BIT(ch)))
+        {
+            AllFrame.age[ch] = 0u;
+        }
+    }
+}
+
+/**
+ * @brief Continues the all channels capture.
+ * @details Collects the completed conversion and starts the next one. Once the last conversion is
+ *          collected, or one failed, the frame is sent as one value as configured by the client.
+ *          The failed conversions are flagged in the error of the frame, their channels are not fresh.
+ * @param Evt The handle of the characteristic value.
+ * @param status The status of the measurement.
+ */
+static void send_AllChar_indication(rbk_smp290_ble_tmrPrm Evt, rbk_smp290_snsr_err_ten status)
+{
+    rbk_smp290_snsr_err_ten ret = status;
+
+    if (RBK_SMP290_SNSR_SUCCESS == ret)
+    {
+        collectAllStep(AllStep);
+        AllStep++;
+        if (AllStep < BLE_CUST_SVC_MEAS_ALL_STEPS)
+        {
+            ret = startAllStep(AllStep);
+            if (RBK_SMP290_SNSR_SUCCESS == ret)
+            {
+                task_setSnsrOwner(SNSR_OWNER_CLIENT);
+            }
+        }
+    }
+
+    if ((RBK_SMP290_SNSR_SUCCESS != ret) || (AllStep >= BLE_CUST_SVC_MEAS_ALL_STEPS))
+    {
+        AllFrame.error |= (uint8_t)ret;
+        AllFrame.frame_counter++;
+        (void)memcpy((void *)AllCharData, (const void *)&AllFrame, sizeof(AllCharData));
+        (void)sendValue(AllCcc, (rbk_smp290_ble_attsHndl)Evt, BLE_CUST_SVC_MEAS_ALL_LEN, AllCharData);
+        meas_done = true;
+    }
+    else
+    {
+        // Nothing to do, the next conversion completes the capture
+    }
+}
+
+/**
+ * @brief Starts a measurement request.
+ * @details The sensor belongs to the request from the acceptance of the conversion by the driver until
+ *          the completion is processed, see \ref task_setSnsrOwner. The request is refused while
+ *          another conversion is in flight or its completion is still pending.
+ * @param[in]  hndl  The handle of the characteristic value of the request.
+ * @return the measurement scheduling status
+ */
+static rbk_smp290_snsr_err_ten startMeas(rbk_smp290_ble_attsHndl hndl)
+{
+    rbk_smp290_snsr_err_ten status = RBK_SMP290_SNSR_SUCCESS;
+
+    if (SNSR_OWNER_NONE != task_getSnsrOwner())
+    {
+        return RBK_SMP290_SNSR_ERR_BUSY;
+    }
+
+    switch (hndl)
+    {
+        case BLE_CUST_SVC_MEAS_T_CHAR_DATA_HNDL:
+            // Configure T
+            status = rbk_smp290_snsr_meas_cmpd_T();
+            break;
+        case BLE_CUST_SVC_MEAS_TPAZ_CHAR_DATA_HNDL:
+            // Configure TPAZ
+            status = rbk_smp290_snsr_meas_cmpd_p(RBK_SMP290_SNSR_EN_ENABLE, RBK_SMP290_SNSR_EN_ENABLE);
+            break;
+        case BLE_CUST_SVC_MEAS_TAZAX_CHAR_DATA_HNDL:
+            // Configure TAZAX
+            status = rbk_smp290_snsr_meas_cmpd_az_ax(RBK_SMP290_SNSR_EN_ENABLE, RBK_SMP290_SNSR_RANGE_HI, RBK_SMP290_SNSR_RANGE_HI);
+            break;
+        case BLE_CUST_SVC_MEAS_VBAT_CHAR_DATA_HNDL:
+        {
+            // Configure VBAT
+            static const rbk_smp290_snsr_cfg_Vbat_tst vbat_meas_cfg = {.N_rep     = (uint8_t)SEQ_VBAT_NREP_MEAS,
+                                                                       .t_rep     = SEQ_VBAT_TREP_MEAS,
+                                                                       .osr       = RBK_SMP290_SNSR_OSR_4X,
+                                                                       .Vbat_load = RBK_SMP290_SNSR_VBAT_LOAD_DISABLE};
+            status = rbk_smp290_snsr_meas_and_get_Vbat(&vbat_meas_cfg, &vbat_meas_buff);
+        }
+        break;
+        default:
+            // Capture all the channels, the conversions are chained on the device
+            (void)memset((void *)&AllFrame, 0, sizeof(AllFrame));
+            (void)memset((void *)AllFrame.age, SEQ_AGE_NEVER, sizeof(AllFrame.age));
+            AllStep = 0u;
+            status  = startAllStep(AllStep);
+            break;
+    }
+
+    if (RBK_SMP290_SNSR_SUCCESS == status)
+    {
+        // The completion belongs to the request
+        task_setSnsrOwner(SNSR_OWNER_CLIENT);
+        meas_done   = false;
+        Snsr_buffer = (rbk_smp290_ble_tmrPrm)hndl;
+    }
+    return status;
+}
+
+/**
+ * @brief Queues a measurement request behind the ongoing one.
+ * @details A request already waiting in the queue is not queued twice, its result serves both.
+ * @param[in]  hndl  The handle of the characteristic value of the request.
+ * @return false if the queue is full, true otherwise
+ */
+static bool queueMeas(rbk_smp290_ble_attsHndl hndl)
+{
+    bool queued = false;
+    uint8_t i;
+
+    for (i = 0u; (i < MeasQueueCnt) && !queued; i++)
+    {
+        queued = (MeasQueue[(MeasQueueHead + i) % BLE_CUST_SVC_MEAS_QUEUE_LEN] == hndl);
+    }
+
+    if (!queued && (MeasQueueCnt < BLE_CUST_SVC_MEAS_QUEUE_LEN))
+    {
+        MeasQueue[(MeasQueueHead + MeasQueueCnt) % BLE_CUST_SVC_MEAS_QUEUE_LEN] = hndl;
+        MeasQueueCnt++;
+        queued = true;
+    }
+    return queued;
+}
+
+/**
+ * @brief Reports a measurement request refused by the driver.
+ * @details Retrying a request the driver refuses for another reason than a busy sensor would
+ *          block the queue. No completion comes for it, the status is sent in the value of its
+ *          characteristic as for a failed conversion.
+ * @param[in]  hndl    The handle of the characteristic value of the request.
+ * @param[in]  status  The scheduling status of the request.
+ */
+static void failMeas(rbk_smp290_ble_attsHndl hndl, rbk_smp290_snsr_err_ten status)
+{
+    smp290_log(LOG_VERBOSITY_WARNING, "Meas request 0x%04X failed (0x%2X)\r\n", hndl, status);
+    custmeasSvc_indication_timer_callback((rbk_smp290_ble_tmrPrm)hndl, status);
+}
+
+/**
+ * @brief Fills the history characteristic value.
+ * @details The value starts with the number of records stored since boot, little endian,
+ *          followed by the encoded history blocks holding the records from the cursor on.
+ *          The blocks are decoded by the client, see history.c.
+ *          The cursor is not moved by the read, so a retried read returns the same records.
+ *          The client acknowledges them by writing the sequence number following the last
+ *          record received, the next read then continues from there.
+ * @param data The characteristic value.
+ * @param len The characteristic value length.
+ */
+static void fillHistChar(uint8_t *data, uint16_t *len)
+{
+    uint32_t total = history_getTotal();
+    uint32_t next;
+    uint16_t blkLen;
+
+    blkLen = history_readBlocks(HistCursor, &data[BLE_CUST_SVC_MEAS_HIST_HDR_LEN],
+                                (uint16_t)(BLE_CUST_SVC_MEAS_HIST_LEN - BLE_CUST_SVC_MEAS_HIST_HDR_LEN), &next);
+
+    data[0] = (uint8_t)(total & 0xFFu);
+    data[1] = (uint8_t)((total >> 8) & 0xFFu);
+    data[2] = (uint8_t)((total >> 16) & 0xFFu);
+    data[3] = (uint8_t)((total >> 24) & 0xFFu);
+
+    *len = (uint16_t)(BLE_CUST_SVC_MEAS_HIST_HDR_LEN + blkLen);
+}
+
+void custmeasSvc_procCccEvt(rbk_smp290_ble_atts_CccVal_ten cccVal, rbk_smp290_ble_attsHndl hndl, uint8_t idx)
+{
+    (void)(idx);
+
+    if (hndl == (rbk_smp290_ble_attsHndl)BLE_CUST_SVC_MEAS_T_CHAR_CCC_HNDL)
+    {
+        TCcc = cccVal;
+    }
+    else if (hndl == (rbk_smp290_ble_attsHndl)BLE_CUST_SVC_MEAS_TPAZ_CHAR_CCC_HNDL)
+    {
+        TPAZCcc = cccVal;
+    }
+    else if (hndl == (rbk_smp290_ble_attsHndl)BLE_CUST_SVC_MEAS_TAZAX_CHAR_CCC_HNDL)
+    {
+        TAZAXCcc = cccVal;
+    }
+    else if (hndl == (rbk_smp290_ble_attsHndl)BLE_CUST_SVC_MEAS_VBAT_CHAR_CCC_HNDL)
+    {
+        VBATCcc = cccVal;
+    }
+    else if (hndl == (rbk_smp290_ble_attsHndl)BLE_CUST_SVC_MEAS_STREAM_CHAR_CCC_HNDL)
+    {
+        StreamCcc = cccVal;
+    }
+    else if (hndl == (rbk_smp290_ble_attsHndl)BLE_CUST_SVC_MEAS_ALL_CHAR_CCC_HNDL)
+    {
+        AllCcc = cccVal;
+    }
+    else
+    {
+        // Nothing to do
+    }
+    smp290_log(LOG_VERBOSITY_INFO, "Meas CCC 0x%04X: %d\r\n", hndl, cccVal);
+}
+
+void custmeasSvc_procValueCnf(rbk_smp290_ble_attsHndl hndl)
+{
+    if ((hndl > (rbk_smp290_ble_attsHndl)BLE_CUST_SVC_MEAS_SVC_HNDL) && (hndl < (rbk_smp290_ble_attsHndl)BLE_CUST_SVC_MEAS_MAX_HNDL))
+    {
+        DlvrCnfCnt++;
+    }
+    else
+    {
+        // Nothing to do
+    }
+
+    if ((hndl == (rbk_smp290_ble_attsHndl)BLE_CUST_SVC_MEAS_STREAM_CHAR_DATA_HNDL) && (0u != DlvrBurst))
+    {
+        DlvrBurst--;
+        if (0u != DlvrBurst)
+        {
+            sendBurstValue();
+        }
+    }
+    else
+    {
+        // Nothing to do
+    }
+}
+
+void custmeasSvc_reset(void)
+{
+    TCcc      = RBK_SMP290_BLE_ATTS_CCC_VAL_DISAD;
+    TPAZCcc   = RBK_SMP290_BLE_ATTS_CCC_VAL_DISAD;
+    TAZAXCcc  = RBK_SMP290_BLE_ATTS_CCC_VAL_DISAD;
+    VBATCcc   = RBK_SMP290_BLE_ATTS_CCC_VAL_DISAD;
+    StreamCcc = RBK_SMP290_BLE_ATTS_CCC_VAL_DISAD;
+    AllCcc    = RBK_SMP290_BLE_ATTS_CCC_VAL_DISAD;
+    DlvrBurst = 0u;
+    (void)rbk_smp290_ble_timer_disable(&DlvrTmr);
+    // The requests of the client are dropped with the connection, the sensor goes back to the sequence
+    MeasQueueHead = 0u;
+    MeasQueueCnt  = 0u;
+    meas_done     = true;
+    if (SNSR_OWNER_CLIENT == task_getSnsrOwner())
+    {
+        task_setSnsrOwner(SNSR_OWNER_NONE);
+    }
+    else
+    {
+        // Nothing to do
+    }
+}
+
+void custmeasSvc_procMeasQueue(void)
+{
+    rbk_smp290_ble_attsHndl hndl;
+    rbk_smp290_snsr_err_ten status;
+    bool busy = false;
+
+    // A refused request is reported and the next one is started, until one is accepted
+    while (meas_done && (0u != MeasQueueCnt) && !busy)
+    {
+        hndl   = MeasQueue[MeasQueueHead];
+        status = startMeas(hndl);
+        busy   = (RBK_SMP290_SNSR_ERR_BUSY == status);
+        if (busy)
+        {
+            // Still busy with the sequence, the request stays at the head until the next completion
+            smp290_log(LOG_VERBOSITY_DEBUG, "Queued meas 0x%04X deferred (0x%2X)\r\n", hndl, status);
+        }
+        else
+        {
+            MeasQueueHead = (uint8_t)((MeasQueueHead + 1u) % BLE_CUST_SVC_MEAS_QUEUE_LEN);
+            MeasQueueCnt--;
+            if (RBK_SMP290_SNSR_SUCCESS != status)
+            {
+                failMeas(hndl, status);
+            }
+        }
+    }
+}
+
+void custmeasSvc_streamFrame(ble_sensorData_tst const *frame_p)
+{
+    (void)memcpy((void *)StreamCharData, (const void *)frame_p, sizeof(StreamCharData));
+
+    // One packed value per cycle, a running burst already paces the stream
+    if (connected && (0u == DlvrBurst))
+    {
+        (void)sendValue(StreamCcc, (rbk_smp290_ble_attsHndl)BLE_CUST_SVC_MEAS_STREAM_CHAR_DATA_HNDL, BLE_CUST_SVC_MEAS_STREAM_LEN, StreamCharData);
+    }
+    else
+    {
+        // Nothing to do
+    }
+}
 
 //void custmeasSvc_indication_confiramtion()
 
@@ -621,6 +1458,11 @@ static void custmeasSvc_indication_timer_callback(rbk_smp290_ble_tmrPrm prm, rbk
         // send indication once the timer expires
         send_VBATChar_indication(prm, status);
     }
+    else if (prm == (rbk_smp290_ble_tmrPrm)BLE_CUST_SVC_MEAS_ALL_CHAR_DATA_HNDL)
+    {
+        // collect the conversion, start the next one or send the frame
+        send_AllChar_indication(prm, status);
+    }
 }
 void addcustmeasSvc()
 {
@@ -628,6 +1470,9 @@ void addcustmeasSvc()
     // Periodic notification timer
     //cntrCharIndicnTmr.prm  = (rbk_smp290_ble_tmrPrm)BLE_CUST_SVC_CNTR_CHAR_DATA_HNDL;
     //(void)rbk_smp290_ble_timer_create(&cntrCharIndicnTmr, custmeasSvc_indication_timer_callback);
+    // Delivery burst timer
+    DlvrTmr.prm = (rbk_smp290_ble_tmrPrm)BLE_CUST_SVC_MEAS_STREAM_CHAR_DATA_HNDL;
+    (void)rbk_smp290_ble_timer_create(&DlvrTmr, dlvrTimerCallback);
     //Set ver default state
     
 }
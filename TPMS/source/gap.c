@@ -9,7 +9,7 @@
  *               The function prints debug messages for certain events.
  *               This file also defines the \a UpdatedConnPrm structure to store the updated connection parameters.
  *               It also performs specific actions based on the event type, such as stopping measurement, resetting application data,
- *               accepting remote connection parameter requests, etc.
+ *               accepting remote connection parameter requests, adjusting the TX power to the RSSI, etc.
  *               - This file provides the necessary constants and types for
  *               configuring the connection parameters of a BLE device, such as the connection
  *               interval, connection latency, supervision timeout, and connection idle
@@ -33,6 +33,7 @@
 
 /* Project includes */
 #include "ble_custSvc.h"
+#include "ble_measSvc.h"
 #include "ble_gpioSvc.h"
 #include "ble_maintSvc.h"
 #include "main.h"
@@ -153,9 +154,10 @@ void rbk_smp290_ble_evtCbk(rbk_smp290_ble_evtTyp_ten evt, void *msg_p)
                 // Set the Connection Parameters
                 (void)rbk_smp290_ble_gap_conn_paramUpdate(&dflConnPrm, dflConnIdlTime);
             }
-            // Stop Measurement
-            sequence_stop();
+            // Streaming mode: the sequence keeps running, every cycle is notified to the client
             connected = true;
+            // Follow the RSSI of the peer with the TX power
+            txpwr_onConnected();
         }
         break;
 
@@ -165,10 +167,11 @@ void rbk_smp290_ble_evtCbk(rbk_smp290_ble_evtTyp_ten evt, void *msg_p)
             (void)(connClosedEvt);
             // Reset the custom service application data
             ble_indicnCntr = 0;
+            custmeasSvc_reset();
             smp290_log(LOG_VERBOSITY_TRACE, "\t\tGAP: Disconnected: Reason: 0X%2X\r\n", connClosedEvt->reason);
-            // Resume the sequence
+            // The sequence kept running, the next frames are advertised again
             connected = false;
-            sequence_resume();
+            txpwr_onDisconnected();
         }
         break;
 
@@ -211,6 +214,14 @@ void rbk_smp290_ble_evtCbk(rbk_smp290_ble_evtTyp_ten evt, void *msg_p)
         break;
 
         case RBK_SMP290_BLE_GAP_READ_RSSI:
+        {
+            const rbk_smp290_ble_readRssiEvt_tst *rssiEvt = (const rbk_smp290_ble_readRssiEvt_tst *)msg_p;
+
+            smp290_log(LOG_VERBOSITY_TRACE, "\t\tGAP: RSSI: %d dBm\r\n", rssiEvt->rssi);
+            // Adjust the TX power to the link
+            txpwr_onRssi(rssiEvt->rssi);
+        }
+        break;
 
         case RBK_SMP290_BLE_GAP_READ_RMT_FEAT:
 
@@ -50,6 +50,8 @@ typedef enum
     BLE_CUST_SVC_MEAS_TPAZ_CHAR_CCC_IDX,
     BLE_CUST_SVC_MEAS_TAZAX_CHAR_CCC_IDX,
     BLE_CUST_SVC_MEAS_VBAT_CHAR_CCC_IDX,
+    BLE_CUST_SVC_MEAS_STREAM_CHAR_CCC_IDX,
+    BLE_CUST_SVC_MEAS_ALL_CHAR_CCC_IDX,
     BLE_PROF_MAX_CCC_IDX
 } rbk_smp290_prof_CccIdx_ten;
 
@@ -72,24 +74,34 @@ rbk_smp290_ble_attsCccCfg_tst rbk_smp290_prof_CccCfg[BLE_PROF_MAX_CCC_IDX] = {
     },
     {
         (rbk_smp290_ble_attsHndl)BLE_CUST_SVC_MEAS_T_CHAR_CCC_HNDL,  // cccd handle
-        (uint16_t)RBK_SMP290_BLE_ATTS_CCC_VAL_INDICN,             // cccCfg
+        ((uint16_t)RBK_SMP290_BLE_ATTS_CCC_VAL_NOTIFY | (uint16_t)RBK_SMP290_BLE_ATTS_CCC_VAL_INDICN),  // cccCfg
         RBK_SMP290_BLE_ATTS_SEC_LEVEL_NONE                         // security level
     },
     {
         (rbk_smp290_ble_attsHndl)BLE_CUST_SVC_MEAS_TPAZ_CHAR_CCC_HNDL,  // cccd handle
-        (uint16_t)RBK_SMP290_BLE_ATTS_CCC_VAL_INDICN,             // cccCfg
+        ((uint16_t)RBK_SMP290_BLE_ATTS_CCC_VAL_NOTIFY | (uint16_t)RBK_SMP290_BLE_ATTS_CCC_VAL_INDICN),  // cccCfg
         RBK_SMP290_BLE_ATTS_SEC_LEVEL_NONE                         // security level
     },
     {
         (rbk_smp290_ble_attsHndl)BLE_CUST_SVC_MEAS_TAZAX_CHAR_CCC_HNDL,  // cccd handle
-        (uint16_t)RBK_SMP290_BLE_ATTS_CCC_VAL_INDICN,             // cccCfg
+        ((uint16_t)RBK_SMP290_BLE_ATTS_CCC_VAL_NOTIFY | (uint16_t)RBK_SMP290_BLE_ATTS_CCC_VAL_INDICN),  // cccCfg
         RBK_SMP290_BLE_ATTS_SEC_LEVEL_NONE                         // security level
     },
     {
         (rbk_smp290_ble_attsHndl)BLE_CUST_SVC_MEAS_VBAT_CHAR_CCC_HNDL,  // cccd handle
-        (uint16_t)RBK_SMP290_BLE_ATTS_CCC_VAL_INDICN,             // cccCfg
+        ((uint16_t)RBK_SMP290_BLE_ATTS_CCC_VAL_NOTIFY | (uint16_t)RBK_SMP290_BLE_ATTS_CCC_VAL_INDICN),  // cccCfg
         RBK_SMP290_BLE_ATTS_SEC_LEVEL_NONE                         // security level
     },
+    {
+        (rbk_smp290_ble_attsHndl)BLE_CUST_SVC_MEAS_STREAM_CHAR_CCC_HNDL,  // cccd handle
+        ((uint16_t)RBK_SMP290_BLE_ATTS_CCC_VAL_NOTIFY | (uint16_t)RBK_SMP290_BLE_ATTS_CCC_VAL_INDICN),  // cccCfg
+        RBK_SMP290_BLE_ATTS_SEC_LEVEL_NONE                                // security level
+    },
+    {
+        (rbk_smp290_ble_attsHndl)BLE_CUST_SVC_MEAS_ALL_CHAR_CCC_HNDL,  // cccd handle
+        ((uint16_t)RBK_SMP290_BLE_ATTS_CCC_VAL_NOTIFY | (uint16_t)RBK_SMP290_BLE_ATTS_CCC_VAL_INDICN),  // cccCfg
+        RBK_SMP290_BLE_ATTS_SEC_LEVEL_NONE                             // security level
+    },
     
 };
 /// @}
@@ -143,6 +155,10 @@ void rbk_smp290_ble_atts_attrEvtCbk(rbk_smp290_ble_atts_evt_ten attsEvt, void *p
             {
                 custSvc_procCccEvt(cccEvt->value, cccEvt->handle, cccEvt->idx);
             }
+            else if ((cccEvt->idx >= (uint8_t)BLE_CUST_SVC_MEAS_T_CHAR_CCC_IDX) && (cccEvt->idx <= (uint8_t)BLE_CUST_SVC_MEAS_ALL_CHAR_CCC_IDX))
+            {
+                custmeasSvc_procCccEvt(cccEvt->value, cccEvt->handle, cccEvt->idx);
+            }
             
         }
         break;
@@ -152,7 +168,7 @@ void rbk_smp290_ble_atts_attrEvtCbk(rbk_smp290_ble_atts_evt_ten attsEvt, void *p
         {
             msg_p = (rbk_smp290_ble_attsEvt_tst *)pAttMsg;
             //smp290_log(LOG_VERBOSITY_INFO, "\t\tGATT: Handle value confirmation received: status:%d\r\n", msg_p->status);
-            (void)(msg_p);
+            custmeasSvc_procValueCnf(msg_p->handle);
             uint16_t ret = rbk_smp290_ble_atts_getCccdVal((uint8_t)BLE_CUST_SVC_CNTR_CHAR_CCC_IDX);
             //uint16_t ret1 = rbk_smp290_ble_atts_getCccdVal((uint8_t)BLE_CUST_SVC_MAINT_TP_SLFTST_CHAR_CCC_IDX);
 
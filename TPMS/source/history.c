@@ -0,0 +1,225 @@
+/**
+ * @addtogroup   measure_advertise_conn
+ * @{
+ * @file         history.c
+ * @brief        This file contains the sample history of the project \ref measure_advertise_conn.
+ * @details      The history module keeps the last samples of the sequence in a ring of blocks
+ *               located in the retained RAM, so it survives the sleep phases of the SMP290.
+ *               One record is stored per cycle with fresh pressure. Every record gets a
+ *               sequence number which keeps counting when the oldest blocks are overwritten,
+ *               so a reader downloading the history over \glos{GATT} detects lost records.
+ *               Consecutive samples differ by a few LSB, so the records are encoded as deltas:
+ *               each block starts with a plain record in its header, the following records
+ *               are stored as zigzag varints of
+ *               - the change of the time step since the previous record (delta-of-delta),
+ *               - the pressure delta,
+ *               - the temperature delta shifted left by one, the low bit telling that the
+ *                 flags and error bytes of the record follow as they are.
+ *               A varint holds 7 bits per byte, least significant first, the high bit of a
+ *               byte telling that another byte follows. A steady record takes 3 bytes
+ *               instead of 10, every block decodes on its own.
+ * @copyright    (c) [Robert Bosch GmbH] [2024].
+ *               All rights reserved, also regarding any disposal,
+ *               exploitation, reproduction, editing, distribution, as well
+ *               as in the event of applications for industrial property
+ *               rights. The communication of its contents to others without
+ *               express authorization is prohibited. Offenders will be held
+ *               liable for the payment of damages. All rights reserved in
+ *               the event of the grant of a patent, utility model or design.
+ **/
+
+/* System includes */
+#include <string.h>
+
+/* Library includes */
+#include "rbk_smp290_types.h"
+
+/* Project includes */
+#include "main.h"
+
+/// @addtogroup measure_advertise_conn_hist_cfg Sample history configuration definitions
+/// @{
+
+/******************************************************************************\
+ *  Global variables
+\******************************************************************************/
+
+/// Ring of the blocks
+SECTION_PERSISTENT static hist_block_tst history_blocks[HISTORY_NUM_BLOCKS];
+
+/// Index of the block being filled
+SECTION_PERSISTENT static uint8_t history_head = 0u;
+
+/// Number of blocks in use
+SECTION_PERSISTENT static uint8_t history_numBlocks = 0u;
+
+/// Number of records stored since boot, i.e. sequence number of the next record
+SECTION_PERSISTENT static uint32_t history_total = 0u;
+
+/// Last record stored, reference of the deltas
+SECTION_PERSISTENT static hist_record_tst history_prev;
+
+/// Time step between the last two records of the block [ms]
+SECTION_PERSISTENT static int32_t history_prevDt_ms = 0;
+
+/// @}
+
+/******************************************************************************\
+ *  Functions declarations
+\******************************************************************************/
+
+/**
+ * @brief      Writes a signed value as a zigzag varint.
+ * @param[in]  val    The value.
+ * @param[out] dst_p  The destination.
+ * @return     The number of bytes written
+ */
+static uint8_t putVarint(int32_t val, uint8_t *dst_p)
+{
+    // Zigzag: small magnitudes of both signs get small codes
+    uint32_t zz = ((uint32_t)val << 1) ^ (uint32_t)(val >> 31);
+    uint8_t n   = 0u;
+
+    while (zz >= 0x80u)
+    {
+        dst_p[n++] = (uint8_t)(zz | 0x80u);
+        zz >>= 7;
+    }
+    dst_p[n++] = (uint8_t)zz;
+    return n;
+}
+
+/**
+ * @brief      Encodes a record relative to the previous one.
+ * @param[in]  rec_p      The record.
+ * @param[in]  prev_p     The previous record.
+ * @param[in]  prevDt_ms  The time step between the previous record and the one before it.
+ * @param[out] dst_p      The destination, at least \ref HISTORY_ENC_MAX_LEN bytes.
+ * @return     The number of bytes written
+ */
+static uint8_t encodeRecord(hist_record_tst const *rec_p, hist_record_tst const *prev_p, int32_t prevDt_ms, uint8_t *dst_p)
+{
+    int32_t dt_ms = (int32_t)(rec_p->time_ms - prev_p->time_ms);
+    bool aux      = (rec_p->flags != prev_p->flags) || (rec_p->error != prev_p->error);
+    uint8_t n     = 0u;
+
+    n += putVarint(dt_ms - prevDt_ms, &dst_p[n]);
+    n += putVarint((int32_t)rec_p->p_out - (int32_t)prev_p->p_out, &dst_p[n]);
+    n += putVarint((((int32_t)rec_p->T_out - (int32_t)prev_p->T_out) * 2) + (aux ? 1 : 0), &dst_p[n]);
+
+    if (aux)
+    {
+        dst_p[n++] = rec_p->flags;
+        dst_p[n++] = rec_p->error;
+    }
+    return n;
+}
+
+/**
+ * @brief      Starts a new block with a record.
+ * @details    The oldest block is overwritten when all blocks are in use.
+ * @param[in]  rec_p  The first record of the block.
+ * return     None
+ */
+static void openBlock(hist_record_tst const *rec_p)
+{
+    hist_blockHdr_tst *hdr_p;
+
+    if (0u != history_numBlocks)
+    {
+        history_head = (uint8_t)((history_head + 1u) % HISTORY_NUM_BLOCKS);
+    }
+    if (history_numBlocks < HISTORY_NUM_BLOCKS)
+    {
+        history_numBlocks++;
+    }
+
+    hdr_p        = &history_blocks[history_head].hdr;
+    hdr_p->seq   = history_total;
+    hdr_p->first = *rec_p;
+    hdr_p->count = 1u;
+    hdr_p->len   = 0u;
+
+    // The deltas restart in every block
+    history_prevDt_ms = 0;
+}
+
+// Stores a frame in the history.
+void history_add(ble_sensorData_tst const *frame_p, uint32_t now_ms)
+{
+    hist_block_tst *blk_p = &history_blocks[history_head];
+    uint8_t enc[HISTORY_ENC_MAX_LEN];
+    hist_record_tst rec;
+    uint8_t n;
+
+    rec.time_ms = now_ms;
+    rec.p_out   = frame_p->p_out;
+    rec.T_out   = frame_p->T_out;
+    rec.flags   = frame_p->flags;
+    rec.error   = frame_p->error;
+
+    if (0u == history_numBlocks)
+    {
+        openBlock(&rec);
+    }
+    else
+    {
+        n = encodeRecord(&rec, &history_prev, history_prevDt_ms, enc);
+
+        if (((uint32_t)blk_p->hdr.len + n) > sizeof(blk_p->data))
+        {
+            // Block full: the record starts the next one
+            openBlock(&rec);
+        }
+        else
+        {
+            (void)memcpy(&blk_p->data[blk_p->hdr.len], enc, n);
+            blk_p->hdr.len += n;
+            blk_p->hdr.count++;
+            history_prevDt_ms = (int32_t)(rec.time_ms - history_prev.time_ms);
+        }
+    }
+
+    history_prev = rec;
+    history_total++;
+}
+
+// Reads encoded blocks from the history.
+uint16_t history_readBlocks(uint32_t from, uint8_t *dst_p, uint16_t maxLen, uint32_t *next_p)
+{
+    uint16_t len = 0u;
+    uint8_t i;
+
+    *next_p = from;
+
+    // From the oldest block to the newest one
+    for (i = 0u; i < history_numBlocks; i++)
+    {
+        hist_block_tst const *blk_p = &history_blocks[(history_head + HISTORY_NUM_BLOCKS + 1u - history_numBlocks + i) % HISTORY_NUM_BLOCKS];
+        uint16_t blkLen             = (uint16_t)(sizeof(hist_blockHdr_tst) + blk_p->hdr.len);
+
+        if ((blk_p->hdr.seq + blk_p->hdr.count) <= from)
+        {
+            // Already read
+        }
+        else if ((len + blkLen) > maxLen)
+        {
+            break;
+        }
+        else
+        {
+            (void)memcpy(&dst_p[len], blk_p, blkLen);
+            len += blkLen;
+            *next_p = blk_p->hdr.seq + blk_p->hdr.count;
+        }
+    }
+    return len;
+}
+
+// Returns the number of records stored since boot.
+uint32_t history_getTotal(void)
+{
+    return history_total;
+}
+
+/** @} */
@@ -26,8 +26,8 @@
  *   + Creates Task1.
  *   + Task1 \b Q_ENTRY_SIG event performs the \glos{GATT} and sequence initializations.
  *     * The \glos{GATT} initialization performs performs the setup of the attribute server and the services.
- *     * The sequence initialization creates a periodic timer. This timer triggers Task1 every \b SEQ_UPDATE_PERIOD_US [us]
- *       when the sequence is resumed.
+ *     * The sequence initialization creates the sequence timer. The timer is a one-shot, armed for the first due step
+ *       when the sequence is resumed, then by every step for the next due one.
  *   + \ref rbk_smp290_ble_evtCbk receives the event \ref RBK_SMP290_BLE_STACK_INITIALIZED when the internal BLE initialization
  *     is done. It then initializes  BLE advertisement.
  *      * The advertisement type is \ref RBK_SMP290_BLE_ADV_CONN_UNDIRECT
@@ -50,31 +50,80 @@
  *      Task1=>Task1 [label="sequence_run", URL="\ref sequence_run"];
  *     @endmsc
  *
- *   + On every trigger of Task1 by the sequence timer through \b SIG_TIMER_TICK, Task1 runs the sequence logic.
- *     The sequence steps are as follows:
- *     * [  0 ms] Measure T.
+ *   + On every trigger of Task1 by the sequence timer through \b SIG_TIMER_TICK, Task1 runs the step the timer was
+ *     armed for and arms it for the next due step. A cycle lasts 30 s while parked, 1 s while driving and 250 ms in
+ *     transition. The SMP290 wakes up only for the steps due in the cycle and sleeps from the last one to the first
+ *     step of the next cycle. The steps of the full plan, run while parked and driving, are as follows:
+ *     * [  0 ms] Measure T (every 5th cycle). Dropped by the plan optimizer since Tpaz yields T.
  *     * [100 ms] Measure Tpaz.
- *     * [200 ms] Measure Tazax Low.
- *     * [300 ms] Measure Tazax High.
- *     * [400 ms] Measure Vbat.
- *     * [500 ms] Adv. data.
- *     * [600 ms] Do nothing.
- *     * [700 ms] Do nothing.
- *     * [800 ms] Do nothing.
- *     * [900 ms] Do nothing.
+ *     * [200 ms] Measure Tazax Low, unless the acceleration is in the high range only.
+ *     * [300 ms] Measure Tazax High, unless the acceleration is in the low range only.
+ *     * [400 ms] Measure Vbat (every 60th cycle).
+ *     * [500 ms] Adv. data, if p or T moved by more than the configured delta or the heartbeat period elapsed.
+ *
+ *     A driving cycle thus takes 4 wakeups with both accelerometer ranges and 3 with one, plus the Vbat one every
+ *     60th cycle. In transition, the pressure plan measures Tpaz at 0 ms and runs the Adv. step at 100 ms.
+ *   + Channels which are not measured in a cycle keep their last value in the frame, the \b fresh field
+ *     flags the channels measured in the cycle and the \b age field counts the cycles since each channel was
+ *     last measured.
+ *   + Once per cycle, the motion detection classifies the wheel as parked, driving or in transition from
+ *     the acceleration and selects the cycle length (30 s, 1 s, 250 ms) and the advertising cadence.
+ *   + Every pressure sample is checked for a rapid deflation. A deflating sample raises the sampling rate at
+ *     once, cutting the ongoing cycle, e.g. a 30 s parked one, to the 250 ms of the transition profile; once
+ *     the deflation is confirmed, the frame is advertised at once with the alarm flag, without waiting for
+ *     the Adv. slot. The latency of the last alarm and the maximum one are read from the measurement service.
+ *   + The advertising interval and duration follow a policy per operating state: sparse bursts while parked,
+ *     short dense bursts for the alarm frames, and connectable bursts only while the maintenance flag is set.
+ *     Every burst ends before the next cycle of its state. The settings of every state and the maintenance flag
+ *     are configured over \glos{GATT}, the radio-on time of every state in the last hour is read from the custom
+ *     service.
+ *   + In the broadcast mode, the sensor frames are advertised as ADV_NONCONN_IND, without a receive window after
+ *     every PDU. A connectable window is opened every configured period, a period of 0 is refused.
+ *   + The TX power is kept at the lowest level closing the link budget with a configurable margin: while connected
+ *     from the RSSI of the peer read every second, while unconnected from a link hint written by a gateway: the RSSI
+ *     of the advertisements and the TX power level they were sent at. The configured TX power is the maximum level.
+ *   + The configuration written over \glos{GATT} is applied at once and written to \glos{NVM} from the task, a
+ *     few seconds after the first change, coalescing the changes in between. The items are appended as records
+ *     with a CRC to a log across a ring of pages, a full page is compacted into the next one, and an index built
+ *     at boot locates the last record of every item. The erases and writes are counted.
+ *   + While a client is connected, the sequence keeps running: nothing is advertised, the frame of every cycle is
+ *     sent as one notification of the Stream characteristic of the measurement service. A measurement requested by
+ *     the client takes the sensor, the steps of the sequence due meanwhile are skipped.
+ *   + The results of the measurement service are notified or indicated as subscribed by the client per
+ *     characteristic, a notification is preferred as it takes no confirmation round trip. The deliveries are
+ *     counted, a burst of stream values written to the Delivery characteristic measures the throughput of the link.
+ *     The indicated values of the burst are paced by their confirmations, the notified ones by a timer.
+ *   + A write to the All characteristic captures every channel in one request: the TpAz, TAzAx low, TAzAx high
+ *     and Vbat conversions are chained on the device and the frame is returned as one value.
+ *   + The measurement requests written while a measurement runs are queued, a request already queued is not queued
+ *     twice, and started one after the other from the completions. A request the sensor rejects while busy with the
+ *     sequence stays queued and is retried on the next completion. A request is refused with a busy error when the
+ *     queue is full.
+ *   + Every cycle with fresh pressure is also logged in a history kept in the retained RAM. The history can be
+ *     downloaded over \glos{GATT} from the History characteristic of the measurement service. A read does not move
+ *     the download cursor, the client moves it by writing the sequence number following the last record received.
  *   + It then loops back to the beginning. This is illustrated in the following sequence diagram:
  *     @ref_image{measure_advertise_conn_sequence.svg}
  *   + The SMP290 then goes to sleep to perform the measurement. After every measurement scheduling, the SMP290 transitions
  *     to sleep to acquire the requested samples, then wakes up from sleep and notifies Task1 through the initialization callback
  *     \b entry_snsrClbk.
  *   + Task1 then gets the measurement done event, captures the measurement status, and gets the measurement values.
- *   + When all the measurements are done, the advertising Data frame is constructed and then sent over the configured \glos{BLE}
- *     advertising. The Advertisement data is constructed as follows:
+ *     The completion is routed to the owner of the conversion, the sequence or the client, recorded once the sensor
+ *     driver accepted the conversion. For a measurement requested over \glos{GATT}, the backup, the sensor read and
+ *     the notification run in Task1 as well, not in the sensor driver callback. No conversion is started before the
+ *     pending completion is processed.
+ *   + The measurements are written in place into the sensor data window of triple buffered frames.
+ *     When all the measurements are done, the frame is committed and then sent over the configured \glos{BLE}
+ *     advertising in a compact format: a format byte, the frame counter and flags, the pressure in 12 bits and the
+ *     temperature in 8 bits, then only the measured accelerometer range, the battery voltage when measured and the
+ *     error when set. The batch format appends the frame counter, pressure and temperature of the last advertised
+ *     frames, as many as fit the 31 bytes of a legacy PDU. The Advertisement data is constructed as follows:
  *     @ref_image{measure_advertise_advData.svg}
  *     @note To translate the sensor values into physical values, you can refer to the SMP290 datasheet.
  *
- *   + When the device receives a SCAN_REQ, it answers with a Scan Response. The Scan Response data
- *     is constructed as follows:
+ *   + When the device receives a SCAN_REQ, it answers with a Scan Response carrying the device information: the
+ *     firmware and hardware versions, the active sampling profile and the last battery voltage, cached in \glos{NVM}
+ *     across resets. A gateway builds its inventory without connecting. The Scan Response data is constructed as follows:
  *     @ref_image{measure_advertise_conn_scanrsp_data.svg}
  *   + The project uses the following services and characteristics in a profile:
  *     * The Generic Access Service (GAP Service):
@@ -96,7 +145,12 @@
  *  @include measure_advertise_conn/source/main.c
  *  @include measure_advertise_conn/source/task.c
  *  @include measure_advertise_conn/source/sequence.c
+ *  @include measure_advertise_conn/source/motion.c
+ *  @include measure_advertise_conn/source/alarm.c
+ *  @include measure_advertise_conn/source/history.c
  *  @include measure_advertise_conn/source/adv.c
+ *  @include measure_advertise_conn/source/txpwr.c
+ *  @include measure_advertise_conn/source/nvm.c
  *  @include measure_advertise_conn/source/gap.c
  *  @include measure_advertise_conn/source/gatt.c
  *  @include measure_advertise_conn/source/ble_gapSvc.c
@@ -0,0 +1,224 @@
+/**
+ * @addtogroup   measure_advertise_conn
+ * @{
+ * @file         motion.c
+ * @brief        This file contains the motion detection of the project \ref measure_advertise_conn.
+ * @details      The motion module classifies the state of the wheel from the centripetal
+ *               acceleration measured by the sequence and selects the sampling profile:
+ *               a low-rate profile while the car is parked, a normal profile while it is
+ *               driving and a high-rate profile while it is starting or stopping.
+ *               The switching uses two thresholds and consecutive sample counts as
+ *               hysteresis, so a single noisy sample does not change the profile.
+ *               Other modules can hold the high-rate profile, e.g. during a deflation alarm.
+ * @copyright    (c) [Robert Bosch GmbH] [2024].
+ *               All rights reserved, also regarding any disposal,
+ *               exploitation, reproduction, editing, distribution, as well
+ *               as in the event of applications for industrial property
+ *               rights. The communication of its contents to others without
+ *               express authorization is prohibited. Offenders will be held
+ *               liable for the payment of damages. All rights reserved in
+ *               the event of the grant of a patent, utility model or design.
+ **/
+
+/* System includes */
+#include <stdlib.h>
+
+/* Library includes */
+#include "rbk_smp290_types.h"
+
+/* Project includes */
+#include "main.h"
+
+/// @addtogroup measure_advertise_conn_motion_cfg Motion detection configuration definitions
+/// @{
+
+/******************************************************************************\
+ *  Constants
+ \******************************************************************************/
+
+/// Acceleration above which the wheel is rotating [LSB of the high range, ~0.94 g]
+#define MOTION_MOVING_THLD_LSB 6
+
+/// Acceleration below which the wheel is standing still [LSB of the high range, ~0.94 g]
+#define MOTION_STILL_THLD_LSB 3
+
+/// Consecutive moving samples to confirm driving from the transition profile
+#define MOTION_DRIVING_CONFIRM_CNT 4u
+
+/// Consecutive still samples to leave the driving profile
+#define MOTION_DRIVING_EXIT_CNT 30u
+
+/// Consecutive still samples to confirm parking from the transition profile
+#define MOTION_PARKED_CONFIRM_CNT 20u
+
+/*******************************************************************************
+ *  Types
+ ******************************************************************************/
+
+/// Sampling parameters of a profile
+typedef struct
+{
+    seq_planId_ten plan;  //!< Measurement plan of the profile
+    uint32_t cycle_ms;    //!< Cycle length of the profile [ms]
+} motion_profileCfg_tst;
+
+/******************************************************************************\
+ *  Global variables
+\******************************************************************************/
+
+/// Sampling parameters, indexed by \ref motion_profile_ten
+static const motion_profileCfg_tst motion_profileCfg[MOTION_PROFILE_MAX] = {
+    [MOTION_PROFILE_PARKED]     = {SEQ_PLAN_FULL, 30000u},
+    [MOTION_PROFILE_DRIVING]    = {SEQ_PLAN_FULL, 1000u},
+    [MOTION_PROFILE_TRANSITION] = {SEQ_PLAN_PRESSURE, 250u},
+};
+
+/// Active profile
+SECTION_PERSISTENT static motion_profile_ten motion_profile = MOTION_PROFILE_DRIVING;
+
+/// Number of consecutive moving samples
+SECTION_PERSISTENT static uint8_t motion_movingCnt = 0u;
+
+/// Number of consecutive still samples
+SECTION_PERSISTENT static uint8_t motion_stillCnt = 0u;
+
+/// Is the high rate profile held, e.g. by the deflation alarm
+SECTION_PERSISTENT static bool motion_held = false;
+
+/// @}
+
+/******************************************************************************\
+ *  Functions declarations
+\******************************************************************************/
+
+/**
+ * @brief      Activates a profile.
+ * @details    The plan and the cycle length of the profile are requested from the
+ *             sequence, they become active at the start of the next cycle.
+ * @param[in]  profile  The profile to activate.
+ * return     None
+ */
+static void setProfile(motion_profile_ten profile)
+{
+    motion_profile   = profile;
+    motion_movingCnt = 0u;
+    motion_stillCnt  = 0u;
+
+    sequence_selectPlan(motion_profileCfg[profile].plan);
+    sequence_setCycle(motion_profileCfg[profile].cycle_ms);
+    smp290_log(LOG_VERBOSITY_DEBUG, "\tMotion profile: %d\r\n", profile);
+}
+
+/**
+ * @brief      Switches the profile from the sample counters.
+ * return     None
+ */
+static void classify(void)
+{
+    switch (motion_profile)
+    {
+        case MOTION_PROFILE_PARKED:
+        {
+            // Samples are rare while parked, react on the first moving sample
+            if (0u != motion_movingCnt)
+            {
+                setProfile(MOTION_PROFILE_TRANSITION);
+            }
+        }
+        break;
+
+        case MOTION_PROFILE_DRIVING:
+        {
+            if (motion_stillCnt >= MOTION_DRIVING_EXIT_CNT)
+            {
+                setProfile(MOTION_PROFILE_TRANSITION);
+            }
+        }
+        break;
+
+        case MOTION_PROFILE_TRANSITION:
+        {
+            if (motion_movingCnt >= MOTION_DRIVING_CONFIRM_CNT)
+            {
+                setProfile(MOTION_PROFILE_DRIVING);
+            }
+            else if (motion_stillCnt >= MOTION_PARKED_CONFIRM_CNT)
+            {
+                setProfile(MOTION_PROFILE_PARKED);
+            }
+            else
+            {
+                // Nothing to do
+            }
+        }
+        break;
+
+        default:
+        {
+            // Nothing to do
+        }
+        break;
+    }
+}
+
+// Initializes the motion detection.
+void motion_init(void)
+{
+    motion_held = false;
+    setProfile(MOTION_PROFILE_DRIVING);
+}
+
+// Updates the motion detection with a new acceleration sample.
+void motion_update(int16_t Az_hi)
+{
+    // Only the centripetal acceleration is used: Ax is not measured in every plan
+    int32_t acc = abs((int32_t)Az_hi);
+
+    // Count consecutive samples, samples between the thresholds reset both counters
+    if (acc >= MOTION_MOVING_THLD_LSB)
+    {
+        motion_movingCnt = (motion_movingCnt < UINT8_MAX) ? (motion_movingCnt + 1u) : UINT8_MAX;
+        motion_stillCnt  = 0u;
+    }
+    else if (acc < MOTION_STILL_THLD_LSB)
+    {
+        motion_stillCnt  = (motion_stillCnt < UINT8_MAX) ? (motion_stillCnt + 1u) : UINT8_MAX;
+        motion_movingCnt = 0u;
+    }
+    else
+    {
+        motion_movingCnt = 0u;
+        motion_stillCnt  = 0u;
+    }
+
+    // The classification is frozen while the profile is held
+    if (!motion_held)
+    {
+        classify();
+    }
+}
+
+// Holds or releases the high rate profile.
+void motion_hold(bool hold)
+{
+    if (hold && !motion_held)
+    {
+        setProfile(MOTION_PROFILE_TRANSITION);
+    }
+    // On release, the classification resumes from the transition profile
+    motion_held = hold;
+}
+
+// Returns the active profile.
+motion_profile_ten motion_getProfile(void)
+{
+    return motion_profile;
+}
+
+// Returns the cycle length of a profile.
+uint32_t motion_getCycle(motion_profile_ten profile)
+{
+    return motion_profileCfg[(profile < MOTION_PROFILE_MAX) ? profile : MOTION_PROFILE_DRIVING].cycle_ms;
+}
+
+/** @} */
@@ -0,0 +1,699 @@
+/**
+ * @addtogroup   measure_advertise_conn
+ * @{
+ * @file         nvm.c
+ * @brief        This file contains the configuration store of the project \ref measure_advertise_conn.
+ * @details      The configuration items are stored as records appended to a log across a ring of
+ *               \glos{NVM} pages. A record holds the key of the item, the length of the value, the
+ *               value and a CRC-16/CCITT, padded to whole \glos{NVM} words. Every page starts with a
+ *               header word: a magic and the sequence number of the page. Only the last record of an
+ *               item is live, an index in RAM holds its address, so the items are read in O(1).
+ *               - When the page being written is full, the next page is erased and becomes the new
+ *                 one, then the live records of the oldest page are copied into it. The page after the
+ *                 one being written never holds a live record, so it can always be erased.
+ *               - At boot, the index is built by replaying the pages from the oldest to the newest. A
+ *                 record with a wrong CRC, e.g. torn by a reset, is skipped. A compaction interrupted
+ *                 by a reset is completed.
+ *               - The store is formatted in the page holding no former fixed word. The words are
+ *                 taken over as long as their page is not a page of the store yet, so a takeover
+ *                 interrupted by a reset is completed at the next boot.
+ *               The configuration is applied at once in RAM and only marked dirty for the \glos{NVM}.
+ *               The first change arms a debounce timer, the changes until it expires are coalesced
+ *               into one record per item, from the task and not from the \glos{ATT} callbacks. An item
+ *               whose last record already holds the value is not written.
+ *               The erases and written words are counted for the wear monitoring.
+ * @copyright    (c) [Robert Bosch GmbH] [2024].
+ *               All rights reserved, also regarding any disposal,
+ *               exploitation, reproduction, editing, distribution, as well
+ *               as in the event of applications for industrial property
+ *               rights. The communication of its contents to others without
+ *               express authorization is prohibited. Offenders will be held
+ *               liable for the payment of damages. All rights reserved in
+ *               the event of the grant of a patent, utility model or design.
+ **/
+
+/* System includes */
+#include <stdint.h>
+#include <string.h>
+
+/* Library includes */
+#include "rbk_smp290_nvm.h"
+#include "rbk_smp290_timer.h"
+#include "rbk_smp290_tsd.h"
+#include "rbk_smp290_types.h"
+
+/* Project includes */
+#include "main.h"
+
+/// @addtogroup measure_advertise_conn_nvm_cfg Configuration store definitions
+/// @{
+
+/******************************************************************************\
+ *  Constants
+ \******************************************************************************/
+
+/// Delay from the first change to the flush [ms], the changes within it are coalesced
+#define NVM_FLUSH_DELAY_MS 5000u
+
+/// Address of the first page of the store in \glos{NVM}, the pages of the former fixed words
+#define NVM_KV_BASE_ADR NVM_APP_PAGE_ADR(0u)
+
+/// Size of a page [bytes], the unit of the erase
+#define NVM_KV_PAGE_SIZE NVM_APP_PAGE_SIZE
+
+/// Number of pages of the store, the one after the page being written is kept free
+#define NVM_KV_NUM_PAGES NVM_APP_NUM_PAGES
+
+/// Magic of a page header: "KV01"
+#define NVM_KV_MAGIC 0x3130564Bu
+
+/// Byte of the erased \glos{NVM}, an erased key ends the records of a page
+#define NVM_KV_ERASED 0xFFu
+
+/// Largest value of a record [bytes]
+#define NVM_KV_VALUE_MAX_LEN 32u
+
+/// Size of the key, the length and the CRC of a record [bytes]
+#define NVM_KV_REC_OVERHEAD 4u
+
+/// Largest record [words]
+#define NVM_KV_REC_MAX_WORDS ((NVM_KV_REC_OVERHEAD + NVM_KV_VALUE_MAX_LEN + NVM_WORD_SIZE - 1u) / NVM_WORD_SIZE)
+
+/// Initial value of the CRC-16/CCITT
+#define NVM_KV_CRC_INIT 0xFFFFu
+
+/// Polynomial of the CRC-16/CCITT
+#define NVM_KV_CRC_POLY 0x1021u
+
+/// Page of the former fixed word of the TX power level: stored flag, level
+#define NVM_LEGACY_TXPWR_PAGE 0u
+
+/// Page of the former fixed word of the advertising triggers: stored flag, reserved, configuration
+#define NVM_LEGACY_ADVTRIG_PAGE 1u
+
+/// Page the store is formatted in, it holds no former fixed word
+#define NVM_KV_FORMAT_PAGE (NVM_KV_NUM_PAGES - 1u)
+
+/// Header of a page, one \glos{NVM} word
+typedef struct
+{
+    uint32_t magic;                        //!< \ref NVM_KV_MAGIC if the page is formatted
+    uint32_t seq;                          //!< Sequence number of the page, incremented on every new page
+    uint8_t reserved[NVM_WORD_SIZE - 8u];  //!< Reserved, erased
+} nvm_kvPageHdr_tst;
+
+_Static_assert(NVM_WORD_SIZE == sizeof(nvm_kvPageHdr_tst), "The size of nvm_kvPageHdr_tst is not equal to NVM_WORD_SIZE.");
+_Static_assert((uint8_t)NVM_ITEM_MAX <= 8u, "The dirty items do not fit in nvm_dirty.");
+
+/******************************************************************************\
+ *  Global variables
+\******************************************************************************/
+
+/// Flush timer ID
+SECTION_PERSISTENT static int8_t nvm_timerId;
+
+/// Is the flush timer armed
+SECTION_PERSISTENT static bool nvm_timerArmed = false;
+
+/// Dirty items, one bit per \ref nvm_item_ten
+SECTION_PERSISTENT static uint8_t nvm_dirty = 0u;
+
+/// Address of the last record of every item, 0 if the item is not stored
+SECTION_PERSISTENT static uint32_t nvm_index[NVM_ITEM_MAX];
+
+/// Page being written
+SECTION_PERSISTENT static uint8_t nvm_headPage = 0u;
+
+/// Sequence number of the page being written
+SECTION_PERSISTENT static uint32_t nvm_headSeq = 0u;
+
+/// Address of the next record in the page being written
+SECTION_PERSISTENT static uint32_t nvm_writeAdr = NVM_KV_BASE_ADR;
+
+/// Number of page erases since boot
+SECTION_PERSISTENT static uint32_t nvm_eraseCnt = 0u;
+
+/// Number of words written since boot
+SECTION_PERSISTENT static uint32_t nvm_writeCnt = 0u;
+
+/// @}
+
+/******************************************************************************\
+ *  Functions declarations
+\******************************************************************************/
+
+/**
+ * @brief      Returns the address of a page.
+ * @param[in]  page  The page.
+ * @return     The address
+ */
+static uint32_t pageAdr(uint8_t page)
+{
+    return NVM_KV_BASE_ADR + ((uint32_t)page * NVM_KV_PAGE_SIZE);
+}
+
+/**
+ * @brief      Returns the page following a page in the ring.
+ * @param[in]  page  The page.
+ * @return     The next page
+ */
+static uint8_t nextPage(uint8_t page)
+{
+    return (uint8_t)((page + 1u) % NVM_KV_NUM_PAGES);
+}
+
+/**
+ * @brief      Returns a pointer to the \glos{NVM}, which is mapped in the address space.
+ * @param[in]  adr  The address.
+ * @return     The pointer
+ */
+static uint8_t const *nvmPtr(uint32_t adr)
+{
+    return (uint8_t const *)(uintptr_t)adr;
+}
+
+/**
+ * @brief      Returns the number of words of a record.
+ * @param[in]  len  The length of the value.
+ * @return     The number of words
+ */
+static uint32_t recWords(uint8_t len)
+{
+    return ((uint32_t)NVM_KV_REC_OVERHEAD + len + NVM_WORD_SIZE - 1u) / NVM_WORD_SIZE;
+}
+
+/**
+ * @brief      Computes the CRC-16/CCITT of a buffer.
+ * @param[in]  data_p  The buffer.
+ * @param[in]  len     The length of the buffer.
+ * @return     The CRC
+ */
+static uint16_t crc16(uint8_t const *data_p, uint16_t len)
+{
+    uint16_t crc = NVM_KV_CRC_INIT;
+    uint16_t i;
+    uint8_t bit;
+
+    for (i = 0u; i < len; i++)
+    {
+        crc ^= (uint16_t)((uint16_t)data_p[i] << 8);
+        for (bit = 0u; bit < 8u; bit++)
+        {
+            crc = (0u != (crc & 0x8000u)) ? (uint16_t)((crc << 1) ^ NVM_KV_CRC_POLY) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief      Tells if a word is erased.
+ * @param[in]  adr  The address of the word.
+ * @return     true if all bytes are erased, false otherwise
+ */
+static bool isErased(uint32_t adr)
+{
+    uint8_t const *word_p = nvmPtr(adr);
+    uint8_t i;
+
+    for (i = 0u; (i < NVM_WORD_SIZE) && (NVM_KV_ERASED == word_p[i]); i++)
+    {
+        // Nothing to do
+    }
+    return (NVM_WORD_SIZE == i);
+}
+
+/**
+ * @brief      Tells if a valid record starts at an address.
+ * @param[in]  adr  The address of the record.
+ * @param[in]  end  The end of the page.
+ * @return     true if the length fits and the CRC matches, false otherwise
+ */
+static bool isRecord(uint32_t adr, uint32_t end)
+{
+    uint8_t const *rec_p = nvmPtr(adr);
+    uint8_t len          = rec_p[1];
+    bool ret;
+
+    ret = (NVM_KV_ERASED != rec_p[0]) && (len <= NVM_KV_VALUE_MAX_LEN) && ((adr + (recWords(len) * NVM_WORD_SIZE)) <= end);
+    if (ret)
+    {
+        ret = (crc16(rec_p, (uint16_t)(2u + len)) == (uint16_t)((uint16_t)rec_p[2u + len] | ((uint16_t)rec_p[3u + len] << 8)));
+    }
+    return ret;
+}
+
+/**
+ * @brief      Reads the header of a page.
+ * @param[in]  page   The page.
+ * @param[out] seq_p  The sequence number of the page.
+ * @return     true if the page is formatted, false otherwise
+ */
+static bool readHdr(uint8_t page, uint32_t *seq_p)
+{
+    nvm_kvPageHdr_tst hdr;
+
+    (void)memcpy((void *)&hdr, nvmPtr(pageAdr(page)), sizeof(hdr));
+    *seq_p = hdr.seq;
+    return (NVM_KV_MAGIC == hdr.magic);
+}
+
+/**
+ * @brief      Indexes the valid records of a page.
+ * @param[in]  page  The page.
+ * @return     The address following the last record
+ */
+static uint32_t scanPage(uint8_t page)
+{
+    uint32_t adr = pageAdr(page) + NVM_WORD_SIZE;
+    uint32_t end = pageAdr(page) + NVM_KV_PAGE_SIZE;
+    uint8_t const *rec_p;
+
+    while ((adr < end) && !isErased(adr))
+    {
+        if (isRecord(adr, end))
+        {
+            rec_p = nvmPtr(adr);
+            if (rec_p[0] < (uint8_t)NVM_ITEM_MAX)
+            {
+                // The later records of an item replace the earlier ones
+                nvm_index[rec_p[0]] = adr;
+            }
+            adr += recWords(rec_p[1]) * NVM_WORD_SIZE;
+        }
+        else
+        {
+            // Torn or corrupted: resynchronize on the next word
+            adr += NVM_WORD_SIZE;
+        }
+    }
+    return adr;
+}
+
+/**
+ * @brief      Appends a record to the page being written, which has room for it.
+ * @param[in]  key      The key of the record.
+ * @param[in]  value_p  The value.
+ * @param[in]  len      The length of the value.
+ * @return     @ref RBK_SMP290_NVM_SUCCESS if operation is successful, else the NVM driver error
+ */
+static rbk_smp290_nvm_err_ten writeRecord(uint8_t key, void const *value_p, uint8_t len)
+{
+    uint8_t buf[NVM_KV_REC_MAX_WORDS * NVM_WORD_SIZE];
+    uint32_t words = recWords(len);
+    uint32_t adr   = nvm_writeAdr;
+    rbk_smp290_nvm_err_ten ret;
+    uint16_t crc;
+
+    (void)memset((void *)buf, NVM_KV_ERASED, sizeof(buf));
+    buf[0] = key;
+    buf[1] = len;
+    (void)memcpy((void *)&buf[2], value_p, len);
+    crc            = crc16(buf, (uint16_t)(2u + len));
+    buf[2u + len] = (uint8_t)(crc & 0xFFu);
+    buf[3u + len] = (uint8_t)(crc >> 8);
+
+    ret = rbk_smp290_nvm_write((void *)(uintptr_t)adr, (const void *)buf, words);
+    nvm_writeCnt += words;
+
+    // The words are used even if the write failed
+    nvm_writeAdr += words * NVM_WORD_SIZE;
+
+    if ((RBK_SMP290_NVM_SUCCESS == ret) && isRecord(adr, adr + (words * NVM_WORD_SIZE)))
+    {
+        nvm_index[key] = adr;
+    }
+    else
+    {
+        ret = RBK_SMP290_NVM_ERR;
+    }
+    return ret;
+}
+
+/**
+ * @brief      Erases a page and starts it as the page being written.
+ * @param[in]  page  The page.
+ * @param[in]  seq   The sequence number of the page.
+ * @return     @ref RBK_SMP290_NVM_SUCCESS if operation is successful, else the NVM driver error
+ */
+static rbk_smp290_nvm_err_ten startPage(uint8_t page, uint32_t seq)
+{
+    nvm_kvPageHdr_tst hdr;
+    rbk_smp290_nvm_err_ten ret;
+
+    (void)memset((void *)&hdr, NVM_KV_ERASED, sizeof(hdr));
+    hdr.magic = NVM_KV_MAGIC;
+    hdr.seq   = seq;
+
+    ret = rbk_smp290_nvm_writeWithErase((void *)(uintptr_t)pageAdr(page), (const void *)&hdr, 1u);
+    nvm_eraseCnt++;
+    nvm_writeCnt++;
+
+    nvm_headPage = page;
+    nvm_headSeq  = seq;
+    nvm_writeAdr = pageAdr(page) + NVM_WORD_SIZE;
+    return ret;
+}
+
+/**
+ * @brief      Copies the live records of a page into the page being written.
+ * @param[in]  page  The page.
+ * @return     @ref RBK_SMP290_NVM_SUCCESS if operation is successful, else the NVM driver error
+ */
+static rbk_smp290_nvm_err_ten evacuate(uint8_t page)
+{
+    rbk_smp290_nvm_err_ten ret = RBK_SMP290_NVM_SUCCESS;
+    uint32_t end               = pageAdr(nvm_headPage) + NVM_KV_PAGE_SIZE;
+    uint8_t const *rec_p;
+    uint8_t item;
+
+    for (item = 0u; (item < (uint8_t)NVM_ITEM_MAX) && (RBK_SMP290_NVM_SUCCESS == ret); item++)
+    {
+        if ((nvm_index[item] >= pageAdr(page)) && (nvm_index[item] < (pageAdr(page) + NVM_KV_PAGE_SIZE)))
+        {
+            rec_p = nvmPtr(nvm_index[item]);
+            if ((nvm_writeAdr + (recWords(rec_p[1]) * NVM_WORD_SIZE)) <= end)
+            {
+                ret = writeRecord(item, &rec_p[2], rec_p[1]);
+            }
+            else
+            {
+                ret = RBK_SMP290_NVM_ERR;
+            }
+        }
+        else
+        {
+            // Nothing to do
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief      Takes over the configuration of the former fixed words.
+ * @details    A word is taken over if its item is not stored and its page is not a page of the
+ *             store yet, i.e. still holds the word.
+ * return     None
+ */
+static void takeOver(void)
+{
+    uint8_t const *txPwr_p   = nvmPtr(pageAdr(NVM_LEGACY_TXPWR_PAGE));
+    uint8_t const *advTrig_p = nvmPtr(pageAdr(NVM_LEGACY_ADVTRIG_PAGE));
+    adv_trigCfg_tst advTrig;
+    uint32_t seq;
+
+    if ((0u == nvm_index[NVM_ITEM_TXPWR]) && !readHdr(NVM_LEGACY_TXPWR_PAGE, &seq) && (1u == txPwr_p[0]))
+    {
+        (void)writeRecord((uint8_t)NVM_ITEM_TXPWR, &txPwr_p[1], 1u);
+    }
+    if ((0u == nvm_index[NVM_ITEM_ADVTRIG]) && !readHdr(NVM_LEGACY_ADVTRIG_PAGE, &seq) && (1u == advTrig_p[0]))
+    {
+        (void)memcpy((void *)&advTrig, &advTrig_p[2], sizeof(advTrig));
+        (void)writeRecord((uint8_t)NVM_ITEM_ADVTRIG, &advTrig, sizeof(advTrig));
+    }
+}
+
+/**
+ * @brief      Formats the store.
+ * @details    The pages of the former fixed words are not erased, the words are taken over from
+ *             them by \ref takeOver.
+ * return     None
+ */
+static void format(void)
+{
+    smp290_log(LOG_VERBOSITY_INFO, "NVM store formatted\r\n");
+    (void)startPage(NVM_KV_FORMAT_PAGE, 0u);
+}
+
+/**
+ * @brief      Compacts the store: the next page becomes the page being written.
+ * @details    The next page holds no live record. The live records of the oldest page are then
+ *             copied, so the page after the new one holds no live record either.
+ * @return     @ref RBK_SMP290_NVM_SUCCESS if operation is successful, else the NVM driver error
+ */
+static rbk_smp290_nvm_err_ten compact(void)
+{
+    rbk_smp290_nvm_err_ten ret = startPage(nextPage(nvm_headPage), nvm_headSeq + 1u);
+
+    if (RBK_SMP290_NVM_SUCCESS == ret)
+    {
+        ret = evacuate(nextPage(nvm_headPage));
+    }
+    return ret;
+}
+
+/**
+ * @brief      Callback function for the flush timer, posts the flush to the task.
+ * @param[in]  status  The status of the timer.
+ * return     None
+ */
+static void timerCallback(rbk_smp290_timerStatus_t status)
+{
+    (void)(status);
+    rbk_smp290_timer_disable(nvm_timerId);
+    task_postEventFromIsr((enum_t)SIG_NVM_FLUSH, NULL);
+}
+
+/**
+ * @brief      Arms the flush timer, unless it is already armed.
+ * return     None
+ */
+static void armTimer(void)
+{
+    if (!nvm_timerArmed)
+    {
+        nvm_timerArmed = true;
+        rbk_smp290_timer_restart(nvm_timerId);
+        rbk_smp290_timer_enable(nvm_timerId);
+    }
+    else
+    {
+        // Coalesced into the armed flush
+    }
+}
+
+/**
+ * @brief      Writes an item to \glos{NVM} with the value of its owner.
+ * @param[in]  item  The item.
+ * @return     @ref RBK_SMP290_NVM_SUCCESS if operation is successful, else the NVM driver error
+ */
+static rbk_smp290_nvm_err_ten writeItem(nvm_item_ten item)
+{
+    rbk_smp290_nvm_err_ten ret = RBK_SMP290_NVM_SUCCESS;
+    adv_cadence_tst cadence[ADV_STATE_MAX];
+    uint8_t buf[3];
+    uint8_t state;
+
+    switch (item)
+    {
+        case NVM_ITEM_TXPWR:
+        {
+            buf[0] = (uint8_t)txpwr_getMax();
+            ret    = nvm_set(item, buf, 1u);
+        }
+        break;
+
+        case NVM_ITEM_ADVTRIG:
+        {
+            ret = nvm_set(item, adv_getTrigCfg(), sizeof(adv_trigCfg_tst));
+        }
+        break;
+
+        case NVM_ITEM_DEVINFO:
+        {
+            ret = nvm_set(item, adv_getDevInfo(), sizeof(adv_devInfo_tst));
+        }
+        break;
+
+        case NVM_ITEM_TSD:
+        {
+            buf[0] = rbk_smp290_tsd_isTsdEnabled() ? 1u : 0u;
+            ret    = nvm_set(item, buf, 1u);
+        }
+        break;
+
+        case NVM_ITEM_ADVPOL:
+        {
+            for (state = 0u; state < (uint8_t)ADV_STATE_MAX; state++)
+            {
+                cadence[state] = *adv_getCadence((adv_state_ten)state);
+            }
+            ret = nvm_set(item, cadence, sizeof(cadence));
+        }
+        break;
+
+        case NVM_ITEM_ADVMODE:
+        {
+            buf[0] = (uint8_t)adv_getMode();
+            buf[1] = (uint8_t)(adv_getConnWindowPeriod() & 0xFFu);
+            buf[2] = (uint8_t)(adv_getConnWindowPeriod() >> 8);
+            ret    = nvm_set(item, buf, 3u);
+        }
+        break;
+
+        case NVM_ITEM_LINK:
+        {
+            buf[0] = txpwr_getMargin();
+            ret    = nvm_set(item, buf, 1u);
+        }
+        break;
+
+        default:
+        {
+            // Nothing to do
+        }
+        break;
+    }
+    return ret;
+}
+
+// Initializes the configuration store.
+void nvm_init(void)
+{
+    uint32_t seq   = 0u;
+    bool found     = false;
+    uint8_t page;
+    uint8_t i;
+
+    nvm_timerId    = rbk_smp290_timer_create(MS_TO_US(NVM_FLUSH_DELAY_MS), timerCallback);
+    nvm_timerArmed = false;
+    nvm_dirty      = 0u;
+    (void)memset((void *)nvm_index, 0x00, sizeof(nvm_index));
+
+    // The page being written is the formatted one with the highest sequence number
+    for (page = 0u; page < NVM_KV_NUM_PAGES; page++)
+    {
+        if (readHdr(page, &seq) && (!found || ((int32_t)(seq - nvm_headSeq) > 0)))
+        {
+            found        = true;
+            nvm_headPage = page;
+            nvm_headSeq  = seq;
+        }
+    }
+
+    if (found)
+    {
+        // Replay from the oldest page, skipping the stale ones
+        for (i = 1u; i <= NVM_KV_NUM_PAGES; i++)
+        {
+            page = (uint8_t)((nvm_headPage + i) % NVM_KV_NUM_PAGES);
+            if (readHdr(page, &seq) && (seq == (nvm_headSeq - (NVM_KV_NUM_PAGES - i))))
+            {
+                nvm_writeAdr = scanPage(page);
+            }
+        }
+
+        // A reset during a compaction leaves live records in the next page
+        if (RBK_SMP290_NVM_SUCCESS != evacuate(nextPage(nvm_headPage)))
+        {
+            smp290_log(LOG_VERBOSITY_WARNING, "NVM compaction failed\r\n");
+        }
+    }
+    else
+    {
+        format();
+    }
+
+    // Completes a takeover interrupted by a reset as well
+    takeOver();
+    smp290_log(LOG_VERBOSITY_INFO, "NVM store: page %u, seq %lu, %lu bytes used\r\n", (unsigned)nvm_headPage,
+               (unsigned long)nvm_headSeq, (unsigned long)(nvm_writeAdr - pageAdr(nvm_headPage)));
+}
+
+// Reads a configuration item from NVM.
+bool nvm_get(nvm_item_ten item, void *dst_p, uint8_t len)
+{
+    uint8_t const *rec_p;
+    bool ret = false;
+
+    if ((item < NVM_ITEM_MAX) && (0u != nvm_index[item]))
+    {
+        rec_p = nvmPtr(nvm_index[item]);
+        ret   = (len == rec_p[1]);
+        if (ret)
+        {
+            (void)memcpy(dst_p, &rec_p[2], len);
+        }
+    }
+    else
+    {
+        // Nothing to do
+    }
+    return ret;
+}
+
+// Appends a record of a configuration item to NVM, unless it already holds the value.
+rbk_smp290_nvm_err_ten nvm_set(nvm_item_ten item, void const *value_p, uint8_t len)
+{
+    rbk_smp290_nvm_err_ten ret = RBK_SMP290_NVM_SUCCESS;
+    uint8_t const *rec_p       = nvmPtr(nvm_index[(item < NVM_ITEM_MAX) ? item : 0u]);
+
+    if ((item >= NVM_ITEM_MAX) || (len > NVM_KV_VALUE_MAX_LEN))
+    {
+        ret = RBK_SMP290_NVM_ERR;
+    }
+    else if ((0u != nvm_index[item]) && (len == rec_p[1]) && (0 == memcmp(&rec_p[2], value_p, len)))
+    {
+        // Already stored
+    }
+    else
+    {
+        if ((nvm_writeAdr + (recWords(len) * NVM_WORD_SIZE)) > (pageAdr(nvm_headPage) + NVM_KV_PAGE_SIZE))
+        {
+            ret = compact();
+        }
+        if (RBK_SMP290_NVM_SUCCESS == ret)
+        {
+            ret = writeRecord((uint8_t)item, value_p, len);
+        }
+    }
+    return ret;
+}
+
+// Marks an item dirty.
+void nvm_setDirty(nvm_item_ten item)
+{
+    nvm_dirty |= (uint8_t)(1u << (uint8_t)item);
+    armTimer();
+}
+
+// Writes the dirty items to NVM.
+void nvm_flush(void)
+{
+    uint8_t item;
+
+    nvm_timerArmed = false;
+    for (item = 0u; item < (uint8_t)NVM_ITEM_MAX; item++)
+    {
+        if (0u != (nvm_dirty & (1u << item)))
+        {
+            if (RBK_SMP290_NVM_SUCCESS == writeItem((nvm_item_ten)item))
+            {
+                nvm_dirty &= (uint8_t)~(1u << item);
+            }
+            else
+            {
+                smp290_log(LOG_VERBOSITY_WARNING, "NVM write of item %d failed\r\n", item);
+            }
+        }
+    }
+
+    // Retry the failed items later
+    if (0u != nvm_dirty)
+    {
+        armTimer();
+    }
+}
+
+// Returns the number of page erases since boot.
+uint32_t nvm_getEraseCnt(void)
+{
+    return nvm_eraseCnt;
+}
+
+// Returns the number of words written since boot.
+uint32_t nvm_getWriteCnt(void)
+{
+    return nvm_writeCnt;
+}
+
+/** @} */
@@ -4,10 +4,12 @@
  * @file         sequence.c
  * @brief        This file contains the sensor measurement sequence of the project \ref measure_advertise_conn.
  * @details      The sequence module is responsible for managing the state machine
- *               sequence of the project. It defines the sequence update period,
- *               idle period, and the sequence definitions. It also includes functions
- *               to initialize, run, stop, and resume the sequence, as well as functions
- *               to handle failed measurements and retrieve output values from the sequence.
+ *               sequence of the project. The sequence is described by measurement plans:
+ *               constant tables of step descriptors stored in flash. Each step holds the
+ *               functions to start, cancel and collect its measurement, its slot in the
+ *               cycle and its rate divider. It also includes functions to initialize, run, stop, and resume the
+ *               sequence, to select the active plan, as well as functions to handle failed
+ *               measurements and retrieve output values from the sequence.
  * @copyright    (c) [Robert Bosch GmbH] [2024].
  *               All rights reserved, also regarding any disposal,
  *               exploitation, reproduction, editing, distribution, as well
@@ -18,6 +20,10 @@
  *               the event of the grant of a patent, utility model or design.
  **/
 
+/* System includes */
+#include <stdlib.h>
+#include <string.h>
+
 /* Library includes */
 #include "rbk_smp290_boot.h"
 #include "rbk_smp290_snsr.h"
@@ -25,6 +31,7 @@
 #include "rbk_smp290_types.h"
 
 /* Project includes */
+#include "ble_measSvc.h"
 #include "main.h"
 
 /// @addtogroup measure_advertise_conn_seq_cfg Sequence configuration definitions
@@ -37,33 +44,165 @@
 /******************************************************************************\
  * Periodic Sequences configuration constants
  \******************************************************************************/
-/// Sequence update period [us].
-#define SEQ_UPDATE_PERIOD_US MS_TO_US(100)
-
-/// Sequence definitions
-#define SEQ_T           0u   //!< Measurement T
-#define SEQ_TPAZ        1u   //!< Measurement TpAz
-#define SEQ_TAZAX_LO_LO 2u   //!< Measurement Tazax Low
-#define SEQ_TAZAX_LO_HI 3u   //!< Measurement Tazax High
-#define SEQ_VBAT        4u   //!< Measurement Vbat
-#define SEQ_ADV         5u   //!< Adv. data
-#define SEQ_MAX         10u  //!< Iterator max
+/// Sequence cycle length [ms].
+#define SEQ_CYCLE_MS 1000u
+
+/// Delay of the first step after the sequence is resumed [ms].
+#define SEQ_FIRST_STEP_DELAY_MS 100u
 
 #define SEQ_VBAT_NREP 1u                            //!< Measurement Vbat number of samples
 #define SEQ_VBAT_TREP 0u                            //!< Measurement Vbat sample rate
 
+/// Channels yielded by the measurements
+#define SEQ_YIELDS_T        (SEQ_CH_BIT(SEQ_CH_T))
+#define SEQ_YIELDS_TPAZ     (SEQ_CH_BIT(SEQ_CH_T) | SEQ_CH_BIT(SEQ_CH_P) | SEQ_CH_BIT(SEQ_CH_AZ_HI))
+#define SEQ_YIELDS_TAZAX_LO (SEQ_CH_BIT(SEQ_CH_T) | SEQ_CH_BIT(SEQ_CH_AZ_LO) | SEQ_CH_BIT(SEQ_CH_AX_LO))
+#define SEQ_YIELDS_TAZAX_HI (SEQ_CH_BIT(SEQ_CH_T) | SEQ_CH_BIT(SEQ_CH_AZ_HI) | SEQ_CH_BIT(SEQ_CH_AX_HI))
+#define SEQ_YIELDS_VBAT     (SEQ_CH_BIT(SEQ_CH_VBAT))
+
+/******************************************************************************\
+ * Accelerometer auto-range constants, in LSB of the high range (~0.94 g).
+ * The low range has a 3 times finer scale (640 g instead of 1920 g).
+ \******************************************************************************/
+#define SEQ_ACC_LO_TO_HI_SCALE 3   //!< Low range LSB per high range LSB
+#define SEQ_ACC_LO_SAT_LSB     2047 //!< Saturation of the low range [LSB of the low range]
+#define SEQ_ACC_LO_EXIT_LSB    512 //!< Above: leave the low range (480 g, 75 % of its full scale)
+#define SEQ_ACC_LO_ENTER_LSB   427 //!< Below: back to the low range (400 g)
+#define SEQ_ACC_HI_ENTER_LSB   597 //!< Above: high range only (560 g)
+#define SEQ_ACC_HI_EXIT_LSB    512 //!< Below: leave the high range (480 g)
+
+/*******************************************************************************
+ *  Types
+ ******************************************************************************/
+
+/// Step of a measurement plan
+typedef struct
+{
+    const char *name;                            //!< Step name, used for logging
+    rbk_smp290_snsr_err_ten (*start)(void);      //!< Starts the measurement (or the action) of the step
+    rbk_smp290_snsr_err_ten (*cancel)(void);     //!< Cancels the measurement, NULL if the step does not measure
+    void (*collect)(ble_sensorData_tst *dst_p);  //!< Writes the results into their destination fields of the frame
+    uint16_t slot_ms;                            //!< Start of the step within the cycle [ms]
+    uint8_t divider;                             //!< The step runs every divider-th cycle, 1 for every cycle
+    uint8_t yields;                              //!< Channels refreshed by the step, bit mask of \ref seq_channel_ten
+    bool (*enabled)(void);                       //!< Tells if the step runs in the cycle, NULL if always
+} seq_step_tst;
+
+/// Measurement plan
+typedef struct
+{
+    const seq_step_tst *steps;  //!< Steps, sorted by slot
+    uint8_t numSteps;           //!< Number of steps
+    uint32_t cycle_ms;          //!< Default cycle length [ms]
+} seq_plan_tst;
+
+/// Accelerometer range
+typedef enum
+{
+    SEQ_ACC_RANGE_LO,    //!< Low range only
+    SEQ_ACC_RANGE_DUAL,  //!< Both ranges, close to the range boundary
+    SEQ_ACC_RANGE_HI     //!< High range only
+} seq_accRange_ten;
+
+/// Position of the sequence
+typedef struct
+{
+    uint32_t iter;               //!< Index of the step in the plan
+    uint32_t cycle;              //!< Cycle counter, used by the step dividers
+    const seq_plan_tst *plan_p;  //!< Plan of the cycle
+    uint32_t cycle_ms;           //!< Length of the cycle [ms], latched with the plan
+} seq_pos_tst;
+
+/******************************************************************************\
+ *  Functions declarations
+\******************************************************************************/
+static rbk_smp290_snsr_err_ten startT(void);
+static rbk_smp290_snsr_err_ten startTpAz(void);
+static rbk_smp290_snsr_err_ten startTAzAxLo(void);
+static rbk_smp290_snsr_err_ten startTAzAxHi(void);
+static rbk_smp290_snsr_err_ten startVbat(void);
+static rbk_smp290_snsr_err_ten startAdv(void);
+static void publishFrame(void);
+static void shortenCycle(void);
+static void collectT(ble_sensorData_tst *dst_p);
+static void collectTpAz(ble_sensorData_tst *dst_p);
+static void collectTAzAxLo(ble_sensorData_tst *dst_p);
+static void collectTAzAxHi(ble_sensorData_tst *dst_p);
+static void collectVbat(ble_sensorData_tst *dst_p);
+static bool isAccLoEnabled(void);
+static bool isAccHiEnabled(void);
+
+/******************************************************************************\
+ *  Measurement plans
+\******************************************************************************/
+/// Full plan: every channel is measured, each at its own rate.
+/// The Adv. step runs every cycle, so every cycle has at least one due step.
+static const seq_step_tst seq_stepsFull[] = {
+    {"T",        startT,       rbk_smp290_snsr_cncl_cmpd_T,     collectT,       0u,   5u,  SEQ_YIELDS_T,        NULL},
+    {"TpAz",     startTpAz,    rbk_smp290_snsr_cncl_cmpd_p,     collectTpAz,    100u, 1u,  SEQ_YIELDS_TPAZ,     NULL},
+    {"Tazax_lo", startTAzAxLo, rbk_smp290_snsr_cncl_cmpd_az_ax, collectTAzAxLo, 200u, 1u,  SEQ_YIELDS_TAZAX_LO, isAccLoEnabled},
+    {"Tazax_hi", startTAzAxHi, rbk_smp290_snsr_cncl_cmpd_az_ax, collectTAzAxHi, 300u, 1u,  SEQ_YIELDS_TAZAX_HI, isAccHiEnabled},
+    {"Vbat",     startVbat,    rbk_smp290_snsr_cncl_Vbat,       collectVbat,    400u, 60u, SEQ_YIELDS_VBAT,     NULL},
+    {"Adv",      startAdv,     NULL,                            NULL,           500u, 1u,  0u,                  NULL},
+};
+
+/// Pressure plan: T, p and Az_hi only
+static const seq_step_tst seq_stepsPressure[] = {
+    {"TpAz", startTpAz, rbk_smp290_snsr_cncl_cmpd_p, collectTpAz, 0u,   1u, SEQ_YIELDS_TPAZ, NULL},
+    {"Adv",  startAdv,  NULL,                        NULL,        100u, 1u, 0u,              NULL},
+};
+
+/// Measurement plans, indexed by \ref seq_planId_ten
+static const seq_plan_tst seq_plans[SEQ_PLAN_MAX] = {
+    [SEQ_PLAN_FULL]     = {seq_stepsFull, (uint8_t)(sizeof(seq_stepsFull) / sizeof(seq_stepsFull[0])), SEQ_CYCLE_MS},
+    [SEQ_PLAN_PRESSURE] = {seq_stepsPressure, (uint8_t)(sizeof(seq_stepsPressure) / sizeof(seq_stepsPressure[0])), SEQ_CYCLE_MS},
+};
+
 /******************************************************************************\
  *  Global variables
 \******************************************************************************/
-/// Static variable to propagate the BLE Adv content.
-SECTION_PERSISTENT static ble_sensorData_tst adv_sensorData;
+/// Frame of the cycle: the sensor data window of the advertising payload, written in place
+SECTION_PERSISTENT static ble_sensorData_tst *sequence_frame_p;
+
+/// Position of the current step
+SECTION_PERSISTENT static seq_pos_tst sequence_pos = {0u, 0u, &seq_plans[SEQ_PLAN_FULL], SEQ_CYCLE_MS};
+
+/// Position of the next due step, computed when the timer is armed
+SECTION_PERSISTENT static seq_pos_tst sequence_nextPos = {0u, 0u, &seq_plans[SEQ_PLAN_FULL], SEQ_CYCLE_MS};
+
+/// Delay between the current and the next due step [ms]
+SECTION_PERSISTENT static uint32_t sequence_nextDelay_ms = 0u;
+
+/// Sequence time: slot time of the current step since boot [ms]
+SECTION_PERSISTENT static uint32_t sequence_time_ms = 0u;
+
+/// Plan requested by \ref sequence_selectPlan, applied at the next cycle start
+SECTION_PERSISTENT static seq_planId_ten sequence_reqPlan = SEQ_PLAN_FULL;
 
-/// Sequence iterator
-SECTION_PERSISTENT static volatile uint32_t sequence_iter = SEQ_T;
+/// Cycle length requested by \ref sequence_setCycle [ms], 0 for the default of the plan
+SECTION_PERSISTENT static uint32_t sequence_reqCycle_ms = 0u;
 
 /// Task 1 Timer Id
 SECTION_PERSISTENT static int8_t sequence_timerId = -1;
 
+/// Number of timer wakeups counted in the ongoing cycle
+SECTION_PERSISTENT static uint8_t sequence_wakeupCnt = 0u;
+
+/// Number of timer wakeups of the last completed cycle
+SECTION_PERSISTENT static uint8_t sequence_wakeupsPerCycle = 0u;
+
+/// Accelerometer range selected by the auto-ranging
+SECTION_PERSISTENT static seq_accRange_ten sequence_accRange = SEQ_ACC_RANGE_DUAL;
+
+/// Is the frame of the ongoing cycle already published, e.g. on the onset of the alarm
+SECTION_PERSISTENT static bool sequence_published = false;
+
+/// Steps dropped by the plan optimizer, bit mask of step indexes per plan
+SECTION_PERSISTENT static uint32_t sequence_planSkip[SEQ_PLAN_MAX];
+
+/// Sensor conversions per cycle of each optimized plan [1/100]
+SECTION_PERSISTENT static uint16_t sequence_planConv[SEQ_PLAN_MAX];
+
 /// Buffer for Battery voltage reading
 static rbk_smp290_snsr_Vbat_buff_tst vbat_buff;
 
@@ -74,46 +213,298 @@ static rbk_smp290_snsr_Vbat_buff_tst vbat_buff;
 \******************************************************************************/
 
 /**
- * @brief Cancel the ongoing measurement depending on \ref sequence_iter.
- * @return the cancellation status
+ * @brief Starts the compensated T measurement.
+ * @return the measurement scheduling status
  */
-static rbk_smp290_snsr_err_ten cancelMeasmt(void)
+static rbk_smp290_snsr_err_ten startT(void)
 {
-    rbk_smp290_snsr_err_ten ret = RBK_SMP290_SNSR_SUCCESS;
+    return rbk_smp290_snsr_meas_cmpd_T();
+}
+
+/**
+ * @brief Starts the compensated TpAz measurement.
+ * @return the measurement scheduling status
+ */
+static rbk_smp290_snsr_err_ten startTpAz(void)
+{
+    return rbk_smp290_snsr_meas_cmpd_p(RBK_SMP290_SNSR_EN_ENABLE, RBK_SMP290_SNSR_EN_ENABLE);
+}
+
+/**
+ * @brief Starts the compensated TAzAx measurement in the low range.
+ * @return the measurement scheduling status
+ */
+static rbk_smp290_snsr_err_ten startTAzAxLo(void)
+{
+    return rbk_smp290_snsr_meas_cmpd_az_ax(RBK_SMP290_SNSR_EN_ENABLE, RBK_SMP290_SNSR_RANGE_LO, RBK_SMP290_SNSR_RANGE_LO);
+}
+
+/**
+ * @brief Starts the compensated TAzAx measurement in the high range.
+ * @return the measurement scheduling status
+ */
+static rbk_smp290_snsr_err_ten startTAzAxHi(void)
+{
+    return rbk_smp290_snsr_meas_cmpd_az_ax(RBK_SMP290_SNSR_EN_ENABLE, RBK_SMP290_SNSR_RANGE_HI, RBK_SMP290_SNSR_RANGE_HI);
+}
 
-    switch (sequence_iter)
+/**
+ * @brief Starts the battery voltage measurement.
+ * @return the measurement scheduling status
+ */
+static rbk_smp290_snsr_err_ten startVbat(void)
+{
+    /// Vbat sequence configuration
+    static const rbk_smp290_snsr_cfg_Vbat_tst vbat_cfg = {.N_rep     = (uint8_t)SEQ_VBAT_NREP,
+                                                          .t_rep     = SEQ_VBAT_TREP,
+                                                          .osr       = RBK_SMP290_SNSR_OSR_4X,
+                                                          .Vbat_load = RBK_SMP290_SNSR_VBAT_LOAD_DISABLE};
+    return rbk_smp290_snsr_meas_and_get_Vbat(&vbat_cfg, &vbat_buff);
+}
+
+/**
+ * @brief Tells if the low range TAzAx measurement runs.
+ * @return true unless the high range alone is selected
+ */
+static bool isAccLoEnabled(void)
+{
+    return (SEQ_ACC_RANGE_HI != sequence_accRange);
+}
+
+/**
+ * @brief Tells if the high range TAzAx measurement runs.
+ * @return true unless the low range alone is selected
+ */
+static bool isAccHiEnabled(void)
+{
+    return (SEQ_ACC_RANGE_LO != sequence_accRange);
+}
+
+/**
+ * @brief      Selects the accelerometer range for the next cycle.
+ * @details    The range follows the magnitude of the last Az sample, with
+ *             hysteresis bands around the boundary of the low range. Close to
+ *             the boundary both ranges are measured. The low range sample is
+ *             used when it is fresh and not saturated, for its finer scale.
+ *             The range flags of the frame tell which scale of the cycle applies.
+ * @param[in,out] frame_p  frame of the cycle
+ * return     None
+ */
+static void updateAccRange(ble_sensorData_tst *frame_p)
+{
+    int32_t acc;
+
+    if ((0u != (frame_p->fresh & SEQ_CH_BIT(SEQ_CH_AZ_LO))) && (abs((int32_t)frame_p->Az_lo_out) < SEQ_ACC_LO_SAT_LSB))
     {
-        case SEQ_T:
-        {
-            ret = rbk_smp290_snsr_cncl_cmpd_T();
-        }
-        break;
-        case SEQ_TPAZ:
-        {
-            ret = rbk_smp290_snsr_cncl_cmpd_p();
-        }
-        break;
-        case SEQ_TAZAX_LO_LO:
-        {
-            ret = rbk_smp290_snsr_cncl_cmpd_az_ax();
-        }
-        break;
-        case SEQ_TAZAX_LO_HI:
+        acc = abs((int32_t)frame_p->Az_lo_out) / SEQ_ACC_LO_TO_HI_SCALE;
+    }
+    else
+    {
+        acc = abs((int32_t)frame_p->Az_hi_out);
+    }
+
+    // Range flags of the cycle
+    frame_p->flags &= (uint8_t)~(SEQ_FLAG_ACC_RANGE_LO | SEQ_FLAG_ACC_RANGE_HI);
+    frame_p->flags |= ((0u != (frame_p->fresh & SEQ_CH_BIT(SEQ_CH_AZ_LO))) ? SEQ_FLAG_ACC_RANGE_LO : 0u);
+    frame_p->flags |= ((0u != (frame_p->fresh & SEQ_CH_BIT(SEQ_CH_AX_HI))) ? SEQ_FLAG_ACC_RANGE_HI : 0u);
+
+    switch (sequence_accRange)
+    {
+        case SEQ_ACC_RANGE_LO:
         {
-            ret = rbk_smp290_snsr_cncl_cmpd_az_ax();
+            if (acc > SEQ_ACC_LO_EXIT_LSB)
+            {
+                sequence_accRange = (acc > SEQ_ACC_HI_ENTER_LSB) ? SEQ_ACC_RANGE_HI : SEQ_ACC_RANGE_DUAL;
+            }
         }
         break;
-        case SEQ_VBAT:
+
+        case SEQ_ACC_RANGE_HI:
         {
-            ret = rbk_smp290_snsr_cncl_Vbat();
+            if (acc < SEQ_ACC_HI_EXIT_LSB)
+            {
+                sequence_accRange = (acc < SEQ_ACC_LO_ENTER_LSB) ? SEQ_ACC_RANGE_LO : SEQ_ACC_RANGE_DUAL;
+            }
         }
         break;
+
         default:
         {
-            // Nothing to do
+            if (acc > SEQ_ACC_HI_ENTER_LSB)
+            {
+                sequence_accRange = SEQ_ACC_RANGE_HI;
+            }
+            else if (acc < SEQ_ACC_LO_ENTER_LSB)
+            {
+                sequence_accRange = SEQ_ACC_RANGE_LO;
+            }
+            else
+            {
+                // Nothing to do
+            }
         }
         break;
     }
+}
+
+/**
+ * @brief      Publishes the frame of the cycle and starts its advertising.
+ * @details    The frame is published at most once per cycle: on the onset of the
+ *             deflation alarm, the Adv. step of the same cycle does not start the
+ *             advertising again.
+ * return     None
+ */
+static void publishFrame(void)
+{
+    if (!sequence_published)
+    {
+        sequence_published = true;
+        // Increment the frame counter
+        sequence_frame_p->frame_counter++;
+        // Publish the frame, the next cycle writes into another slot
+        sequence_frame_p = snapshot_publish();
+        // Post event to start the advertising
+        task_postEvent((enum_t)SIG_ADV, NULL);
+    }
+    else
+    {
+        // Nothing to do
+    }
+}
+
+/**
+ * @brief      Checks the pressure slope of the frame.
+ * @details    A deflating sample raises the sampling rate from the ongoing cycle.
+ *             On the onset of the deflation alarm, the frame is advertised at
+ *             once, without waiting for the Adv. step of the cycle.
+ * return     None
+ */
+static void checkDeflation(void)
+{
+    bool onset = alarm_update(sequence_frame_p->p_out, sequence_time_ms);
+
+    // A deflating sample holds the high rate profile, apply it without waiting for the next cycle
+    shortenCycle();
+
+    if (alarm_isActive())
+    {
+        sequence_frame_p->flags |= SEQ_FLAG_ALARM;
+    }
+    else
+    {
+        sequence_frame_p->flags &= (uint8_t)~SEQ_FLAG_ALARM;
+    }
+
+    // While connected, the frame of the cycle is streamed to the client
+    if (onset && !connected)
+    {
+        publishFrame();
+    }
+}
+
+/**
+ * @brief Publishes the frame for advertising.
+ * @return always \ref RBK_SMP290_SNSR_SUCCESS
+ */
+static rbk_smp290_snsr_err_ten startAdv(void)
+{
+    // Select the accelerometer range of the next cycle
+    updateAccRange(sequence_frame_p);
+
+    // Feed the motion detection once per cycle with the fresh acceleration
+    if (0u != (sequence_frame_p->fresh & SEQ_CH_BIT(SEQ_CH_AZ_HI)))
+    {
+        motion_update(sequence_frame_p->Az_hi_out);
+    }
+
+    // Log the cycle in the history, also when it is not advertised
+    if (0u != (sequence_frame_p->fresh & SEQ_CH_BIT(SEQ_CH_P)))
+    {
+        history_add(sequence_frame_p, sequence_time_ms);
+    }
+
+    if (connected)
+    {
+        // Streaming mode: every cycle is notified to the client, nothing is advertised
+        sequence_frame_p->frame_counter++;
+        custmeasSvc_streamFrame(sequence_frame_p);
+    }
+    // Advertise only changed frames and heartbeats
+    else if (adv_isDue(sequence_frame_p, sequence_time_ms))
+    {
+        publishFrame();
+    }
+    return RBK_SMP290_SNSR_SUCCESS;
+}
+
+/**
+ * @brief Collects the T measurement.
+ * @param dst_p destination frame
+ */
+static void collectT(ble_sensorData_tst *dst_p)
+{
+    dst_p->T_out = rbk_smp290_snsr_get_cmpd_T();
+}
+
+/**
+ * @brief Collects the TpAz measurement.
+ * @param dst_p destination frame
+ */
+static void collectTpAz(ble_sensorData_tst *dst_p)
+{
+    dst_p->T_out     = rbk_smp290_snsr_get_cmpd_T();
+    dst_p->p_out     = rbk_smp290_snsr_get_cmpd_p();
+    dst_p->Az_hi_out = rbk_smp290_snsr_get_cmpd_az(RBK_SMP290_SNSR_RANGE_HI);
+}
+
+/**
+ * @brief Collects the TAzAx measurement in the low range.
+ * @param dst_p destination frame
+ */
+static void collectTAzAxLo(ble_sensorData_tst *dst_p)
+{
+    dst_p->T_out     = rbk_smp290_snsr_get_cmpd_T();
+    dst_p->Az_lo_out = rbk_smp290_snsr_get_cmpd_az(RBK_SMP290_SNSR_RANGE_LO);
+    dst_p->Ax_lo_out = rbk_smp290_snsr_get_cmpd_ax(RBK_SMP290_SNSR_RANGE_LO);
+}
+
+/**
+ * @brief Collects the TAzAx measurement in the high range.
+ * @param dst_p destination frame
+ */
+static void collectTAzAxHi(ble_sensorData_tst *dst_p)
+{
+    dst_p->T_out     = rbk_smp290_snsr_get_cmpd_T();
+    dst_p->Az_hi_out = rbk_smp290_snsr_get_cmpd_az(RBK_SMP290_SNSR_RANGE_HI);
+    dst_p->Ax_hi_out = rbk_smp290_snsr_get_cmpd_ax(RBK_SMP290_SNSR_RANGE_HI);
+}
+
+/**
+ * @brief Collects the battery voltage measurement.
+ * @param dst_p destination frame
+ */
+static void collectVbat(ble_sensorData_tst *dst_p)
+{
+    dst_p->Vbat_out = vbat_buff.Vbat[0];
+}
+
+/**
+ * @brief Cancel the ongoing measurement depending on \ref sequence_pos.
+ * @return the cancellation status
+ */
+static rbk_smp290_snsr_err_ten cancelMeasmt(void)
+{
+    rbk_smp290_snsr_err_ten ret = RBK_SMP290_SNSR_SUCCESS;
+    const seq_step_tst *step_p  = &sequence_pos.plan_p->steps[sequence_pos.iter];
+
+    if (NULL != step_p->cancel)
+    {
+        ret = step_p->cancel();
+    }
+    else
+    {
+        // Nothing to do
+    }
     return ret;
 }
 
@@ -152,24 +543,267 @@ static void handleFailedMeasmt(rbk_smp290_snsr_err_ten status)
     }
 }
 
+/**
+ * @brief      Checks if a measurement step is redundant.
+ * @details    A step is redundant if another step of the plan yields all of its
+ *             channels and always runs at least in every cycle it runs, e.g. the
+ *             standalone T conversion when TpAz already yields T.
+ *             Among steps with the same channels and divider, the first one is kept.
+ * @param[in]  plan_p  The plan.
+ * @param[in]  idx     The index of the step in the plan.
+ * @param[in]  skip    The steps of the plan that are already dropped.
+ * @return     true if the step can be dropped
+ */
+static bool isStepRedundant(const seq_plan_tst *plan_p, uint32_t idx, uint32_t skip)
+{
+    const seq_step_tst *step_p = &plan_p->steps[idx];
+    bool redundant             = false;
+    uint32_t i;
+
+    for (i = 0u; (i < plan_p->numSteps) && !redundant; i++)
+    {
+        const seq_step_tst *other_p = &plan_p->steps[i];
+
+        if ((i != idx) && (NULL != other_p->cancel) && (NULL == other_p->enabled) && (0u == (skip & (1uL << i))) &&
+            ((other_p->yields & step_p->yields) == step_p->yields) && (0u == (step_p->divider % other_p->divider)))
+        {
+            // Identical steps: keep the first one
+            redundant = (other_p->yields != step_p->yields) || (other_p->divider != step_p->divider) || (i < idx);
+        }
+    }
+    return redundant;
+}
+
+/**
+ * @brief      Drops the redundant sensor conversions of every plan.
+ * @details    Also computes the number of conversions per cycle of the plans,
+ *             before and after the optimization.
+ * return     None
+ */
+static void optimizePlans(void)
+{
+    uint32_t planId;
+    uint32_t idx;
+
+    for (planId = 0u; planId < (uint32_t)SEQ_PLAN_MAX; planId++)
+    {
+        const seq_plan_tst *plan_p = &seq_plans[planId];
+        uint16_t convBefore        = 0u;
+
+        sequence_planSkip[planId] = 0u;
+        sequence_planConv[planId] = 0u;
+
+        for (idx = 0u; idx < plan_p->numSteps; idx++)
+        {
+            const seq_step_tst *step_p = &plan_p->steps[idx];
+
+            if (NULL != step_p->cancel)
+            {
+                convBefore += (uint16_t)(100u / step_p->divider);
+
+                if (isStepRedundant(plan_p, idx, sequence_planSkip[planId]))
+                {
+                    sequence_planSkip[planId] |= (1uL << idx);
+                    smp290_log(LOG_VERBOSITY_DEBUG, "\tPlan %lu: %s dropped\r\n", (unsigned long)planId, step_p->name);
+                }
+                else
+                {
+                    sequence_planConv[planId] += (uint16_t)(100u / step_p->divider);
+                }
+            }
+        }
+        smp290_log(LOG_VERBOSITY_INFO, "\tPlan %lu: %u.%02u -> %u.%02u conversions/cycle\r\n", (unsigned long)planId,
+                   (unsigned)(convBefore / 100u), (unsigned)(convBefore % 100u), (unsigned)(sequence_planConv[planId] / 100u),
+                   (unsigned)(sequence_planConv[planId] % 100u));
+    }
+}
+
+/**
+ * @brief      Checks if the step at a position is due.
+ * @details    A step is due if its divider selects the cycle, the plan
+ *             optimizer did not drop it and it is enabled, e.g. by the
+ *             accelerometer auto-ranging.
+ * @param[in]  pos_p  The position of the step.
+ * @return     true if the step runs
+ */
+static bool isStepDue(const seq_pos_tst *pos_p)
+{
+    uint32_t planId            = (uint32_t)(pos_p->plan_p - seq_plans);
+    const seq_step_tst *step_p = &pos_p->plan_p->steps[pos_p->iter];
+
+    return (0u == (sequence_planSkip[planId] & (1uL << pos_p->iter))) && (0u == (pos_p->cycle % step_p->divider)) &&
+           ((NULL == step_p->enabled) || step_p->enabled());
+}
+
+/**
+ * @brief      Returns the cycle length of a plan.
+ * @details    The cycle length requested by \ref sequence_setCycle overrides the
+ *             default of the plan, as long as it leaves room for all of its steps.
+ * @param[in]  plan_p  The plan.
+ * @return     The cycle length [ms]
+ */
+static uint32_t getCycleLen(const seq_plan_tst *plan_p)
+{
+    uint32_t cycle_ms = plan_p->cycle_ms;
+
+    if (sequence_reqCycle_ms > plan_p->steps[plan_p->numSteps - 1u].slot_ms)
+    {
+        cycle_ms = sequence_reqCycle_ms;
+    }
+    return cycle_ms;
+}
+
+/**
+ * @brief      Moves a position to the next due step.
+ * @details    Steps which are not due in their cycle are skipped. At the end of
+ *             the cycle, the plan requested by \ref sequence_selectPlan and the cycle
+ *             length requested by \ref sequence_setCycle are latched once for the
+ *             next cycle: a request made during the cycle does not change its length.
+ * @param[in,out] pos_p  The position to move.
+ * @return     The time between the slots of the two steps [ms]
+ */
+static uint32_t seekNextStep(seq_pos_tst *pos_p)
+{
+    const seq_step_tst *step_p;
+    uint32_t from_ms  = pos_p->plan_p->steps[pos_p->iter].slot_ms;
+    uint32_t delay_ms = 0u;
+
+    do
+    {
+        pos_p->iter++;
+
+        if ((pos_p->iter >= pos_p->plan_p->numSteps) || (pos_p->plan_p->steps[pos_p->iter].slot_ms >= pos_p->cycle_ms))
+        {
+            // Wrap around: the next cycle may run another plan. The steps beyond
+            // the end of a shortened cycle are dropped, see \ref shortenCycle.
+            delay_ms += pos_p->cycle_ms - from_ms;
+            from_ms         = 0u;
+            pos_p->iter     = 0u;
+            pos_p->cycle++;
+            pos_p->plan_p   = &seq_plans[sequence_reqPlan];
+            pos_p->cycle_ms = getCycleLen(pos_p->plan_p);
+        }
+
+        step_p = &pos_p->plan_p->steps[pos_p->iter];
+        delay_ms += (uint32_t)step_p->slot_ms - from_ms;
+        from_ms = step_p->slot_ms;
+    } while (!isStepDue(pos_p));
+
+    return delay_ms;
+}
+
+/**
+ * @brief      Starts a new cycle.
+ * @details    Latches the number of wakeups of the elapsed cycle, ages the
+ *             channel values and clears the fresh flags of the frame. The frame
+ *             of the new cycle is not published yet.
+ * @param[in]  numCycles  The number of cycles elapsed since the last step.
+ * return     None
+ */
+static void startCycle(uint32_t numCycles)
+{
+    uint8_t ch;
+
+    sequence_wakeupsPerCycle = sequence_wakeupCnt;
+    sequence_wakeupCnt       = 0u;
+    sequence_published       = false;
+
+    for (ch = 0u; ch < (uint8_t)SEQ_CH_MAX; ch++)
+    {
+        uint32_t age              = (uint32_t)sequence_frame_p->age[ch] + numCycles;
+        sequence_frame_p->age[ch] = (age > SEQ_AGE_NEVER) ? SEQ_AGE_NEVER : (uint8_t)age;
+    }
+    sequence_frame_p->fresh = 0u;
+}
+
+/**
+ * @brief      Moves the sequence to the step the timer has been armed for.
+ * return     None
+ */
+static void advanceStep(void)
+{
+    uint32_t prevCycle = sequence_pos.cycle;
+
+    sequence_pos = sequence_nextPos;
+    sequence_time_ms += sequence_nextDelay_ms;
+
+    if (prevCycle != sequence_pos.cycle)
+    {
+        startCycle(sequence_pos.cycle - prevCycle);
+    }
+}
+
+/**
+ * @brief      Arms the sequence timer as a one-shot for the next due step.
+ * @details    The delay is the distance between the slot of the current step and
+ *             the slot of the next due one, so the SMP290 is not woken up in
+ *             between, even over cycles in which a divided step is skipped.
+ * return     None
+ */
+static void armNextStep(void)
+{
+    sequence_nextPos      = sequence_pos;
+    sequence_nextDelay_ms = seekNextStep(&sequence_nextPos);
+
+    rbk_smp290_timer_disable(sequence_timerId);
+    (void)rbk_smp290_timer_setPeriod(sequence_timerId, MS_TO_US(sequence_nextDelay_ms));
+    rbk_smp290_timer_restart(sequence_timerId);
+    rbk_smp290_timer_enable(sequence_timerId);
+}
+
+/**
+ * @brief      Applies a shorter requested cycle length to the ongoing cycle.
+ * @details    The timer is armed for the next due step when a step starts, a wrap
+ *             around with the length of the ongoing cycle. When the deflation alarm
+ *             raises the sampling rate, e.g. while parked, waiting for the end of the
+ *             30 s cycle would delay the confirmation by a whole cycle: the ongoing
+ *             cycle is cut to the requested length and the timer is re-armed at once.
+ *             The steps of the cycle beyond the new length are dropped.
+ * return     None
+ */
+static void shortenCycle(void)
+{
+    uint32_t cycle_ms = getCycleLen(&seq_plans[sequence_reqPlan]);
+    uint32_t slot_ms  = sequence_pos.plan_p->steps[sequence_pos.iter].slot_ms;
+
+    if ((cycle_ms < sequence_pos.cycle_ms) && (slot_ms < cycle_ms))
+    {
+        smp290_log(LOG_VERBOSITY_DEBUG, "\tCycle shortened to %lu ms\r\n", (unsigned long)cycle_ms);
+        sequence_pos.cycle_ms = cycle_ms;
+        armNextStep();
+    }
+    else
+    {
+        // Nothing to do, the requested length applies from the next cycle
+    }
+}
+
 /**
  * @brief      Callback function for the sequence timer.
- * @details    This function is called when the sequence timer expires. It posts
- *             a timer tick event to the task.
+ * @details    This function is called when the sequence timer expires. The timer
+ *             is used as a one-shot: it is disabled here and re-armed by
+ *             \ref sequence_run for the next due step. It posts a timer tick event
+ *             to the task.
  * @param[in]  status  The status of the timer.
  * return     None
  */
 static void timerCallback(rbk_smp290_timerStatus_t status)
 {
     (void)(status);
+    rbk_smp290_timer_disable(sequence_timerId);
     task_postEventFromIsr((enum_t)SIG_TIMER_TICK, NULL);
 }
 
 // Initializes the sequence.
 void sequence_init(void)
 {
-    // Create the sequence timer
-    sequence_timerId = rbk_smp290_timer_create(SEQ_UPDATE_PERIOD_US, timerCallback);
+    // Create the sequence timer. The period is reprogrammed for every step.
+    sequence_timerId = rbk_smp290_timer_create(MS_TO_US(SEQ_FIRST_STEP_DELAY_MS), timerCallback);
+    // Measurements are written in place into the advertising payload
+    sequence_frame_p = snapshot_getWindow();
+    (void)memset((void *)sequence_frame_p->age, SEQ_AGE_NEVER, sizeof(sequence_frame_p->age));
+    // Drop the conversions whose channels are yielded by another step
+    optimizePlans();
     smp290_log(LOG_VERBOSITY_DEBUG, "\tSequence initialized\r\n");
 }
 
@@ -177,83 +811,55 @@ void sequence_init(void)
 void sequence_run(void)
 {
     rbk_smp290_snsr_err_ten ret = RBK_SMP290_SNSR_SUCCESS;
-    bool isMeasmt               = true;
-    smp290_log(LOG_VERBOSITY_DEBUG, "\tSequence step: ");
-    switch (sequence_iter)
+    const seq_step_tst *step_p  = &sequence_pos.plan_p->steps[sequence_pos.iter];
+
+    // Count the wakeups of the cycle
+    sequence_wakeupCnt++;
+
+    smp290_log(LOG_VERBOSITY_DEBUG, "\tSequence step: %s\r\n", step_p->name);
+
+    if (NULL == step_p->cancel)
     {
-        case SEQ_T:
-        {
-            smp290_log_append(LOG_VERBOSITY_DEBUG, "T\r\n");
-            ret = rbk_smp290_snsr_meas_cmpd_T();
-        }
-        break;
-        case SEQ_TPAZ:
-        {
-            smp290_log_append(LOG_VERBOSITY_DEBUG, "TpAz\r\n");
-            ret = rbk_smp290_snsr_meas_cmpd_p(RBK_SMP290_SNSR_EN_ENABLE, RBK_SMP290_SNSR_EN_ENABLE);
-        }
-        break;
-        case SEQ_TAZAX_LO_LO:
-        {
-            smp290_log_append(LOG_VERBOSITY_DEBUG, "Tazax_lo\r\n");
-            ret = rbk_smp290_snsr_meas_cmpd_az_ax(RBK_SMP290_SNSR_EN_ENABLE, RBK_SMP290_SNSR_RANGE_LO, RBK_SMP290_SNSR_RANGE_LO);
-        }
-        break;
-        case SEQ_TAZAX_LO_HI:
-        {
-            smp290_log_append(LOG_VERBOSITY_DEBUG, "Tazax_hi\r\n");
-            ret = rbk_smp290_snsr_meas_cmpd_az_ax(RBK_SMP290_SNSR_EN_ENABLE, RBK_SMP290_SNSR_RANGE_HI, RBK_SMP290_SNSR_RANGE_HI);
-        }
-        break;
-        case SEQ_VBAT:
-        {
-            smp290_log_append(LOG_VERBOSITY_DEBUG, "Vbat\r\n");
-            /// Vbat sequence configuration
-            static const rbk_smp290_snsr_cfg_Vbat_tst vbat_cfg = {.N_rep     = (uint8_t)SEQ_VBAT_NREP,
-                                                                  .t_rep     = SEQ_VBAT_TREP,
-                                                                  .osr       = RBK_SMP290_SNSR_OSR_4X,
-                                                                  .Vbat_load = RBK_SMP290_SNSR_VBAT_LOAD_DISABLE};
-            ret                                                = rbk_smp290_snsr_meas_and_get_Vbat(&vbat_cfg, &vbat_buff);
-        }
-        break;
-        case SEQ_ADV:
-        {
-            smp290_log_append(LOG_VERBOSITY_DEBUG, "Adv\r\n");
-            // Increment the frame counter
-            adv_sensorData.frame_counter++;
-            // Post event to prepare and start the advertising
-            task_postEvent((enum_t)SIG_ADV, &adv_sensorData);
-            isMeasmt = false;
-        }
-        break;
-        default:
-        {
-            smp290_log_append(LOG_VERBOSITY_DEBUG, "Idle\r\n");
-            // Until SEQ_MAX is reached, do nothing
-            isMeasmt = false;
-        }
-        break;
+        // The Adv. step selects the accelerometer range and the profile of the next cycle:
+        // run it before sleeping, so the steps due next are told from the new ones
+        (void)step_p->start();
+        armNextStep();
+        advanceStep();
+    }
+    else if (SNSR_OWNER_NONE != task_getSnsrOwner())
+    {
+        // The sensor is used by a measurement of the connected client, or its completion is
+        // still pending: skip the step, its channels are carried forward
+        armNextStep();
+        smp290_log(LOG_VERBOSITY_DEBUG, "\tSequence step skipped, sensor busy\r\n");
+        advanceStep();
     }
-
     // In case of a measurement sequence, check the status and take action if needed
-    if (isMeasmt)
+    else
     {
+        // Sleep until the next step is due
+        armNextStep();
+
+        ret = step_p->start();
+        if (RBK_SMP290_SNSR_SUCCESS == ret)
+        {
+            // The completion belongs to the sequence
+            task_setSnsrOwner(SNSR_OWNER_SEQUENCE);
+        }
         // Update the error
-        adv_sensorData.error |= (uint8_t)ret;
+        sequence_frame_p->error |= (uint8_t)ret;
         handleFailedMeasmt(ret);
 
         // The sequence iterator is incremented by the \ref sequence_getOutVals for measurement
     }
-    else
-    {
-        // Increment the sequence iterator
-        sequence_iter = (sequence_iter + 1u) % (SEQ_MAX);
-    }
 }
 
 // Retrieve the output values after a measurement iteration of the sequence.
 void sequence_getOutVals(rbk_smp290_snsr_err_ten status)
 {
+    const seq_step_tst *step_p = &sequence_pos.plan_p->steps[sequence_pos.iter];
+    uint8_t ch;
+
     // If the measurement fails, print a message
     if (RBK_SMP290_SNSR_SUCCESS != status)
     {
@@ -261,53 +867,31 @@ void sequence_getOutVals(rbk_smp290_snsr_err_ten status)
     }
     else
     {
-        // Nothing to do
+        // The channels of the step are fresh, the other ones are carried forward and age
+        for (ch = 0u; ch < (uint8_t)SEQ_CH_MAX; ch++)
+        {
+            if (0u != (step_p->yields & SEQ_CH_BIT(ch)))
+            {
+                sequence_frame_p->age[ch] = 0u;
+            }
+        }
+        sequence_frame_p->fresh |= step_p->yields;
     }
 
     // In both cases, we retrieve the sensor values and increment the iterator.
     // If an error occurred, the sensor values will reflect this.
-    switch (sequence_iter)
+    if (NULL != step_p->collect)
     {
-        case SEQ_T:
-        {
-            adv_sensorData.T_out = rbk_smp290_snsr_get_cmpd_T();
-        }
-        break;
-        case SEQ_TPAZ:
-        {
-            adv_sensorData.T_out     = rbk_smp290_snsr_get_cmpd_T();
-            adv_sensorData.p_out     = rbk_smp290_snsr_get_cmpd_p();
-            adv_sensorData.Az_hi_out = rbk_smp290_snsr_get_cmpd_az(RBK_SMP290_SNSR_RANGE_HI);
-        }
-        break;
-        case SEQ_TAZAX_LO_LO:
-        {
-            adv_sensorData.T_out     = rbk_smp290_snsr_get_cmpd_T();
-            adv_sensorData.Az_hi_out = rbk_smp290_snsr_get_cmpd_az(RBK_SMP290_SNSR_RANGE_LO);
-            adv_sensorData.Ax_lo_out = rbk_smp290_snsr_get_cmpd_ax(RBK_SMP290_SNSR_RANGE_LO);
-        }
-        break;
-        case SEQ_TAZAX_LO_HI:
-        {
-            adv_sensorData.T_out     = rbk_smp290_snsr_get_cmpd_T();
-            adv_sensorData.Az_hi_out = rbk_smp290_snsr_get_cmpd_az(RBK_SMP290_SNSR_RANGE_HI);
-            adv_sensorData.Ax_hi_out = rbk_smp290_snsr_get_cmpd_ax(RBK_SMP290_SNSR_RANGE_HI);
-        }
-        break;
-        case SEQ_VBAT:
-        {
-            adv_sensorData.Vbat_out = vbat_buff.Vbat[0];
-        }
-        break;
-        default:
-        {
-            // Nothing to do
-        }
-        break;
+        step_p->collect(sequence_frame_p);
     }
 
-    // Increment the sequence iterator
-    sequence_iter = (sequence_iter + 1u) % (SEQ_MAX);
+    // Check every new pressure sample for a rapid deflation
+    if ((RBK_SMP290_SNSR_SUCCESS == status) && (0u != (step_p->yields & SEQ_CH_BIT(SEQ_CH_P))))
+    {
+        checkDeflation();
+    }
+
+    advanceStep();
 }
 
 // Stop the sequence.
@@ -326,14 +910,73 @@ void sequence_stop(void)
 // Resumes the sequence.
 void sequence_resume(void)
 {
+    uint32_t delay_ms;
+
     smp290_log(LOG_VERBOSITY_DEBUG, "\tSequence resumed\r\n");
-    // Reset the sequence iterator
-    sequence_iter = SEQ_T;
+    // Restart at the beginning of a new cycle and apply a pending plan.
+    // The cycle counter keeps running, so the step dividers are not reset.
+    sequence_pos.iter     = 0u;
+    sequence_pos.plan_p   = &seq_plans[sequence_reqPlan];
+    sequence_pos.cycle_ms = getCycleLen(sequence_pos.plan_p);
+    sequence_pos.cycle++;
+    startCycle(1u);
+
+    delay_ms = SEQ_FIRST_STEP_DELAY_MS + sequence_pos.plan_p->steps[0].slot_ms;
+    if (!isStepDue(&sequence_pos))
+    {
+        delay_ms += seekNextStep(&sequence_pos);
+    }
 
+    sequence_time_ms += delay_ms;
+
+    // Arm the timer for the first due step
+    rbk_smp290_timer_disable(sequence_timerId);
+    (void)rbk_smp290_timer_setPeriod(sequence_timerId, MS_TO_US(delay_ms));
     // Reset the remaining time
     rbk_smp290_timer_restart(sequence_timerId);
     // Enable sequence timer
     rbk_smp290_timer_enable(sequence_timerId);
 }
 
+// Selects the measurement plan.
+void sequence_selectPlan(seq_planId_ten planId)
+{
+    if (planId < SEQ_PLAN_MAX)
+    {
+        // The plan becomes active at the start of the next cycle
+        sequence_reqPlan = planId;
+    }
+}
+
+// Sets the cycle length.
+void sequence_setCycle(uint32_t cycle_ms)
+{
+    // The cycle length is applied when the timer is armed for the next cycle
+    sequence_reqCycle_ms = cycle_ms;
+}
+
+// Returns the number of wakeups of the last cycle.
+uint8_t sequence_getWakeupsPerCycle(void)
+{
+    return sequence_wakeupsPerCycle;
+}
+
+// Returns the number of sensor conversions per cycle of a plan.
+uint16_t sequence_getConversionsPerCycle(seq_planId_ten planId)
+{
+    uint16_t conv = 0u;
+
+    if (planId < SEQ_PLAN_MAX)
+    {
+        conv = sequence_planConv[planId];
+    }
+    return conv;
+}
+
+// Returns the sequence time.
+uint32_t sequence_getTime(void)
+{
+    return sequence_time_ms;
+}
+
 /** @} */
@@ -0,0 +1,133 @@
+/**
+ * @addtogroup   measure_advertise_conn
+ * @{
+ * @file         snapshot.c
+ * @brief        This file contains the sensor frame handoff of the project \ref measure_advertise_conn.
+ * @details      The sequence writes its measurements in place into a sensor frame, the advertiser
+ *               encodes the published frame per burst. The frames are triple buffered: the slot
+ *               written by the sequence, the ready slot holding the last published frame and the
+ *               slot taken by the advertiser. Publishing exchanges the written slot with the ready
+ *               one, taking exchanges the ready slot with the one of the advertiser if it holds a
+ *               newer frame, told by the sequence numbers of the slots. A side never writes into a
+ *               slot held by the other one, so a frame never mixes two cycles over the steps of a
+ *               cycle and the bursts, without copying the frame for the advertiser.
+ *               The handoff is not lock-free: an exchange is two plain stores. Both sides run in
+ *               Task1, so \ref snapshot_publish and \ref snapshot_take never interrupt each other.
+ *               They must not be called from an interrupt handler.
+ * @copyright    (c) [Robert Bosch GmbH] [2024].
+ *               All rights reserved, also regarding any disposal,
+ *               exploitation, reproduction, editing, distribution, as well
+ *               as in the event of applications for industrial property
+ *               rights. The communication of its contents to others without
+ *               express authorization is prohibited. Offenders will be held
+ *               liable for the payment of damages. All rights reserved in
+ *               the event of the grant of a patent, utility model or design.
+ **/
+
+/* System includes */
+#include <string.h>
+
+/* Library includes */
+#include "rbk_smp290_types.h"
+
+/* Project includes */
+#include "main.h"
+
+/// @addtogroup measure_advertise_conn_snapshot_cfg Sensor frame handoff configuration definitions
+/// @{
+
+/******************************************************************************\
+ *  Constants
+ \******************************************************************************/
+
+/// Number of sensor frame slots: written by the sequence, ready, taken by the advertiser
+#define SNAPSHOT_NUM_SLOTS 3u
+
+/******************************************************************************\
+ *  Global variables
+\******************************************************************************/
+
+/// Sensor frame slots
+SECTION_PERSISTENT static ble_sensorData_tst snapshot_frame[SNAPSHOT_NUM_SLOTS];
+
+/// Sequence number of the frame of each slot, incremented on every publication
+SECTION_PERSISTENT static uint32_t snapshot_seq[SNAPSHOT_NUM_SLOTS];
+
+/// Sequence number of the last published frame
+SECTION_PERSISTENT static uint32_t snapshot_pubSeq = 0u;
+
+/// Slot written by the sequence
+SECTION_PERSISTENT static uint8_t snapshot_writeSlot = 0u;
+
+/// Slot of the last published frame not taken yet
+SECTION_PERSISTENT static uint8_t snapshot_readySlot = 1u;
+
+/// Slot taken by the advertiser
+SECTION_PERSISTENT static uint8_t snapshot_takenSlot = 2u;
+
+/// Slot of the last published frame, reference of the change detection
+SECTION_PERSISTENT static uint8_t snapshot_lastSlot = 2u;
+
+/// @}
+
+/******************************************************************************\
+ *  Functions declarations
+\******************************************************************************/
+
+// Clears the sensor frames.
+void snapshot_init(void)
+{
+    (void)memset((void *)snapshot_frame, 0x00, sizeof(snapshot_frame));
+    (void)memset((void *)snapshot_seq, 0x00, sizeof(snapshot_seq));
+}
+
+// Returns the sensor frame written by the sequence.
+ble_sensorData_tst *snapshot_getWindow(void)
+{
+    return &snapshot_frame[snapshot_writeSlot];
+}
+
+// Publishes the sensor frame written by the sequence.
+ble_sensorData_tst *snapshot_publish(void)
+{
+    uint8_t slot = snapshot_writeSlot;
+
+    snapshot_seq[slot] = ++snapshot_pubSeq;
+    snapshot_lastSlot  = slot;
+
+    // Exchange the written slot with the ready one. A ready frame the advertiser did
+    // not take is dropped, it is older than the published one.
+    snapshot_writeSlot = snapshot_readySlot;
+    snapshot_readySlot = slot;
+
+    // The new window starts from the published frame, so the channels
+    // which are not measured in the next cycles are carried forward
+    snapshot_frame[snapshot_writeSlot] = snapshot_frame[slot];
+    return &snapshot_frame[snapshot_writeSlot];
+}
+
+// Takes the last published sensor frame.
+ble_sensorData_tst const *snapshot_take(void)
+{
+    uint8_t slot = snapshot_readySlot;
+
+    // Take the ready frame if it is newer than the taken one
+    if ((int32_t)(snapshot_seq[slot] - snapshot_seq[snapshot_takenSlot]) > 0)
+    {
+        snapshot_readySlot = snapshot_takenSlot;
+        snapshot_takenSlot = slot;
+    }
+    else
+    {
+        // Nothing to do
+    }
+    return &snapshot_frame[snapshot_takenSlot];
+}
+
+// Returns the last published sensor frame.
+ble_sensorData_tst const *snapshot_getLast(void)
+{
+    return &snapshot_frame[snapshot_lastSlot];
+}
+
+/** @} */
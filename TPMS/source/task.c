@@ -28,7 +28,7 @@
  *  Constants
 \******************************************************************************/
 /// Maximum number of events for the Task1
-#define EVENTS_NUM_TASK1 (6u)
+#define EVENTS_NUM_TASK1 (7u)
 
 /******************************************************************************\
  *  Global variables
@@ -41,6 +41,9 @@ static rbk_smp290_qpc_actObj_t actObj_task1;
 
 /// Connected
 bool connected = false;
+
+/// Owner of the sensor conversion in flight
+SECTION_PERSISTENT static snsr_owner_ten snsr_owner = SNSR_OWNER_NONE;
 /// @}
 
 
@@ -83,8 +86,11 @@ static QState actSt_task1(rbk_smp290_qpc_actObj_t *const me, QEvt *pEvt)
     {
         case Q_ENTRY_SIG:
         {
+            // The configuration store is loaded first, the services read it
+            nvm_init();
             gatt_init();
             sequence_init();
+            motion_init();
 
             // Init of BLE security and advertising will be done by rbk_smp290_ble_evtCbk
             // after RBK_SMP290_BLE_STACK_INITIALIZED is received
@@ -103,17 +109,42 @@ static QState actSt_task1(rbk_smp290_qpc_actObj_t *const me, QEvt *pEvt)
         case SIG_MEASMT_DONE:
         {
             rbk_smp290_snsr_err_ten status = *(rbk_smp290_snsr_err_ten *)pEvent->params;
-            sequence_getOutVals(status);
+            snsr_owner_ten owner           = snsr_owner;
+
+            // The sensor is released before the result is collected, a chained conversion claims it again
+            snsr_owner = SNSR_OWNER_NONE;
+            if (SNSR_OWNER_SEQUENCE == owner)
+            {
+                sequence_getOutVals(status);
+            }
+            else if (SNSR_OWNER_CLIENT == owner)
+            {
+                // Back up, read and send the result of the client request
+                entry_ConnSnsrClbk(status);
+            }
+            else
+            {
+                // The owner released the sensor meanwhile, e.g. the client disconnected
+                smp290_log(LOG_VERBOSITY_WARNING, "\tStray measurement completion (0x%02X)\r\n", status);
+            }
+            // The sensor is free again, retry the requests the client queued meanwhile
+            custmeasSvc_procMeasQueue();
         }
         break;
 
         case SIG_ADV:
         {
-            ble_sensorData_tst const *adv_sensorData_p = (ble_sensorData_tst *)pEvent->params;
-            adv_prepSrvData(adv_sensorData_p);
+            // The frame is already committed to the advertising payload by the sequence
             adv_doAdv();
         }
         break;
+
+        case SIG_NVM_FLUSH:
+        {
+            // Write the configuration outside of the ATT callbacks
+            nvm_flush();
+        }
+        break;
         case Q_EXIT_SIG:
         case Q_INIT_SIG:
         default:
@@ -131,19 +162,23 @@ static QState actSt_task1(rbk_smp290_qpc_actObj_t *const me, QEvt *pEvt)
 \******************************************************************************/
 void entry_snsrClbk(rbk_smp290_snsr_err_ten status)
 {
-    if (connected)
-    {
-        entry_ConnSnsrClbk(status);
-    }
-    else
-    {
-        static rbk_smp290_snsr_err_ten snsr_status;
+    static rbk_smp290_snsr_err_ten snsr_status;
 
-        snsr_status = status;
-        // Post status to Task1
-        task_postEvent(SIG_MEASMT_DONE, &snsr_status);
-    }
-    
+    // The completion is routed at task level, where the start of the conversion has returned
+    // and its owner is recorded
+    snsr_status = status;
+    // Post status to Task1
+    task_postEvent(SIG_MEASMT_DONE, &snsr_status);
+}
+
+void task_setSnsrOwner(snsr_owner_ten owner)
+{
+    snsr_owner = owner;
+}
+
+snsr_owner_ten task_getSnsrOwner(void)
+{
+    return snsr_owner;
 }
 
 void task_creatAndStrt(void)
@@ -0,0 +1,278 @@
+/**
+ * @addtogroup   measure_advertise_conn
+ * @{
+ * @file         txpwr.c
+ * @brief        This file contains the adaptive TX power control of the project \ref measure_advertise_conn.
+ * @details      The TX power module keeps the link budget closed with the lowest TX power level.
+ *               The headroom of a link is the RSSI above the sensitivity of the receiver plus a
+ *               configurable margin. Below the margin, the level is raised at once by the missing
+ *               headroom; above it, the level is lowered in whole steps, keeping a hysteresis so the
+ *               level does not toggle on the noise of the RSSI.
+ *               - While connected, the RSSI of the peer is read periodically. The link is assumed
+ *                 reciprocal, the level is lowered by one step per reading at most.
+ *               - While unconnected, the RSSI of the advertisements measured by a gateway is written
+ *                 as a link hint, with the TX level the advertisements were sent at. The level of the
+ *                 advertising is computed from that level, so a repeated hint gives the same level. It
+ *                 follows the hint at once and is restored on every disconnection.
+ *               The level configured over \glos{GATT} and stored in \glos{NVM} is the maximum level,
+ *               the margin is stored in \glos{NVM} too.
+ * @copyright    (c) [Robert Bosch GmbH] [2024].
+ *               All rights reserved, also regarding any disposal,
+ *               exploitation, reproduction, editing, distribution, as well
+ *               as in the event of applications for industrial property
+ *               rights. The communication of its contents to others without
+ *               express authorization is prohibited. Offenders will be held
+ *               liable for the payment of damages. All rights reserved in
+ *               the event of the grant of a patent, utility model or design.
+ **/
+
+/* Library includes */
+#include "rbk_smp290_ble.h"
+#include "rbk_smp290_ble_radio.h"
+#include "rbk_smp290_ble_timer.h"
+#include "rbk_smp290_types.h"
+
+/* Project includes */
+#include "ble_custSvc.h"
+#include "main.h"
+
+/// @addtogroup measure_advertise_conn_txpwr_cfg TX power control configuration definitions
+/// @{
+
+/******************************************************************************\
+ *  Constants
+ \******************************************************************************/
+
+/// Sensitivity of the receiver on the 1M PHY [dBm]
+#define TXPWR_SENSITIVITY_DBM (-90)
+
+/// Default margin above the sensitivity [dB], covers the fading of the rotating wheel
+#define TXPWR_MARGIN_DFLT_DB 15u
+
+/// Maximum margin above the sensitivity [dB], a larger one pins the maximum level on any link
+#define TXPWR_MARGIN_MAX_DB 40u
+
+/// Lowest TX power level [dBm]
+#define TXPWR_MIN_DBM (-20)
+
+/// Step of the TX power level [dB]
+#define TXPWR_STEP_DB 2
+
+/// Headroom kept above the margin after lowering the level [dB]
+#define TXPWR_HYST_DB 3
+
+/// Period of the RSSI readings while connected [ms]
+#define TXPWR_RSSI_PERIOD_MS 1000u
+
+/******************************************************************************\
+ *  Global variables
+\******************************************************************************/
+
+/// RSSI reading timer
+static rbk_smp290_ble_tmr_tst txpwr_rssiTmr;
+
+/// Maximum TX power level, configured over \glos{GATT} [dBm]
+SECTION_PERSISTENT static int8_t txpwr_max = 0;
+
+/// TX power level requested from the radio [dBm]
+SECTION_PERSISTENT static int8_t txpwr_level = 0;
+
+/// TX power level of the advertising, from the link hint [dBm]
+SECTION_PERSISTENT static int8_t txpwr_advLevel = 0;
+
+/// Margin above the sensitivity [dB]
+SECTION_PERSISTENT static uint8_t txpwr_margin_dB = TXPWR_MARGIN_DFLT_DB;
+
+/// Last RSSI the level was adjusted to [dBm], \ref TXPWR_RSSI_NONE before the first one
+SECTION_PERSISTENT static int8_t txpwr_rssi = TXPWR_RSSI_NONE;
+
+/// @}
+
+/******************************************************************************\
+ *  Functions declarations
+\******************************************************************************/
+
+/**
+ * @brief      Passes a TX power level to the radio.
+ * @param[in]  level  The level [dBm].
+ * return     None
+ */
+static void applyLevel(int8_t level)
+{
+    if (level != txpwr_level)
+    {
+        txpwr_level = level;
+        (void)rbk_smp290_ble_radio_setTxPwr(level);
+        ble_txPwrLvl = rbk_smp290_ble_radio_getTxPwr();
+        smp290_log(LOG_VERBOSITY_DEBUG, "\tTX power: %d dBm\r\n", ble_txPwrLvl);
+    }
+    else
+    {
+        // Nothing to do
+    }
+}
+
+/**
+ * @brief      Computes the lowest level which keeps the margin of a link.
+ * @param[in]  level       The level the RSSI was measured with [dBm].
+ * @param[in]  rssi        The RSSI of the link [dBm].
+ * @param[in]  maxDown_dB  The largest decrease of the level [dB].
+ * @return     The level [dBm]
+ */
+static int8_t targetLevel(int8_t level, int8_t rssi, int32_t maxDown_dB)
+{
+    int32_t headroom = (int32_t)rssi - (TXPWR_SENSITIVITY_DBM + (int32_t)txpwr_margin_dB);
+    int32_t target   = level;
+    int32_t down_dB;
+
+    if (headroom < 0)
+    {
+        // Below the margin: raise at once, rounded up to whole steps
+        target += ((TXPWR_STEP_DB - 1) - headroom) / TXPWR_STEP_DB * TXPWR_STEP_DB;
+    }
+    else if (headroom >= (TXPWR_STEP_DB + TXPWR_HYST_DB))
+    {
+        // Above the margin: lower by whole steps, keeping the hysteresis
+        down_dB = (headroom - TXPWR_HYST_DB) / TXPWR_STEP_DB * TXPWR_STEP_DB;
+        target -= (down_dB < maxDown_dB) ? down_dB : maxDown_dB;
+    }
+    else
+    {
+        // Nothing to do
+    }
+    target = (target < TXPWR_MIN_DBM) ? TXPWR_MIN_DBM : ((target > txpwr_max) ? txpwr_max : target);
+    return (int8_t)target;
+}
+
+/**
+ * @brief      RSSI reading timer callback, requests the RSSI of the peer.
+ * @param[in]  prm  The timer parameter.
+ * return     None
+ */
+static void rssiTimerCallback(rbk_smp290_ble_tmrPrm prm)
+{
+    (void)prm;
+
+    if (connected)
+    {
+        // Answered with RBK_SMP290_BLE_GAP_READ_RSSI
+        (void)rbk_smp290_ble_gap_conn_readRssi();
+        (void)rbk_smp290_ble_timer_enable_ms(&txpwr_rssiTmr, TXPWR_RSSI_PERIOD_MS);
+    }
+    else
+    {
+        // Nothing to do
+    }
+}
+
+// Initializes the TX power control.
+void txpwr_init(int8_t max)
+{
+    rbk_smp290_ble_rfOutPwr PwrLvl;
+
+    txpwr_max      = max;
+    txpwr_advLevel = max;
+    txpwr_level    = max;
+    txpwr_rssi     = TXPWR_RSSI_NONE;
+
+    // Margin from NVM, else the default one
+    txpwr_margin_dB = TXPWR_MARGIN_DFLT_DB;
+    (void)nvm_get(NVM_ITEM_LINK, &txpwr_margin_dB, sizeof(txpwr_margin_dB));
+    if (txpwr_margin_dB > TXPWR_MARGIN_MAX_DB)
+    {
+        txpwr_margin_dB = TXPWR_MARGIN_DFLT_DB;
+    }
+
+    // Start from the maximum level until the first RSSI
+    PwrLvl       = rbk_smp290_ble_radio_setTxPwr(max);
+    ble_txPwrLvl = rbk_smp290_ble_radio_getTxPwr();
+    smp290_log(LOG_VERBOSITY_INFO, "TX Power Level: %d\r\n", PwrLvl);
+
+    (void)rbk_smp290_ble_timer_create(&txpwr_rssiTmr, rssiTimerCallback);
+}
+
+// Sets the maximum TX power level.
+void txpwr_setMax(int8_t max)
+{
+    txpwr_max = max;
+
+    // A raised maximum is used at once, the control lowers it again if possible
+    txpwr_advLevel = max;
+    applyLevel(max);
+}
+
+// Returns the maximum TX power level.
+int8_t txpwr_getMax(void)
+{
+    return txpwr_max;
+}
+
+// Sets the margin above the sensitivity.
+bool txpwr_setMargin(uint8_t margin_dB)
+{
+    bool ret = (margin_dB <= TXPWR_MARGIN_MAX_DB);
+
+    if (ret)
+    {
+        txpwr_margin_dB = margin_dB;
+    }
+    return ret;
+}
+
+// Returns the margin above the sensitivity.
+uint8_t txpwr_getMargin(void)
+{
+    return txpwr_margin_dB;
+}
+
+// Returns the last RSSI the level was adjusted to.
+int8_t txpwr_getRssi(void)
+{
+    return txpwr_rssi;
+}
+
+// Adjusts the level of the advertising to a link hint.
+void txpwr_setLinkHint(int8_t rssi, int8_t level)
+{
+    // The hint is measured on the own link at a known level: follow it at once
+    txpwr_rssi     = rssi;
+    txpwr_advLevel = targetLevel(level, rssi, (int32_t)txpwr_max - TXPWR_MIN_DBM);
+
+    if (!connected)
+    {
+        applyLevel(txpwr_advLevel);
+    }
+    else
+    {
+        // Used from the next disconnection
+    }
+}
+
+// Adjusts the level to the RSSI of the peer.
+void txpwr_onRssi(int8_t rssi)
+{
+    if (connected && (TXPWR_RSSI_NONE != rssi))
+    {
+        txpwr_rssi = rssi;
+        applyLevel(targetLevel(txpwr_level, rssi, TXPWR_STEP_DB));
+    }
+    else
+    {
+        // Nothing to do
+    }
+}
+
+// Starts the RSSI readings of a connection.
+void txpwr_onConnected(void)
+{
+    (void)rbk_smp290_ble_timer_enable_ms(&txpwr_rssiTmr, TXPWR_RSSI_PERIOD_MS);
+}
+
+// Stops the RSSI readings and restores the level of the advertising.
+void txpwr_onDisconnected(void)
+{
+    (void)rbk_smp290_ble_timer_disable(&txpwr_rssiTmr);
+    applyLevel(txpwr_advLevel);
+}
+
+/** @} */
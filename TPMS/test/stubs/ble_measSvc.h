@@ -0,0 +1,22 @@
+/**
+ * @file         ble_measSvc.h
+ * @brief        Host stand-in of the measurement service header for the unit tests of \ref measure_advertise_conn.
+ * @details      Only the functions called by the modules under test are declared, the service
+ *               itself depends on the \glos{BLE} stack of the SDK.
+ * @copyright    (c) [Robert Bosch GmbH] [2024].
+ *               All rights reserved, also regarding any disposal,
+ *               exploitation, reproduction, editing, distribution, as well
+ *               as in the event of applications for industrial property
+ *               rights. The communication of its contents to others without
+ *               express authorization is prohibited. Offenders will be held
+ *               liable for the payment of damages. All rights reserved in
+ *               the event of the grant of a patent, utility model or design.
+ **/
+#ifndef _BLE_MEASSVC_H
+#define _BLE_MEASSVC_H
+
+#include "main.h"
+
+void custmeasSvc_streamFrame(ble_sensorData_tst const *frame_p);
+
+#endif
@@ -0,0 +1,24 @@
+/**
+ * @file         rbk_smp290_nvm.h
+ * @brief        Host stand-in of the SDK header for the unit tests of \ref measure_advertise_conn.
+ * @copyright    (c) [Robert Bosch GmbH] [2024].
+ *               All rights reserved, also regarding any disposal,
+ *               exploitation, reproduction, editing, distribution, as well
+ *               as in the event of applications for industrial property
+ *               rights. The communication of its contents to others without
+ *               express authorization is prohibited. Offenders will be held
+ *               liable for the payment of damages. All rights reserved in
+ *               the event of the grant of a patent, utility model or design.
+ **/
+#ifndef RBK_SMP290_NVM_H
+#define RBK_SMP290_NVM_H
+
+#include "rbk_smp290_types.h"
+
+/// NVM status
+typedef enum
+{
+    RBK_SMP290_NVM_SUCCESS = 0  //!< Success
+} rbk_smp290_nvm_err_ten;
+
+#endif
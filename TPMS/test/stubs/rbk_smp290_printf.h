@@ -0,0 +1,29 @@
+/**
+ * @file         rbk_smp290_printf.h
+ * @brief        Host stand-in of the SDK header for the unit tests of \ref measure_advertise_conn.
+ * @copyright    (c) [Robert Bosch GmbH] [2024].
+ *               All rights reserved, also regarding any disposal,
+ *               exploitation, reproduction, editing, distribution, as well
+ *               as in the event of applications for industrial property
+ *               rights. The communication of its contents to others without
+ *               express authorization is prohibited. Offenders will be held
+ *               liable for the payment of damages. All rights reserved in
+ *               the event of the grant of a patent, utility model or design.
+ **/
+#ifndef RBK_SMP290_PRINTF_H
+#define RBK_SMP290_PRINTF_H
+
+#include "rbk_smp290_types.h"
+
+/// Log verbosity
+typedef enum
+{
+    LOG_VERBOSITY_ERROR,    //!< Errors
+    LOG_VERBOSITY_WARNING,  //!< Warnings
+    LOG_VERBOSITY_INFO,     //!< Information
+    LOG_VERBOSITY_DEBUG     //!< Debug
+} log_verbosity_ten;
+
+void smp290_log(log_verbosity_ten verbosity, const char *fmt_p, ...);
+
+#endif
@@ -0,0 +1,33 @@
+/**
+ * @file         rbk_smp290_snsr.h
+ * @brief        Host stand-in of the SDK header for the unit tests of \ref measure_advertise_conn.
+ * @copyright    (c) [Robert Bosch GmbH] [2024].
+ *               All rights reserved, also regarding any disposal,
+ *               exploitation, reproduction, editing, distribution, as well
+ *               as in the event of applications for industrial property
+ *               rights. The communication of its contents to others without
+ *               express authorization is prohibited. Offenders will be held
+ *               liable for the payment of damages. All rights reserved in
+ *               the event of the grant of a patent, utility model or design.
+ **/
+#ifndef RBK_SMP290_SNSR_H
+#define RBK_SMP290_SNSR_H
+
+#include "rbk_smp290_snsr_types.h"
+
+rbk_smp290_snsr_err_ten rbk_smp290_snsr_meas_cmpd_T(void);
+rbk_smp290_snsr_err_ten rbk_smp290_snsr_meas_cmpd_p(rbk_smp290_snsr_en_ten az, rbk_smp290_snsr_en_ten T);
+rbk_smp290_snsr_err_ten rbk_smp290_snsr_meas_cmpd_az_ax(rbk_smp290_snsr_en_ten T, rbk_smp290_snsr_range_ten az,
+                                                        rbk_smp290_snsr_range_ten ax);
+rbk_smp290_snsr_err_ten rbk_smp290_snsr_meas_and_get_Vbat(const rbk_smp290_snsr_cfg_Vbat_tst *cfg_p,
+                                                          rbk_smp290_snsr_Vbat_buff_tst *buff_p);
+rbk_smp290_snsr_err_ten rbk_smp290_snsr_cncl_cmpd_T(void);
+rbk_smp290_snsr_err_ten rbk_smp290_snsr_cncl_cmpd_p(void);
+rbk_smp290_snsr_err_ten rbk_smp290_snsr_cncl_cmpd_az_ax(void);
+rbk_smp290_snsr_err_ten rbk_smp290_snsr_cncl_Vbat(void);
+int16_t rbk_smp290_snsr_get_cmpd_T(void);
+int16_t rbk_smp290_snsr_get_cmpd_p(void);
+int16_t rbk_smp290_snsr_get_cmpd_az(rbk_smp290_snsr_range_ten range);
+int16_t rbk_smp290_snsr_get_cmpd_ax(rbk_smp290_snsr_range_ten range);
+
+#endif
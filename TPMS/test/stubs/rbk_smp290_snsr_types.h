@@ -0,0 +1,66 @@
+/**
+ * @file         rbk_smp290_snsr_types.h
+ * @brief        Host stand-in of the SDK header for the unit tests of \ref measure_advertise_conn.
+ * @copyright    (c) [Robert Bosch GmbH] [2024].
+ *               All rights reserved, also regarding any disposal,
+ *               exploitation, reproduction, editing, distribution, as well
+ *               as in the event of applications for industrial property
+ *               rights. The communication of its contents to others without
+ *               express authorization is prohibited. Offenders will be held
+ *               liable for the payment of damages. All rights reserved in
+ *               the event of the grant of a patent, utility model or design.
+ **/
+#ifndef RBK_SMP290_SNSR_TYPES_H
+#define RBK_SMP290_SNSR_TYPES_H
+
+#include "rbk_smp290_types.h"
+
+/// Sensor status
+typedef enum
+{
+    RBK_SMP290_SNSR_SUCCESS = 0,  //!< Success
+    RBK_SMP290_SNSR_ERR_BUSY      //!< A conversion is ongoing
+} rbk_smp290_snsr_err_ten;
+
+/// Enable
+typedef enum
+{
+    RBK_SMP290_SNSR_EN_DISABLE,  //!< Disabled
+    RBK_SMP290_SNSR_EN_ENABLE    //!< Enabled
+} rbk_smp290_snsr_en_ten;
+
+/// Accelerometer range
+typedef enum
+{
+    RBK_SMP290_SNSR_RANGE_LO,  //!< Low range
+    RBK_SMP290_SNSR_RANGE_HI   //!< High range
+} rbk_smp290_snsr_range_ten;
+
+/// Oversampling ratio
+typedef enum
+{
+    RBK_SMP290_SNSR_OSR_4X  //!< 4 times
+} rbk_smp290_snsr_osr_ten;
+
+/// Battery load during the Vbat conversion
+typedef enum
+{
+    RBK_SMP290_SNSR_VBAT_LOAD_DISABLE  //!< No load
+} rbk_smp290_snsr_Vbat_load_ten;
+
+/// Vbat conversion configuration
+typedef struct
+{
+    uint8_t N_rep;                            //!< Number of samples
+    uint16_t t_rep;                           //!< Sample rate
+    rbk_smp290_snsr_osr_ten osr;              //!< Oversampling ratio
+    rbk_smp290_snsr_Vbat_load_ten Vbat_load;  //!< Battery load
+} rbk_smp290_snsr_cfg_Vbat_tst;
+
+/// Vbat samples
+typedef struct
+{
+    int16_t Vbat[4];  //!< Samples
+} rbk_smp290_snsr_Vbat_buff_tst;
+
+#endif
@@ -0,0 +1,30 @@
+/**
+ * @file         rbk_smp290_timer.h
+ * @brief        Host stand-in of the SDK header for the unit tests of \ref measure_advertise_conn.
+ * @copyright    (c) [Robert Bosch GmbH] [2024].
+ *               All rights reserved, also regarding any disposal,
+ *               exploitation, reproduction, editing, distribution, as well
+ *               as in the event of applications for industrial property
+ *               rights. The communication of its contents to others without
+ *               express authorization is prohibited. Offenders will be held
+ *               liable for the payment of damages. All rights reserved in
+ *               the event of the grant of a patent, utility model or design.
+ **/
+#ifndef RBK_SMP290_TIMER_H
+#define RBK_SMP290_TIMER_H
+
+#include "rbk_smp290_types.h"
+
+/// Converts milliseconds to microseconds
+#define MS_TO_US(ms) ((uint32_t)(ms) * 1000u)
+
+/// Timer status passed to the callback
+typedef uint8_t rbk_smp290_timerStatus_t;
+
+int8_t rbk_smp290_timer_create(uint32_t period_us, void (*cbk)(rbk_smp290_timerStatus_t status));
+uint8_t rbk_smp290_timer_setPeriod(int8_t id, uint32_t period_us);
+void rbk_smp290_timer_restart(int8_t id);
+void rbk_smp290_timer_enable(int8_t id);
+void rbk_smp290_timer_disable(int8_t id);
+
+#endif
@@ -0,0 +1,456 @@
+/**
+ * @addtogroup   measure_advertise_conn
+ * @{
+ * @file         test_history.c
+ * @brief        This file contains the round-trip test of the sample history of the project \ref measure_advertise_conn.
+ * @details      The records of a corpus are stored with \ref history_add, read back with
+ *               \ref history_readBlocks and decoded by a reference decoder written from the
+ *               format description of history.c. The corpus covers steady samples, the maximum
+ *               deltas of every field, a wrap of the sequence time and random walks. Every
+ *               corpus overwrites the ring several times, the reads cross the block boundaries.
+ * @copyright    (c) [Robert Bosch GmbH] [2024].
+ *               All rights reserved, also regarding any disposal,
+ *               exploitation, reproduction, editing, distribution, as well
+ *               as in the event of applications for industrial property
+ *               rights. The communication of its contents to others without
+ *               express authorization is prohibited. Offenders will be held
+ *               liable for the payment of damages. All rights reserved in
+ *               the event of the grant of a patent, utility model or design.
+ **/
+
+/* System includes */
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Module under test, its static state is reset between the corpora */
+#include "history.c"
+
+/******************************************************************************\
+ *  Constants
+ \******************************************************************************/
+
+/// Number of records of every corpus, the ring is overwritten several times
+#define TEST_NUM_RECORDS 4000u
+
+/// Size of a read covering the whole history [bytes]
+#define TEST_READ_ALL_LEN (HISTORY_NUM_BLOCKS * HISTORY_BLOCK_SIZE)
+
+/// Stops the test on a failed check
+#define CHECK(cond)                                                                   \
+    do                                                                                \
+    {                                                                                 \
+        test_checks++;                                                                \
+        if (!(cond))                                                                  \
+        {                                                                             \
+            (void)printf("%s:%d: check failed: %s (%s)\n", __FILE__, __LINE__, #cond, \
+                         test_corpus);                                                \
+            exit(EXIT_FAILURE);                                                       \
+        }                                                                             \
+    } while (0)
+
+/*******************************************************************************
+ *  Types
+ ******************************************************************************/
+
+/// Record generator of a corpus
+typedef void (*test_gen_tpfn)(uint32_t idx, ble_sensorData_tst *frame_p, uint32_t *time_p);
+
+/******************************************************************************\
+ *  Global variables
+\******************************************************************************/
+
+/// Records stored, indexed by the sequence number
+static hist_record_tst test_expected[TEST_NUM_RECORDS];
+
+/// Records decoded, indexed by the sequence number
+static hist_record_tst test_decoded[TEST_NUM_RECORDS];
+
+/// Is the record of a sequence number decoded
+static bool test_seen[TEST_NUM_RECORDS];
+
+/// Name of the running corpus
+static const char *test_corpus = "";
+
+/// Number of checks done
+static uint32_t test_checks = 0u;
+
+/// State of the pseudo random generator
+static uint32_t test_rand = 0x12345678u;
+
+/******************************************************************************\
+ *  Functions declarations
+\******************************************************************************/
+
+/**
+ * @brief      Returns a pseudo random number, xorshift32.
+ * @return     The number
+ */
+static uint32_t nextRand(void)
+{
+    test_rand ^= test_rand << 13;
+    test_rand ^= test_rand >> 17;
+    test_rand ^= test_rand << 5;
+    return test_rand;
+}
+
+/**
+ * @brief      Clears the history.
+ * return     None
+ */
+static void resetHistory(void)
+{
+    (void)memset(history_blocks, 0, sizeof(history_blocks));
+    (void)memset(&history_prev, 0, sizeof(history_prev));
+    history_head      = 0u;
+    history_numBlocks = 0u;
+    history_total     = 0u;
+    history_prevDt_ms = 0;
+}
+
+/**
+ * @brief      Reads a zigzag varint.
+ * @param[in]  src_p  The encoded bytes.
+ * @param[in]  end    The length of the encoded bytes.
+ * @param[in]  pos_p  The position of the varint, moved behind it.
+ * @return     The value
+ */
+static int32_t getVarint(uint8_t const *src_p, uint32_t end, uint32_t *pos_p)
+{
+    uint32_t zz    = 0u;
+    uint32_t shift = 0u;
+    uint8_t byte;
+
+    do
+    {
+        CHECK(*pos_p < end);
+        CHECK(shift < 35u);
+        byte = src_p[(*pos_p)++];
+        zz |= (uint32_t)(byte & 0x7Fu) << shift;
+        shift += 7u;
+    } while (0u != (byte & 0x80u));
+
+    return (int32_t)(zz >> 1) ^ -(int32_t)(zz & 1u);
+}
+
+/**
+ * @brief      Decodes the blocks of a read into \ref test_decoded.
+ * @details    Every block must decode on its own and consume exactly its length.
+ * @param[in]  src_p    The blocks.
+ * @param[in]  len      The length of the blocks.
+ * @param[out] first_p  The sequence number of the first record decoded.
+ * @return     The sequence number following the last record decoded
+ */
+static uint32_t decodeBlocks(uint8_t const *src_p, uint32_t len, uint32_t *first_p)
+{
+    uint32_t pos  = 0u;
+    uint32_t next = 0u;
+    hist_blockHdr_tst hdr;
+
+    *first_p = UINT32_MAX;
+
+    while (pos < len)
+    {
+        hist_record_tst rec;
+        int32_t dt_ms = 0;
+        uint32_t end;
+        uint32_t seq;
+
+        CHECK((len - pos) >= sizeof(hdr));
+        (void)memcpy(&hdr, &src_p[pos], sizeof(hdr));
+        pos += (uint32_t)sizeof(hdr);
+        end = pos + hdr.len;
+
+        CHECK(hdr.count >= 1u);
+        CHECK(hdr.len <= (HISTORY_BLOCK_SIZE - sizeof(hist_blockHdr_tst)));
+        CHECK(end <= len);
+        CHECK((UINT32_MAX == *first_p) || (hdr.seq == next));
+
+        rec = hdr.first;
+        for (seq = hdr.seq; seq < (hdr.seq + hdr.count); seq++)
+        {
+            if (seq != hdr.seq)
+            {
+                int32_t dT;
+                int32_t tz;
+
+                dt_ms += getVarint(src_p, end, &pos);
+                rec.time_ms += (uint32_t)dt_ms;
+                rec.p_out = (int16_t)(rec.p_out + getVarint(src_p, end, &pos));
+                tz        = getVarint(src_p, end, &pos);
+                dT        = (tz - (tz & 1)) / 2;
+                rec.T_out = (int16_t)(rec.T_out + dT);
+                if (0 != (tz & 1))
+                {
+                    CHECK((pos + 2u) <= end);
+                    rec.flags = src_p[pos++];
+                    rec.error = src_p[pos++];
+                }
+            }
+            CHECK(seq < TEST_NUM_RECORDS);
+            test_decoded[seq] = rec;
+            test_seen[seq]    = true;
+        }
+        CHECK(pos == end);
+
+        if (UINT32_MAX == *first_p)
+        {
+            *first_p = hdr.seq;
+        }
+        next = hdr.seq + hdr.count;
+    }
+    return next;
+}
+
+/**
+ * @brief      Checks that a range of records decodes to the records stored.
+ * @param[in]  from  The first sequence number.
+ * @param[in]  to    The sequence number following the last one.
+ * return     None
+ */
+static void checkRecords(uint32_t from, uint32_t to)
+{
+    uint32_t seq;
+
+    for (seq = from; seq < to; seq++)
+    {
+        CHECK(test_seen[seq]);
+        CHECK(test_decoded[seq].time_ms == test_expected[seq].time_ms);
+        CHECK(test_decoded[seq].p_out == test_expected[seq].p_out);
+        CHECK(test_decoded[seq].T_out == test_expected[seq].T_out);
+        CHECK(test_decoded[seq].flags == test_expected[seq].flags);
+        CHECK(test_decoded[seq].error == test_expected[seq].error);
+    }
+}
+
+/**
+ * @brief      Reads the whole history at once and checks it.
+ * @details    The newest record is always included, the records lost to the ring
+ *             are the oldest ones only.
+ * return     None
+ */
+static void checkReadAll(void)
+{
+    static uint8_t buf[TEST_READ_ALL_LEN];
+    uint32_t total = history_getTotal();
+    uint32_t next  = 0u;
+    uint32_t first;
+    uint16_t len;
+
+    (void)memset(test_seen, 0, sizeof(test_seen));
+    len = history_readBlocks(0u, buf, (uint16_t)sizeof(buf), &next);
+
+    CHECK(decodeBlocks(buf, len, &first) == total);
+    CHECK(next == total);
+    CHECK((0u == total) || (first <= (total - 1u)));
+    checkRecords(first, total);
+}
+
+/**
+ * @brief      Reads the history block by block and checks it.
+ * @details    A read of one block size returns one whole block, a read smaller than
+ *             the next block returns nothing and does not move the cursor, a read from
+ *             the middle of a block returns that block.
+ * return     None
+ */
+static void checkReadBlocks(void)
+{
+    uint8_t buf[HISTORY_BLOCK_SIZE];
+    uint32_t total  = history_getTotal();
+    uint32_t cursor = 0u;
+    uint32_t next   = 0u;
+    uint32_t first;
+    uint32_t end;
+    uint16_t len;
+
+    (void)memset(test_seen, 0, sizeof(test_seen));
+
+    // Too small for any block
+    len = history_readBlocks(0u, buf, (uint16_t)(sizeof(hist_blockHdr_tst) - 1u), &next);
+    CHECK(0u == len);
+    CHECK(0u == next);
+
+    while (cursor != total)
+    {
+        len = history_readBlocks(cursor, buf, (uint16_t)sizeof(buf), &next);
+        CHECK(0u != len);
+        end = decodeBlocks(buf, len, &first);
+        CHECK(end == next);
+        CHECK(((hist_blockHdr_tst const *)buf)->count == (end - first));
+        // One block per read, starting at the cursor unless it was overwritten
+        CHECK((len - sizeof(hist_blockHdr_tst)) == ((hist_blockHdr_tst const *)buf)->len);
+        CHECK((0u == cursor) || (first <= cursor));
+        CHECK(end > cursor);
+        checkRecords(first, end);
+
+        // From the middle of the block: the same block again
+        if ((end - first) > 1u)
+        {
+            uint8_t again[HISTORY_BLOCK_SIZE];
+            uint32_t nextAgain = 0u;
+
+            CHECK(history_readBlocks(first + ((end - first) / 2u), again, (uint16_t)sizeof(again), &nextAgain) == len);
+            CHECK(0 == memcmp(buf, again, len));
+            CHECK(nextAgain == next);
+        }
+        cursor = next;
+    }
+
+    // Nothing left after the newest record
+    len = history_readBlocks(total, buf, (uint16_t)sizeof(buf), &next);
+    CHECK(0u == len);
+    CHECK(next == total);
+}
+
+/**
+ * @brief      Steady samples: constant time step, pressure noise of a few LSB.
+ * @param[in]  idx     The index of the record.
+ * @param[out] frame_p The frame.
+ * @param[out] time_p  The sequence time.
+ * return     None
+ */
+static void genSteady(uint32_t idx, ble_sensorData_tst *frame_p, uint32_t *time_p)
+{
+    frame_p->p_out = (int16_t)(600 + (int32_t)(idx % 3u) - 1);
+    frame_p->T_out = 25;
+    frame_p->flags = SEQ_FLAG_ACC_RANGE_HI;
+    frame_p->error = 0u;
+    *time_p        = 1000u + (idx * 250u);
+}
+
+/**
+ * @brief      Maximum deltas: every field swings between its limits on every record.
+ * @details    The time step swings between 0 and 2^30 ms, its delta-of-delta is the
+ *             largest the encoder handles. The sequence time wraps around.
+ * @param[in]  idx     The index of the record.
+ * @param[out] frame_p The frame.
+ * @param[out] time_p  The sequence time.
+ * return     None
+ */
+static void genMaxDelta(uint32_t idx, ble_sensorData_tst *frame_p, uint32_t *time_p)
+{
+    static uint32_t time_ms = 0u;
+    bool odd                = (0u != (idx & 1u));
+
+    time_ms = (0u == idx) ? 0xFFFFF000u : (time_ms + (odd ? 0x40000000u : 0u));
+
+    frame_p->p_out = odd ? INT16_MAX : INT16_MIN;
+    frame_p->T_out = odd ? INT16_MIN : INT16_MAX;
+    frame_p->flags = odd ? 0xFFu : 0x00u;
+    frame_p->error = odd ? 0x00u : 0xFFu;
+    *time_p        = time_ms;
+}
+
+/**
+ * @brief      Wrap of the sequence time with small steps.
+ * @param[in]  idx     The index of the record.
+ * @param[out] frame_p The frame.
+ * @param[out] time_p  The sequence time.
+ * return     None
+ */
+static void genTimeWrap(uint32_t idx, ble_sensorData_tst *frame_p, uint32_t *time_p)
+{
+    frame_p->p_out = (int16_t)(900 - (int32_t)(idx / 16u));
+    frame_p->T_out = (int16_t)((idx / 100u) % 40u);
+    frame_p->flags = (uint8_t)((idx / 500u) & SEQ_FLAG_ALARM);
+    frame_p->error = 0u;
+    *time_p        = (UINT32_MAX - ((TEST_NUM_RECORDS / 2u) * 250u)) + (idx * 250u);
+}
+
+/**
+ * @brief      Random walk: small and large steps of every field, occasional flag changes.
+ * @param[in]  idx     The index of the record.
+ * @param[out] frame_p The frame.
+ * @param[out] time_p  The sequence time.
+ * return     None
+ */
+static void genRandom(uint32_t idx, ble_sensorData_tst *frame_p, uint32_t *time_p)
+{
+    static ble_sensorData_tst frame;
+    static uint32_t time_ms = 0u;
+    uint32_t r              = nextRand();
+
+    if (0u == idx)
+    {
+        (void)memset(&frame, 0, sizeof(frame));
+        time_ms = 0u;
+    }
+
+    if (0u == (r & 0x7u))
+    {
+        frame.p_out = (int16_t)nextRand();
+        frame.T_out = (int16_t)nextRand();
+    }
+    else
+    {
+        frame.p_out = (int16_t)(frame.p_out + (int16_t)((nextRand() % 9u) - 4u));
+        frame.T_out = (int16_t)(frame.T_out + (int16_t)((nextRand() % 3u) - 1u));
+    }
+    if (0u == (r & 0x70u))
+    {
+        frame.flags = (uint8_t)nextRand();
+        frame.error = (uint8_t)nextRand();
+    }
+    time_ms += (0u == (r & 0x300u)) ? (nextRand() % 3600000u) : (250u * (1u + (nextRand() % 4u)));
+
+    *frame_p = frame;
+    *time_p  = time_ms;
+}
+
+/**
+ * @brief      Runs a corpus, the history is checked while it fills and overwrites.
+ * @param[in]  name   The name of the corpus.
+ * @param[in]  gen_p  The record generator.
+ * return     None
+ */
+static void runCorpus(const char *name, test_gen_tpfn gen_p)
+{
+    ble_sensorData_tst frame;
+    uint32_t time_ms;
+    uint32_t idx;
+
+    test_corpus = name;
+    resetHistory();
+
+    for (idx = 0u; idx < TEST_NUM_RECORDS; idx++)
+    {
+        (void)memset(&frame, 0, sizeof(frame));
+        gen_p(idx, &frame, &time_ms);
+
+        test_expected[idx].time_ms = time_ms;
+        test_expected[idx].p_out   = frame.p_out;
+        test_expected[idx].T_out   = frame.T_out;
+        test_expected[idx].flags   = frame.flags;
+        test_expected[idx].error   = frame.error;
+
+        history_add(&frame, time_ms);
+        CHECK(history_getTotal() == (idx + 1u));
+
+        // Every record early on, so the first blocks and the first wrap are covered, then sparse
+        if ((idx < 600u) || (0u == (idx % 97u)) || (idx == (TEST_NUM_RECORDS - 1u)))
+        {
+            checkReadAll();
+            checkReadBlocks();
+        }
+    }
+    (void)printf("%-10s %u records, %u blocks in use\n", name, (unsigned)TEST_NUM_RECORDS, (unsigned)history_numBlocks);
+}
+
+/**
+ * @brief      Runs the corpora.
+ * @return     0 if every check passed
+ */
+int main(void)
+{
+    runCorpus("steady", genSteady);
+    // A steady record takes 3 bytes, one more for the full time step after the header
+    CHECK(history_blocks[0].hdr.len == ((3u * (history_blocks[0].hdr.count - 1u)) + 1u));
+
+    runCorpus("max-delta", genMaxDelta);
+    runCorpus("time-wrap", genTimeWrap);
+    runCorpus("random", genRandom);
+
+    (void)printf("test_history: %u checks passed\n", (unsigned)test_checks);
+    return EXIT_SUCCESS;
+}
+
+/** @} */
@@ -0,0 +1,551 @@
+/**
+ * @addtogroup   measure_advertise_conn
+ * @{
+ * @file         test_sequence.c
+ * @brief        This file contains the test of the sequence wakeups of the project \ref measure_advertise_conn.
+ * @details      The sequence runs against a simulated timer and sensor, as Task1 runs it: every expiry
+ *               of the sequence timer posts a tick, the tick runs \ref sequence_run and a conversion
+ *               started by the step completes at once through \ref sequence_getOutVals. The wakeups of
+ *               every cycle are counted from the timer expiries and checked against
+ *               \ref sequence_getWakeupsPerCycle: a cycle of the 1 s driving profile wakes the SMP290 up
+ *               once per due step, never on the idle 100 ms slots, and fewer times with the dividers,
+ *               the plan optimizer and the accelerometer auto-ranging. A deflation first seen while
+ *               parked must raise the alarm within a cycle of the transition profile, without
+ *               waiting for the end of the 30 s parked cycle.
+ * @copyright    (c) [Robert Bosch GmbH] [2024].
+ *               All rights reserved, also regarding any disposal,
+ *               exploitation, reproduction, editing, distribution, as well
+ *               as in the event of applications for industrial property
+ *               rights. The communication of its contents to others without
+ *               express authorization is prohibited. Offenders will be held
+ *               liable for the payment of damages. All rights reserved in
+ *               the event of the grant of a patent, utility model or design.
+ **/
+
+/* System includes */
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Library includes */
+#include "rbk_smp290_boot.h"
+#include "rbk_smp290_snsr.h"
+#include "rbk_smp290_timer.h"
+
+/* Project includes */
+#include "ble_measSvc.h"
+#include "main.h"
+
+/******************************************************************************\
+ *  Constants
+ \******************************************************************************/
+
+/// Cycle length of the driving profile [ms]
+#define TEST_CYCLE_MS 1000u
+
+/// Slots of a cycle on the former fixed 100 ms grid
+#define TEST_SLOTS_PER_CYCLE 10u
+
+/// Steps of the full plan: T, TpAz, TAzAx low, TAzAx high, Vbat and Adv.
+#define TEST_FULL_STEPS 6u
+
+/// Divider of the Vbat step
+#define TEST_VBAT_DIVIDER 60u
+
+/// Number of cycles of every run, two periods of the Vbat divider
+#define TEST_NUM_CYCLES (2u * TEST_VBAT_DIVIDER)
+
+/// Delay of the first step after the sequence is resumed [ms]
+#define TEST_FIRST_STEP_MS 100u
+
+/// Pressure of the simulated sensor [LSB]
+#define TEST_P_LSB 250
+
+/// Az between the range boundaries: both ranges are measured [LSB of the high range]
+#define TEST_AZ_DUAL_LSB 500
+
+/// Az above the low range: the high range alone is measured [LSB of the high range]
+#define TEST_AZ_HI_LSB 700
+
+/// Saturation of the low range [LSB of the low range]
+#define TEST_AZ_LO_SAT_LSB 2047
+
+/// Pressure drop of the simulated deflation [LSB/s]
+#define TEST_DEFLATION_LSB_PER_S 20
+
+/// Longest simulated time of a scenario step [ms]
+#define TEST_TIMEOUT_MS 600000u
+
+/// Stops the test on a failed check
+#define CHECK(cond)                                                                         \
+    do                                                                                      \
+    {                                                                                       \
+        test_checks++;                                                                      \
+        if (!(cond))                                                                        \
+        {                                                                                   \
+            (void)printf("%s:%d: check failed: %s (%s, %u ms)\n", __FILE__, __LINE__, #cond, \
+                         test_run, (unsigned)test_now_ms);                                  \
+            exit(EXIT_FAILURE);                                                             \
+        }                                                                                   \
+    } while (0)
+
+/******************************************************************************\
+ *  Global variables
+\******************************************************************************/
+
+/// Connected, defined by the task
+bool connected = false;
+
+/// Name of the running scenario
+static const char *test_run = "";
+
+/// Number of checks done
+static uint32_t test_checks = 0u;
+
+/// Simulated time since the sequence was resumed [ms]
+static uint32_t test_now_ms = 0u;
+
+/// Callback of the sequence timer
+static void (*test_timerCbk)(rbk_smp290_timerStatus_t status) = NULL;
+
+/// Period of the sequence timer [us]
+static uint32_t test_timerPeriod_us = 0u;
+
+/// Is the sequence timer enabled
+static bool test_timerEnabled = false;
+
+/// Is a timer tick posted to the task
+static bool test_tick = false;
+
+/// Owner of the conversion in flight
+static snsr_owner_ten test_owner = SNSR_OWNER_NONE;
+
+/// Is a conversion in flight
+static bool test_convBusy = false;
+
+/// Az of the simulated sensor [LSB of the high range]
+static int16_t test_Az = TEST_AZ_DUAL_LSB;
+
+/// Wakeups counted in the ongoing cycle
+static uint8_t test_wakeupCnt = 0u;
+
+/// Is the simulated tire deflating
+static bool test_deflating = false;
+
+/// Start of the deflation [ms]
+static uint32_t test_deflationStart_ms = 0u;
+
+/// Time of the last pressure read before the deflation [ms]
+static uint32_t test_stable_ms = 0u;
+
+/// Time of the first pressure read during the deflation, 0 if none yet [ms]
+static uint32_t test_firstDeflating_ms = 0u;
+
+/******************************************************************************\
+ *  Stand-ins of the SDK and of the modules not under test
+\******************************************************************************/
+
+void smp290_log(log_verbosity_ten verbosity, const char *fmt_p, ...)
+{
+    (void)verbosity;
+    (void)fmt_p;
+}
+
+void rbk_smp290_boot_swRst(void)
+{
+    CHECK(false);
+}
+
+int8_t rbk_smp290_timer_create(uint32_t period_us, void (*cbk)(rbk_smp290_timerStatus_t status))
+{
+    test_timerCbk       = cbk;
+    test_timerPeriod_us = period_us;
+    return 0;
+}
+
+uint8_t rbk_smp290_timer_setPeriod(int8_t id, uint32_t period_us)
+{
+    (void)id;
+    test_timerPeriod_us = period_us;
+    return 0u;
+}
+
+void rbk_smp290_timer_restart(int8_t id)
+{
+    (void)id;
+}
+
+void rbk_smp290_timer_enable(int8_t id)
+{
+    (void)id;
+    test_timerEnabled = true;
+}
+
+void rbk_smp290_timer_disable(int8_t id)
+{
+    (void)id;
+    test_timerEnabled = false;
+}
+
+/**
+ * @brief      Starts a conversion of the simulated sensor.
+ * @return     The scheduling status
+ */
+static rbk_smp290_snsr_err_ten startConv(void)
+{
+    // The sequence never starts a conversion while another one is in flight
+    CHECK(!test_convBusy);
+    CHECK(SNSR_OWNER_NONE == test_owner);
+    test_convBusy = true;
+    return RBK_SMP290_SNSR_SUCCESS;
+}
+
+rbk_smp290_snsr_err_ten rbk_smp290_snsr_meas_cmpd_T(void)
+{
+    return startConv();
+}
+
+rbk_smp290_snsr_err_ten rbk_smp290_snsr_meas_cmpd_p(rbk_smp290_snsr_en_ten az, rbk_smp290_snsr_en_ten T)
+{
+    (void)az;
+    (void)T;
+    return startConv();
+}
+
+rbk_smp290_snsr_err_ten rbk_smp290_snsr_meas_cmpd_az_ax(rbk_smp290_snsr_en_ten T, rbk_smp290_snsr_range_ten az,
+                                                        rbk_smp290_snsr_range_ten ax)
+{
+    (void)T;
+    (void)az;
+    (void)ax;
+    return startConv();
+}
+
+rbk_smp290_snsr_err_ten rbk_smp290_snsr_meas_and_get_Vbat(const rbk_smp290_snsr_cfg_Vbat_tst *cfg_p,
+                                                          rbk_smp290_snsr_Vbat_buff_tst *buff_p)
+{
+    (void)cfg_p;
+    buff_p->Vbat[0] = 300;
+    return startConv();
+}
+
+rbk_smp290_snsr_err_ten rbk_smp290_snsr_cncl_cmpd_T(void)
+{
+    test_convBusy = false;
+    return RBK_SMP290_SNSR_SUCCESS;
+}
+
+rbk_smp290_snsr_err_ten rbk_smp290_snsr_cncl_cmpd_p(void)
+{
+    test_convBusy = false;
+    return RBK_SMP290_SNSR_SUCCESS;
+}
+
+rbk_smp290_snsr_err_ten rbk_smp290_snsr_cncl_cmpd_az_ax(void)
+{
+    test_convBusy = false;
+    return RBK_SMP290_SNSR_SUCCESS;
+}
+
+rbk_smp290_snsr_err_ten rbk_smp290_snsr_cncl_Vbat(void)
+{
+    test_convBusy = false;
+    return RBK_SMP290_SNSR_SUCCESS;
+}
+
+int16_t rbk_smp290_snsr_get_cmpd_T(void)
+{
+    return 25;
+}
+
+int16_t rbk_smp290_snsr_get_cmpd_p(void)
+{
+    int32_t p = TEST_P_LSB;
+
+    if (test_deflating)
+    {
+        p -= (TEST_DEFLATION_LSB_PER_S * (int32_t)(test_now_ms - test_deflationStart_ms)) / 1000;
+        if (0u == test_firstDeflating_ms)
+        {
+            test_firstDeflating_ms = test_now_ms;
+        }
+    }
+    else
+    {
+        test_stable_ms = test_now_ms;
+    }
+    return (int16_t)p;
+}
+
+int16_t rbk_smp290_snsr_get_cmpd_az(rbk_smp290_snsr_range_ten range)
+{
+    int32_t az = (int32_t)test_Az;
+
+    // The low range has a 3 times finer scale and saturates
+    if (RBK_SMP290_SNSR_RANGE_LO == range)
+    {
+        az = (3 * az > TEST_AZ_LO_SAT_LSB) ? TEST_AZ_LO_SAT_LSB : (3 * az);
+    }
+    return (int16_t)az;
+}
+
+int16_t rbk_smp290_snsr_get_cmpd_ax(rbk_smp290_snsr_range_ten range)
+{
+    (void)range;
+    return 0;
+}
+
+void task_postEvent(enum_t signal, void *pParams)
+{
+    (void)pParams;
+    // The Adv. of the published frame is not part of the test
+    CHECK((enum_t)SIG_ADV == signal);
+}
+
+void task_postEventFromIsr(enum_t signal, void *pParams)
+{
+    (void)pParams;
+    CHECK((enum_t)SIG_TIMER_TICK == signal);
+    test_tick = true;
+}
+
+void task_setSnsrOwner(snsr_owner_ten owner)
+{
+    test_owner = owner;
+}
+
+snsr_owner_ten task_getSnsrOwner(void)
+{
+    return test_owner;
+}
+
+void history_add(ble_sensorData_tst const *frame_p, uint32_t now_ms)
+{
+    (void)frame_p;
+    (void)now_ms;
+}
+
+bool adv_isDue(ble_sensorData_tst const *frame_p, uint32_t now_ms)
+{
+    (void)frame_p;
+    (void)now_ms;
+    return true;
+}
+
+void custmeasSvc_streamFrame(ble_sensorData_tst const *frame_p)
+{
+    (void)frame_p;
+}
+
+/******************************************************************************\
+ *  Functions declarations
+\******************************************************************************/
+
+/**
+ * @brief      Tells the cycle of a time.
+ * @param[in]  time_ms  The time since the sequence was resumed.
+ * @return     The cycle
+ */
+static uint32_t cycleOf(uint32_t time_ms)
+{
+    return (time_ms - TEST_FIRST_STEP_MS) / TEST_CYCLE_MS;
+}
+
+/**
+ * @brief      Runs a wakeup of the sequence, as Task1 does.
+ * @details    Sleeps until the timer expires, runs the step and completes its conversion.
+ * @return     The time of the next wakeup [ms]
+ */
+static uint32_t runWakeup(void)
+{
+    uint32_t next_ms;
+
+    // Sleep until the timer expires, the callback posts the tick
+    CHECK(test_timerEnabled);
+    test_now_ms += test_timerPeriod_us / 1000u;
+    test_timerCbk(0u);
+    CHECK(test_tick && !test_timerEnabled);
+    test_tick = false;
+
+    sequence_run();
+    if (test_convBusy)
+    {
+        // The conversion completes, the task routes it to its owner
+        CHECK(SNSR_OWNER_SEQUENCE == test_owner);
+        test_convBusy = false;
+        test_owner    = SNSR_OWNER_NONE;
+        sequence_getOutVals(RBK_SMP290_SNSR_SUCCESS);
+    }
+
+    // The sequence time is the time of the step the timer is armed for
+    next_ms = test_now_ms + (test_timerPeriod_us / 1000u);
+    CHECK(sequence_getTime() == next_ms);
+    return next_ms;
+}
+
+/**
+ * @brief      Runs the sequence for a number of cycles.
+ * @details    Every expiry of the timer is a wakeup. At the end of every cycle, the wakeups
+ *             counted from the timer are checked against the ones latched by the sequence.
+ * @param[in]  numCycles  The number of cycles.
+ * @param[out] hist_p     The number of cycles per number of wakeups, TEST_SLOTS_PER_CYCLE + 1 entries.
+ * return     None
+ */
+static void runCycles(uint32_t numCycles, uint32_t *hist_p)
+{
+    uint32_t end = cycleOf(test_now_ms + (test_timerPeriod_us / 1000u)) + numCycles;
+    uint32_t next_ms;
+
+    (void)memset((void *)hist_p, 0, (TEST_SLOTS_PER_CYCLE + 1u) * sizeof(uint32_t));
+
+    while (cycleOf(test_now_ms + (test_timerPeriod_us / 1000u)) < end)
+    {
+        next_ms = runWakeup();
+        test_wakeupCnt++;
+
+        if (cycleOf(next_ms) != cycleOf(test_now_ms))
+        {
+            // End of the cycle: the wakeups are latched by the sequence
+            CHECK(sequence_getWakeupsPerCycle() == test_wakeupCnt);
+            CHECK(test_wakeupCnt <= TEST_SLOTS_PER_CYCLE);
+            hist_p[test_wakeupCnt]++;
+            test_wakeupCnt = 0u;
+        }
+    }
+}
+
+/**
+ * @brief      Prints the number of cycles per number of wakeups.
+ * @param[in]  hist_p  The number of cycles per number of wakeups.
+ * return     None
+ */
+static void printHist(uint32_t const *hist_p)
+{
+    uint32_t n;
+
+    (void)printf("%-10s", test_run);
+    for (n = 0u; n <= TEST_SLOTS_PER_CYCLE; n++)
+    {
+        if (0u != hist_p[n])
+        {
+            (void)printf(" %u cycles with %u wakeups", (unsigned)hist_p[n], (unsigned)n);
+        }
+    }
+    (void)printf("\n");
+}
+
+/**
+ * @brief      Runs a deflation first seen while parked.
+ * @details    The wheel stands still until the parked profile is active, then the tire
+ *             deflates right after a parked pressure sample. The first deflating sample is
+ *             taken up to a parked cycle later, the alarm must be raised at most one cycle
+ *             of the transition profile after it.
+ * return     None
+ */
+static void runParkedDeflation(void)
+{
+    uint32_t start_ms = test_now_ms;
+    uint32_t onset_ms;
+
+    test_run = "alarm";
+    test_Az  = 0;
+
+    // Standing still: driving, transition, then parked. The parked cycle starts with
+    // the next cycle, wait for its long sleep.
+    while ((MOTION_PROFILE_PARKED != motion_getProfile()) ||
+           ((test_timerPeriod_us / 1000u) < motion_getCycle(MOTION_PROFILE_DRIVING)))
+    {
+        CHECK((test_now_ms - start_ms) < TEST_TIMEOUT_MS);
+        (void)runWakeup();
+    }
+
+    // Wait for a pressure sample of the parked cycle, the deflation starts right after it
+    start_ms = test_now_ms;
+    while (test_stable_ms <= start_ms)
+    {
+        CHECK((test_now_ms - start_ms) < TEST_TIMEOUT_MS);
+        (void)runWakeup();
+    }
+    CHECK(!alarm_isActive());
+    CHECK(MOTION_PROFILE_PARKED == motion_getProfile());
+    test_deflating         = true;
+    test_deflationStart_ms = test_now_ms;
+
+    while (!alarm_isActive())
+    {
+        CHECK((test_now_ms - test_deflationStart_ms) < TEST_TIMEOUT_MS);
+        (void)runWakeup();
+    }
+    onset_ms = test_now_ms;
+
+    // The first deflating sample is taken in the next parked cycle, the alarm is
+    // confirmed within a cycle of the transition profile
+    CHECK(0u != test_firstDeflating_ms);
+    CHECK((test_firstDeflating_ms - test_stable_ms) <= motion_getCycle(MOTION_PROFILE_PARKED));
+    CHECK((onset_ms - test_firstDeflating_ms) <= motion_getCycle(MOTION_PROFILE_TRANSITION));
+
+    // The latency runs from the last stable sample
+    CHECK(alarm_getLatency() == (onset_ms - test_stable_ms));
+    CHECK(alarm_getLatency() <= (motion_getCycle(MOTION_PROFILE_PARKED) + motion_getCycle(MOTION_PROFILE_TRANSITION)));
+    CHECK(alarm_getMaxLatency() >= alarm_getLatency());
+    (void)printf("%-10s onset %u ms after the first deflating sample, latency %u ms\n", test_run,
+                 (unsigned)(onset_ms - test_firstDeflating_ms), (unsigned)alarm_getLatency());
+}
+
+/**
+ * @brief      Runs the scenarios.
+ * @return     0 if every check passed
+ */
+int main(void)
+{
+    uint32_t hist[TEST_SLOTS_PER_CYCLE + 1u];
+
+    snapshot_init();
+    sequence_init();
+    motion_init();
+    sequence_resume();
+    CHECK(MOTION_PROFILE_DRIVING == motion_getProfile());
+    CHECK(TEST_CYCLE_MS == motion_getCycle(MOTION_PROFILE_DRIVING));
+
+    // The standalone T conversion is dropped: TpAz, TAzAx low and high every cycle, Vbat every 60th
+    CHECK(sequence_getConversionsPerCycle(SEQ_PLAN_FULL) == (3u * 100u + (100u / TEST_VBAT_DIVIDER)));
+    CHECK(sequence_getConversionsPerCycle(SEQ_PLAN_PRESSURE) == 100u);
+    CHECK(sequence_getConversionsPerCycle(SEQ_PLAN_MAX) == 0u);
+
+    // Both accelerometer ranges: TpAz, TAzAx low, TAzAx high and Adv., Vbat every 60th cycle.
+    // The standalone T conversion is dropped, TpAz yields T in every cycle.
+    test_run = "dual";
+    test_Az  = TEST_AZ_DUAL_LSB;
+    runCycles(TEST_NUM_CYCLES, hist);
+    printHist(hist);
+    CHECK(hist[TEST_FULL_STEPS - 2u] == (TEST_NUM_CYCLES - (TEST_NUM_CYCLES / TEST_VBAT_DIVIDER)));
+    CHECK(hist[TEST_FULL_STEPS - 1u] == (TEST_NUM_CYCLES / TEST_VBAT_DIVIDER));
+    CHECK(hist[TEST_FULL_STEPS] == 0u);
+
+    // High range alone: the low range conversion is disabled by the auto-ranging.
+    // The range is selected at the end of a cycle, the first cycle still measures both.
+    test_run = "high";
+    test_Az  = TEST_AZ_HI_LSB;
+    runCycles(1u, hist);
+    runCycles(TEST_NUM_CYCLES, hist);
+    printHist(hist);
+    CHECK(hist[TEST_FULL_STEPS - 3u] == (TEST_NUM_CYCLES - (TEST_NUM_CYCLES / TEST_VBAT_DIVIDER)));
+    CHECK(hist[TEST_FULL_STEPS - 2u] == (TEST_NUM_CYCLES / TEST_VBAT_DIVIDER));
+
+    // Pressure plan: TpAz and Adv. The plan is applied from the next cycle.
+    test_run = "pressure";
+    sequence_selectPlan(SEQ_PLAN_PRESSURE);
+    runCycles(1u, hist);
+    runCycles(TEST_NUM_CYCLES, hist);
+    printHist(hist);
+    CHECK(hist[2u] == TEST_NUM_CYCLES);
+
+    // The profiles change the cycle length, so it runs last
+    runParkedDeflation();
+
+    (void)printf("test_sequence: %u checks passed\n", (unsigned)test_checks);
+    return EXIT_SUCCESS;
+}
+
+/** @} */
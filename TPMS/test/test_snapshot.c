@@ -0,0 +1,217 @@
+/**
+ * @addtogroup   measure_advertise_conn
+ * @{
+ * @file         test_snapshot.c
+ * @brief        This file contains the stress test of the sensor frame handoff of the project \ref measure_advertise_conn.
+ * @details      A producer and a consumer are interleaved in a random order, one small operation
+ *               at a time. The producer writes the frame of a cycle byte by byte through its window
+ *               and publishes it, as the sequence does over the steps of a cycle. The consumer takes
+ *               the last published frame and reads it byte by byte, as the radio does over a burst.
+ *               Every frame read must come from a single cycle, the newest one published when it
+ *               was taken, and the cycles read must never go back. A publication or a take runs to
+ *               completion, as in Task1 where both sides run: the test does not cover an exchange
+ *               interrupted by the other side.
+ * @copyright    (c) [Robert Bosch GmbH] [2024].
+ *               All rights reserved, also regarding any disposal,
+ *               exploitation, reproduction, editing, distribution, as well
+ *               as in the event of applications for industrial property
+ *               rights. The communication of its contents to others without
+ *               express authorization is prohibited. Offenders will be held
+ *               liable for the payment of damages. All rights reserved in
+ *               the event of the grant of a patent, utility model or design.
+ **/
+
+/* System includes */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Project includes */
+#include "main.h"
+
+/******************************************************************************\
+ *  Constants
+ \******************************************************************************/
+
+/// Number of interleaved operations of every run
+#define TEST_NUM_STEPS 2000000u
+
+/// Size of a sensor frame [bytes]
+#define TEST_FRAME_LEN ((uint32_t)sizeof(ble_sensorData_tst))
+
+/// Stops the test on a failed check
+#define CHECK(cond)                                                                   \
+    do                                                                                \
+    {                                                                                 \
+        test_checks++;                                                                \
+        if (!(cond))                                                                  \
+        {                                                                             \
+            (void)printf("%s:%d: check failed: %s (%s, step %u)\n", __FILE__, __LINE__, \
+                         #cond, test_run, (unsigned)test_step);                       \
+            exit(EXIT_FAILURE);                                                       \
+        }                                                                             \
+    } while (0)
+
+/******************************************************************************\
+ *  Global variables
+\******************************************************************************/
+
+/// Name of the running interleaving
+static const char *test_run = "";
+
+/// Operation of the running interleaving
+static uint32_t test_step = 0u;
+
+/// Number of checks done
+static uint32_t test_checks = 0u;
+
+/// State of the pseudo random generator
+static uint32_t test_rand = 0x2545F491u;
+
+/******************************************************************************\
+ *  Functions declarations
+\******************************************************************************/
+
+/**
+ * @brief      Returns a pseudo random number, xorshift32.
+ * @return     The number
+ */
+static uint32_t nextRand(void)
+{
+    test_rand ^= test_rand << 13;
+    test_rand ^= test_rand >> 17;
+    test_rand ^= test_rand << 5;
+    return test_rand;
+}
+
+/**
+ * @brief      Returns a byte of the frame of a cycle.
+ * @details    The first 4 bytes hold the cycle, the other ones a hash of the cycle
+ *             and of the position, so a byte of another cycle is detected.
+ * @param[in]  cycle  The cycle.
+ * @param[in]  idx    The position in the frame.
+ * @return     The byte
+ */
+static uint8_t frameByte(uint32_t cycle, uint32_t idx)
+{
+    uint32_t h = (cycle * 2654435761u) ^ (idx * 40503u);
+
+    return (idx < 4u) ? (uint8_t)(cycle >> (8u * idx)) : (uint8_t)((h >> 13) ^ h);
+}
+
+/**
+ * @brief      Checks that a frame is the complete frame of a cycle.
+ * @param[in]  frame_p  The frame.
+ * @return     The cycle of the frame
+ */
+static uint32_t checkFrame(uint8_t const *frame_p)
+{
+    uint32_t cycle = (uint32_t)frame_p[0] | ((uint32_t)frame_p[1] << 8) | ((uint32_t)frame_p[2] << 16) |
+                     ((uint32_t)frame_p[3] << 24);
+    uint32_t idx;
+
+    for (idx = 4u; idx < TEST_FRAME_LEN; idx++)
+    {
+        CHECK(frame_p[idx] == frameByte(cycle, idx));
+    }
+    return cycle;
+}
+
+/**
+ * @brief      Runs an interleaving of the producer and the consumer.
+ * @param[in]  name      The name of the interleaving.
+ * @param[in]  prodPerc  The share of the producer operations [%].
+ * return     None
+ */
+static void runInterleaving(const char *name, uint32_t prodPerc)
+{
+    ble_sensorData_tst *window_p;
+    ble_sensorData_tst const *taken_p = NULL;
+    uint8_t read[sizeof(ble_sensorData_tst)];
+    uint32_t prodCycle  = 1u;
+    uint32_t prodIdx    = 0u;
+    uint32_t published  = 0u;
+    uint32_t readIdx    = 0u;
+    uint32_t takenCycle = 0u;
+    uint32_t lastRead   = 0u;
+    uint32_t numRead    = 0u;
+
+    test_run = name;
+    snapshot_init();
+    window_p = snapshot_getWindow();
+
+    for (test_step = 0u; test_step < TEST_NUM_STEPS; test_step++)
+    {
+        if ((nextRand() % 100u) < prodPerc)
+        {
+            // Producer: one byte of the cycle, then the publication
+            ((uint8_t *)window_p)[prodIdx] = frameByte(prodCycle, prodIdx);
+            prodIdx++;
+            if (TEST_FRAME_LEN == prodIdx)
+            {
+                window_p  = snapshot_publish();
+                published = prodCycle;
+                prodCycle++;
+                prodIdx = 0u;
+
+                // The new window carries the published frame forward, it is not the published slot
+                CHECK(snapshot_getLast() != window_p);
+                CHECK(0 == memcmp(snapshot_getLast(), window_p, sizeof(ble_sensorData_tst)));
+                CHECK(checkFrame((uint8_t const *)snapshot_getLast()) == published);
+            }
+        }
+        else if (NULL == taken_p)
+        {
+            // Consumer: start of a burst
+            taken_p    = snapshot_take();
+            takenCycle = published;
+            readIdx    = 0u;
+        }
+        else
+        {
+            // Consumer: one byte of the burst, then the checks of the frame read
+            read[readIdx] = ((uint8_t const *)taken_p)[readIdx];
+            readIdx++;
+            if (TEST_FRAME_LEN == readIdx)
+            {
+                if (0u != takenCycle)
+                {
+                    uint32_t cycle = checkFrame(read);
+
+                    // The newest frame at the take, never an older one than before
+                    CHECK(cycle == takenCycle);
+                    CHECK(cycle >= lastRead);
+                    lastRead = cycle;
+                    numRead++;
+                }
+                taken_p = NULL;
+            }
+        }
+
+        // The producer never writes into the frame of the consumer, nor into the last published one
+        CHECK((NULL == taken_p) || (taken_p != window_p));
+        CHECK(snapshot_getLast() != window_p);
+    }
+
+    // Both sides made progress
+    CHECK(published > 100u);
+    CHECK(numRead > 100u);
+    (void)printf("%-10s %u frames published, %u frames read\n", name, (unsigned)published, (unsigned)numRead);
+}
+
+/**
+ * @brief      Runs the interleavings.
+ * @return     0 if every check passed
+ */
+int main(void)
+{
+    runInterleaving("balanced", 50u);
+    runInterleaving("fast-prod", 90u);
+    runInterleaving("fast-cons", 10u);
+    runInterleaving("bursty", 97u);
+
+    (void)printf("test_snapshot: %u checks passed\n", (unsigned)test_checks);
+    return EXIT_SUCCESS;
+}
+
+/** @} */